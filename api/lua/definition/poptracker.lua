@@ -395,6 +395,20 @@ function Archipelago:AddItemHandler(name, callback) end
 ---@return boolean true on success
 function Archipelago:AddLocationHandler(name, callback) end
 
+---Add callback to be called once per batch of received items, since 0.35.5.
+---Tracker.BulkUpdate is enabled while the callback runs.
+---@param name string identifier/name of this handler (for debugging)
+---@param callback fun(items:{index:integer, item:integer, item_name:string, player:integer}[]):nil
+---@return boolean true on success
+function Archipelago:AddItemsHandler(name, callback) end
+
+---Add callback to be called once per batch of checked locations, since 0.35.5.
+---Tracker.BulkUpdate is enabled while the callback runs.
+---@param name string identifier/name of this handler (for debugging)
+---@param callback fun(locations:{location:integer, location_name:string}[]):nil
+---@return boolean true on success
+function Archipelago:AddLocationsHandler(name, callback) end
+
 ---Add callback to be called when a location was scouted.
 ---@param name string identifier/name of this handler (for debugging)
 ---@param callback fun(locationID:integer, locationName:string, itemID:integer, itemName:string, itemPlayer:integer):nil
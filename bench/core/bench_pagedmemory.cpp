@@ -0,0 +1,51 @@
+#include <sltbench/BenchCore.h>
+#include <map>
+#include <stdint.h>
+#include "../../src/core/pagedmemory.h"
+
+
+// Compares the per-byte std::map memory mirror the backends used before to PagedMemory.
+// Each run receives 64 blocks of 512 bytes and then does 1000 2-byte reads, similar to a pack polling WRAM.
+
+static constexpr uint32_t BLOCK_SIZE = 512;
+static constexpr uint32_t BLOCK_COUNT = 64;
+static constexpr uint32_t BASE_ADDR = 0xf50000;
+
+static uint8_t block[BLOCK_SIZE];
+unsigned memorySink = 0;
+
+void BenchMapMemory()
+{
+    static std::map<uint32_t, uint8_t> data;
+    block[0]++;
+    for (uint32_t b = 0; b < BLOCK_COUNT; b++) {
+        const uint32_t addr = BASE_ADDR + b * BLOCK_SIZE;
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++)
+            data[addr + i] = block[i];
+    }
+    for (uint32_t n = 0; n < 1000; n++) {
+        const uint32_t addr = BASE_ADDR + (n * 37) % (BLOCK_SIZE * BLOCK_COUNT - 1);
+        uint16_t val = 0;
+        for (size_t i = 0; i < sizeof(val); i++) {
+            val <<= 8;
+            val += data[addr + sizeof(val) - i - 1];
+        }
+        memorySink += val;
+    }
+}
+SLTBENCH_FUNCTION(BenchMapMemory);
+
+void BenchPagedMemory()
+{
+    static PagedMemory data;
+    block[0]++;
+    for (uint32_t b = 0; b < BLOCK_COUNT; b++)
+        data.write(BASE_ADDR + b * BLOCK_SIZE, BLOCK_SIZE, block);
+    for (uint32_t n = 0; n < 1000; n++) {
+        const uint32_t addr = BASE_ADDR + (n * 37) % (BLOCK_SIZE * BLOCK_COUNT - 1);
+        uint16_t val = 0;
+        data.readInt(addr, val);
+        memorySink += val;
+    }
+}
+SLTBENCH_FUNCTION(BenchPagedMemory);
@@ -0,0 +1,258 @@
+#include <sltbench/BenchCore.h>
+#include <lauxlib.h>
+#include <lua.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <string.h>
+#include "../../src/core/pack.h"
+#include "../../src/core/tracker.h"
+
+
+// Compares string-based rule evaluation (as it was before rules got compiled) to evaluating CompiledRules.
+// Both run against a primed accessibility and provider cache, so this measures the rule walk itself.
+
+static constexpr int NUM_ITEMS = 500;
+static constexpr int NUM_LOCATIONS = 2000;
+
+struct RulesBenchData {
+    lua_State* L = nullptr;
+    std::unique_ptr<Pack> pack;
+    std::unique_ptr<Tracker> tracker;
+    std::vector<std::string> locationIDs;
+
+    ~RulesBenchData()
+    {
+        tracker.reset();
+        pack.reset();
+        if (L)
+            lua_close(L);
+    }
+};
+
+class RulesFixture {
+public:
+    typedef RulesBenchData Type;
+
+    Type& SetUp()
+    {
+        if (_data.tracker)
+            return _data;
+
+        _data.L = luaL_newstate();
+        _data.pack.reset(new Pack("examples/rules_test"));
+        _data.tracker.reset(new Tracker(_data.pack.get(), _data.L));
+
+        std::string items = "[";
+        for (int i = 0; i < NUM_ITEMS; i++) {
+            if (i)
+                items += ",";
+            items += "{\"name\":\"Item" + std::to_string(i) + "\",\"type\":\"consumable\","
+                     "\"codes\":\"item" + std::to_string(i) + "\",\"max_quantity\":5}";
+        }
+        items += "]";
+        _data.tracker->AddItemsFromString(items);
+
+        std::string locations = "[";
+        for (int i = 0; i < NUM_LOCATIONS; i++) {
+            const std::string a = "item" + std::to_string(i % NUM_ITEMS);
+            const std::string b = "item" + std::to_string((i * 7 + 3) % NUM_ITEMS);
+            const std::string c = "item" + std::to_string((i * 13 + 5) % NUM_ITEMS);
+            std::string rules = "[\"" + a + "," + b + ":2\",\"[" + c + "]," + a + "\",\"{" + b + "}\"";
+            if (i > 0)
+                rules += ",\"@Location" + std::to_string(i / 2) + "," + c + "\"";
+            rules += "]";
+            if (i)
+                locations += ",";
+            locations += "{\"name\":\"Location" + std::to_string(i) + "\",\"access_rules\":" + rules + ","
+                         "\"sections\":[{\"name\":\"s\",\"access_rules\":[\"" + c + ",@Location"
+                         + std::to_string(i) + "\"]}]}";
+            _data.locationIDs.push_back("Location" + std::to_string(i));
+        }
+        locations += "]";
+        _data.tracker->AddLocationsFromString(locations);
+
+        for (int i = 0; i < NUM_ITEMS; i += 3) {
+            auto o = _data.tracker->FindObjectForCode(("item" + std::to_string(i)).c_str());
+            if (o.type == Tracker::Object::RT::JsonItem)
+                o.jsonItem->setState(1, 2);
+        }
+        // prime caches
+        for (const auto& id: _data.locationIDs)
+            _data.tracker->isReachable(_data.tracker->getLocation(id));
+
+        return _data;
+    }
+
+    void TearDown()
+    {
+    }
+
+private:
+    Type _data;
+};
+
+/// Gives the benchmarks access to the otherwise private Tracker::resolveRules.
+class RulesBench final {
+public:
+    static AccessibilityLevel resolveRules(Tracker& tracker, const CompiledRules& rules,
+            bool visibilityRules, bool glitchedScoutableAsGlitched)
+    {
+        return tracker.resolveRules(rules, visibilityRules, glitchedScoutableAsGlitched);
+    }
+};
+
+/// String-based rule evaluation as it was done before rules got compiled.
+static AccessibilityLevel resolveStringRules(Tracker& tracker,
+        const std::list< std::list<std::string> >& rules, const bool visibilityRules,
+        const bool glitchedScoutableAsGlitched)
+{
+    bool glitchedReachable = false;
+    bool inspectOnlyReachable = false;
+    if (rules.empty()) return AccessibilityLevel::NORMAL;
+    for (const auto& ruleset : rules) {
+        if (ruleset.empty()) return AccessibilityLevel::NORMAL;
+        AccessibilityLevel reachable = AccessibilityLevel::NORMAL;
+        bool inspectOnly = false;
+        for (const auto& rule: ruleset) {
+            if (rule.empty()) continue;
+            std::string s = rule;
+            if (!s.empty() && s[0] == '{') {
+                inspectOnly = true;
+                s = s.substr(1,s.length()-1);
+            }
+            if (inspectOnly && !s.empty() && s[s.length()-1] == '}') {
+                s = s.substr(0, s.length()-1);
+            }
+            bool optional = false;
+            if (s.length() > 1 && s[0] == '[' && s[s.length()-1]==']') {
+                optional = true;
+                s = s.substr(1,s.length()-2);
+            }
+            if (inspectOnly && s.empty()) {
+                continue;
+            }
+            bool isAccessibilitLevel = s[0] == '^';
+            bool isLocationReference = s[0] == '@';
+            int count = 1;
+            auto p = s.find(':');
+            if (!isAccessibilitLevel && !isLocationReference && p != s.npos) {
+                count = atoi(s.c_str()+p+1);
+                s = s.substr(0,p);
+            }
+            if (isAccessibilitLevel) {
+                if (s.length() < 3 || s[1] != '$') {
+                    reachable = AccessibilityLevel::NONE;
+                    break;
+                }
+                s = s.substr(1);
+            }
+            if (s[0] == '@') {
+                const char* start = s.c_str()+1;
+                const char* t = strrchr(s.c_str()+1, '/');
+                std::string locid = s.substr(1);
+                auto& loc = tracker.getLocation(locid, true);
+                bool match = false;
+                AccessibilityLevel sub = AccessibilityLevel::NONE;
+                if (!loc.getID().empty()) {
+                    if (visibilityRules)
+                        sub = tracker.isVisible(loc) ? AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
+                    else
+                        sub = tracker.isReachable(loc);
+                    match = true;
+                } else if (t) {
+                    std::string sublocid = locid.substr(0, t-start);
+                    std::string subsecname = t+1;
+                    auto& subloc = tracker.getLocation(sublocid, true);
+                    for (auto& subsec: subloc.getSections()) {
+                        if (subsec.getName() != subsecname)
+                            continue;
+                        if (visibilityRules)
+                            sub = tracker.isVisible(subloc, subsec) ? AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
+                        else
+                            sub = tracker.isReachable(subloc, subsec);
+                        match = true;
+                        break;
+                    }
+                }
+                if (match) {
+                    if (!inspectOnly && sub == AccessibilityLevel::INSPECT)
+                        sub = AccessibilityLevel::NONE;
+                    else if (optional && sub == AccessibilityLevel::NONE)
+                        sub = AccessibilityLevel::SEQUENCE_BREAK;
+                    else if (sub == AccessibilityLevel::NONE)
+                        reachable = AccessibilityLevel::NONE;
+                    if (sub == AccessibilityLevel::SEQUENCE_BREAK && reachable != AccessibilityLevel::NONE)
+                        reachable = AccessibilityLevel::SEQUENCE_BREAK;
+                }
+                if (reachable == AccessibilityLevel::NONE) break;
+            }
+            else {
+                int n = tracker.ProviderCountForCode(s);
+                if (isAccessibilitLevel) {
+                    auto sub = static_cast<AccessibilityLevel>(n);
+                    if (!inspectOnly && sub == AccessibilityLevel::INSPECT)
+                        inspectOnly = true;
+                    else if (optional && sub == AccessibilityLevel::NONE)
+                        sub = AccessibilityLevel::SEQUENCE_BREAK;
+                    else if (sub == AccessibilityLevel::NONE)
+                        reachable = AccessibilityLevel::NONE;
+                    if (sub == AccessibilityLevel::SEQUENCE_BREAK && reachable != AccessibilityLevel::NONE)
+                        reachable = AccessibilityLevel::SEQUENCE_BREAK;
+                    if (reachable == AccessibilityLevel::NONE)
+                        break;
+                    continue;
+                }
+                if (n >= count)
+                    continue;
+                if (optional) {
+                    reachable = AccessibilityLevel::SEQUENCE_BREAK;
+                } else {
+                    reachable = AccessibilityLevel::NONE;
+                    break;
+                }
+            }
+        }
+        if (reachable == AccessibilityLevel::NORMAL && !inspectOnly)
+            return AccessibilityLevel::NORMAL;
+        if (reachable != AccessibilityLevel::NONE && inspectOnly)
+            inspectOnlyReachable = true;
+        if (reachable == AccessibilityLevel::SEQUENCE_BREAK)
+            glitchedReachable = true;
+    }
+    const bool glitchedScoutable = glitchedReachable && inspectOnlyReachable;
+    return (glitchedScoutable && !glitchedScoutableAsGlitched) ? AccessibilityLevel::INSPECT :
+           glitchedReachable ? AccessibilityLevel::SEQUENCE_BREAK :
+           inspectOnlyReachable ? AccessibilityLevel::INSPECT :
+               AccessibilityLevel::NONE;
+}
+
+int rulesSink = 0;
+
+void BenchStringRules(RulesFixture::Type& data)
+{
+    Tracker& tracker = *data.tracker;
+    for (const auto& id: data.locationIDs) {
+        const Location& location = tracker.getLocation(id);
+        rulesSink += (int)resolveStringRules(tracker, location.getAccessRules(), false,
+                location.getGlitchedScoutableAsGlitched());
+        for (const auto& section: location.getSections())
+            rulesSink += (int)resolveStringRules(tracker, section.getAccessRules(), false,
+                    section.getGlitchedScoutableAsGlitched());
+    }
+}
+SLTBENCH_FUNCTION_WITH_FIXTURE(BenchStringRules, RulesFixture);
+
+void BenchCompiledRules(RulesFixture::Type& data)
+{
+    Tracker& tracker = *data.tracker;
+    for (const auto& id: data.locationIDs) {
+        const Location& location = tracker.getLocation(id);
+        rulesSink += (int)RulesBench::resolveRules(tracker, location.getCompiledAccessRules(), false,
+                location.getGlitchedScoutableAsGlitched());
+        for (const auto& section: location.getSections())
+            rulesSink += (int)RulesBench::resolveRules(tracker, section.getCompiledAccessRules(), false,
+                    section.getGlitchedScoutableAsGlitched());
+    }
+}
+SLTBENCH_FUNCTION_WITH_FIXTURE(BenchCompiledRules, RulesFixture);
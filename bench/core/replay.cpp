@@ -0,0 +1,625 @@
+#include "replay.h"
+#include <luaglue/lua_include.h>
+#include <luaglue/lua_json.h>
+#include <luaglue/luaenum.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <nlohmann/json.hpp>
+#include "../../src/version.h"
+#include "../../src/core/accessibilitylevel.h"
+#include "../../src/core/fileutil.h"
+#include "../../src/core/fs.h"
+#include "../../src/core/imagereference.h"
+#include "../../src/core/jsonitem.h"
+#include "../../src/core/jsonutil.h"
+#include "../../src/core/location.h"
+#include "../../src/core/locationsection.h"
+#include "../../src/core/luaitem.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/scripthost.h"
+#include "../../src/core/statemanager.h"
+#include "../../src/core/tracker.h"
+#include "../../src/luasandbox/luapackio.h"
+#include "../../src/luasandbox/require.h"
+#include "../../src/ui/trackerview.h"
+
+
+// Usage:
+//   poptracker-benchmark --replay [--pack <path> [--variant <variant>]] [--events <events.json>]
+//                        [--count <n>] [--seed <n>] [--items <n>] [--locations <n>]
+//                        [--save-events <events.json>] [--json <result.json>]
+// Without --pack, a synthetic pack with --items items and --locations locations is generated.
+// Without --events, --count random item clicks are generated; --save-events writes them for later replay.
+//
+// Events file: a json array of
+//   {"item": "<code>", "action": "primary"}   click item by code (action: primary, secondary, toggle, prev, next)
+//   {"id": "<item id>", "action": "primary"}  click item by (unstable) item ID
+//   {"ap": "Item", "args": [index, item_id, item_name, player]}
+//                                             call the pack's Archipelago handlers of that kind (Clear, Item,
+//                                             Location, Scout, Bounce, Retrieved, SetReply) with args
+//
+// For every event, this measures applying it, then the same work the UI does afterwards:
+// update_accessibility (the first lookup after the change, which only resolves locations whose inputs changed),
+// cache_visibility (the first visibility lookup, which rebuilds that cache),
+// provider_count_for_code (for every item code) and location_state (TrackerView::CalculateLocationState for every
+// map location, or every location if the pack has no maps).
+// After the events, autosave_snapshot measures StateManager::makeState, which Autosaver runs on the main thread.
+
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+
+namespace {
+
+struct Options {
+    std::string pack;
+    std::string variant;
+    std::string events;
+    std::string saveEvents;
+    std::string jsonOut;
+    int count = 1000;
+    int items = 500;
+    int locations = 2000;
+    unsigned seed = 1;
+};
+
+struct Event {
+    enum class Type { Item, AP } type;
+    std::string id; ///< item ID for Item, handler kind for AP
+    BaseItem::Action action = BaseItem::Action::Primary;
+    json args;
+};
+
+/// Everything a tracker needs to run a pack without UI.
+struct Headless {
+    lua_State* L = nullptr;
+    std::unique_ptr<Pack> pack;
+    std::unique_ptr<LuaPackIO> luaio;
+    std::unique_ptr<Tracker> tracker;
+    std::unique_ptr<ScriptHost> scriptHost;
+    ImageReference imageReference;
+    int apDispatch = LUA_NOREF;
+
+    ~Headless()
+    {
+        // same order as PopTracker::unloadTracker
+        if (L)
+            lua_close(L);
+        luaio.reset();
+        scriptHost.reset();
+        tracker.reset();
+        pack.reset();
+    }
+};
+
+/// Stands in for the Archipelago interface, so recorded AP events can be dispatched to the pack's handlers.
+/// Returns the dispatch function.
+constexpr const char AP_STUB[] = R"(
+Archipelago = { PlayerNumber = 1, TeamNumber = 0, CheckedLocations = {}, MissingLocations = {} }
+local handlers = {}
+for _, kind in ipairs({"Clear", "Item", "Location", "Scout", "Bounce", "Retrieved", "SetReply"}) do
+    handlers[kind] = {}
+    Archipelago["Add" .. kind .. "Handler"] = function(self, name, callback)
+        table.insert(handlers[kind], callback)
+        return true
+    end
+end
+function Archipelago:SetNotify(keys) return true end
+function Archipelago:Get(keys) return true end
+function Archipelago:StatusUpdate(status) return true end
+function Archipelago:LocationChecks(locations) return true end
+function Archipelago:LocationScouts(locations, sendAsHint) return true end
+return function(kind, ...)
+    local callbacks = handlers[kind]
+    if not callbacks then
+        error("unknown handler kind " .. tostring(kind))
+    end
+    for _, callback in ipairs(callbacks) do
+        callback(...)
+    end
+end
+)";
+
+} // namespace
+
+
+static bool parseArgs(int argc, char** argv, Options& opts)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return false;
+        }
+        if (strcmp(arg, "--pack") == 0)
+            opts.pack = value;
+        else if (strcmp(arg, "--variant") == 0)
+            opts.variant = value;
+        else if (strcmp(arg, "--events") == 0)
+            opts.events = value;
+        else if (strcmp(arg, "--save-events") == 0)
+            opts.saveEvents = value;
+        else if (strcmp(arg, "--json") == 0)
+            opts.jsonOut = value;
+        else if (strcmp(arg, "--count") == 0)
+            opts.count = std::max(0, atoi(value));
+        else if (strcmp(arg, "--items") == 0)
+            opts.items = std::max(1, atoi(value));
+        else if (strcmp(arg, "--locations") == 0)
+            opts.locations = std::max(1, atoi(value));
+        else if (strcmp(arg, "--seed") == 0)
+            opts.seed = (unsigned)strtoul(value, nullptr, 10);
+        else {
+            fprintf(stderr, "Unknown argument %s\n", arg);
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+static bool loadSynthetic(Headless& h, const Options& opts)
+{
+    // same shape as bench_rules: chained rules with code and location references, some with visibility rules
+    h.L = luaL_newstate();
+    h.pack.reset(new Pack("examples/rules_test"));
+    h.tracker.reset(new Tracker(h.pack.get(), h.L));
+
+    std::string items = "[";
+    for (int i = 0; i < opts.items; i++) {
+        if (i)
+            items += ",";
+        items += "{\"name\":\"Item" + std::to_string(i) + "\",\"type\":\"consumable\","
+                 "\"codes\":\"item" + std::to_string(i) + "\",\"max_quantity\":5}";
+    }
+    items += "]";
+    if (!h.tracker->AddItemsFromString(items))
+        return false;
+
+    std::string locations = "[";
+    for (int i = 0; i < opts.locations; i++) {
+        const std::string a = "item" + std::to_string(i % opts.items);
+        const std::string b = "item" + std::to_string((i * 7 + 3) % opts.items);
+        const std::string c = "item" + std::to_string((i * 13 + 5) % opts.items);
+        std::string rules = "[\"" + a + "," + b + ":2\",\"[" + c + "]," + a + "\",\"{" + b + "}\"";
+        if (i > 0)
+            rules += ",\"@Location" + std::to_string(i / 2) + "," + c + "\"";
+        rules += "]";
+        if (i)
+            locations += ",";
+        locations += "{\"name\":\"Location" + std::to_string(i) + "\",\"access_rules\":" + rules + ",";
+        if (i % 8 == 0)
+            locations += "\"visibility_rules\":[\"" + b + "\"],";
+        locations += "\"sections\":[{\"name\":\"s\",\"item_count\":1,\"access_rules\":[\"" + c + ",@Location"
+                     + std::to_string(i) + "\"]}]}";
+    }
+    locations += "]";
+    return h.tracker->AddLocationsFromString(locations);
+}
+
+static bool loadPack(Headless& h, const Options& opts)
+{
+    // this is a reduced PopTracker::loadTracker without UI, auto-tracking and state restore
+    h.pack.reset(new Pack(pathFromUTF8(opts.pack)));
+    if (!h.pack->isValid()) {
+        fprintf(stderr, "Could not open pack %s\n", opts.pack.c_str());
+        return false;
+    }
+    h.pack->setVariant(opts.variant);
+
+    h.L = luaL_newstate();
+    if (!h.L || !lua_checkstack(h.L, 3)) {
+        fprintf(stderr, "Error creating Lua State!\n");
+        return false;
+    }
+    std::initializer_list<const luaL_Reg> luaLibs = {
+      {LUA_GNAME, luaopen_base},
+      {LUA_TABLIBNAME, luaopen_table},
+      {LUA_OSLIBNAME, luaopen_os},
+      {LUA_STRLIBNAME, luaopen_string},
+      {LUA_MATHLIBNAME, luaopen_math},
+      {LUA_UTF8LIBNAME, luaopen_utf8},
+    };
+    for (const auto& lib: luaLibs) {
+        luaL_requiref(h.L, lib.name, lib.func, 1);
+        lua_pop(h.L, 1);
+    }
+    for (const auto& blocked: { "load", "loadfile", "loadstring" }) {
+        lua_pushnil(h.L);
+        lua_setglobal(h.L, blocked);
+    }
+    lua_pushcfunction(h.L, luasandbox_require);
+    lua_setglobal(h.L, "require");
+    h.luaio.reset(new LuaPackIO(h.pack.get()));
+    LuaPackIO::Lua_Register(h.L);
+    LuaPackIO::File::Lua_Register(h.L);
+    h.luaio->Lua_Push(h.L);
+    lua_setglobal(h.L, LUA_IOLIBNAME);
+
+    h.tracker.reset(new Tracker(h.pack.get(), h.L));
+    const auto& settings = h.pack->getSettings();
+    auto itAllowDeferredLogicUpdate = settings.find("allow_deferred_logic_update");
+    if (itAllowDeferredLogicUpdate != settings.end() && itAllowDeferredLogicUpdate.value().is_boolean())
+        h.tracker->setAllowDeferredLogicUpdate(itAllowDeferredLogicUpdate.value());
+    Tracker::Lua_Register(h.L);
+    h.tracker->Lua_Push(h.L);
+    lua_setglobal(h.L, "Tracker");
+    lua_pushstring(h.L, "Pack");
+    lua_pushlightuserdata(h.L, h.pack.get());
+    lua_settable(h.L, LUA_REGISTRYINDEX);
+
+    h.scriptHost.reset(new ScriptHost(h.pack.get(), h.L, h.tracker.get()));
+    ScriptHost::Lua_Register(h.L);
+    h.scriptHost->Lua_Push(h.L);
+    lua_setglobal(h.L, "ScriptHost");
+
+    LuaItem::Lua_Register(h.L);
+    JsonItem::Lua_Register(h.L);
+    LocationSection::Lua_Register(h.L);
+    Location::Lua_Register(h.L);
+    ImageReference::Lua_Register(h.L);
+    h.imageReference.Lua_Push(h.L);
+    lua_setglobal(h.L, "ImageReference");
+
+    lua_pushstring(h.L, "Lua 5.3");
+    lua_setglobal(h.L, "_VERSION");
+    lua_pushstring(h.L, XSTR(APP_VERSION_MAJOR.APP_VERSION_MINOR.APP_VERSION_REVISION));
+    lua_setglobal(h.L, "PopVersion");
+
+    LuaEnum<AccessibilityLevel>({
+        {"None", AccessibilityLevel::NONE},
+        {"Partial", AccessibilityLevel::PARTIAL},
+        {"Inspect", AccessibilityLevel::INSPECT},
+        {"SequenceBreak", AccessibilityLevel::SEQUENCE_BREAK},
+        {"Normal", AccessibilityLevel::NORMAL},
+        {"Cleared", AccessibilityLevel::CLEARED},
+    }).Lua_SetGlobal(h.L, "AccessibilityLevel");
+    LuaEnum<Highlight>({
+        {"Avoid", Highlight::AVOID},
+        {"None", Highlight::NONE},
+        {"NoPriority", Highlight::NO_PRIORITY},
+        {"Unspecified", Highlight::UNSPECIFIED},
+        {"Priority", Highlight::PRIORITY},
+    }).Lua_SetGlobal(h.L, "Highlight");
+
+    if (luaL_loadbuffer(h.L, AP_STUB, sizeof(AP_STUB) - 1, "=ap_stub") != LUA_OK
+            || lua_pcall(h.L, 0, 1, 0) != LUA_OK) {
+        fprintf(stderr, "Error setting up Archipelago stub: %s\n", lua_tostring(h.L, -1));
+        lua_pop(h.L, 1);
+        return false;
+    }
+    h.apDispatch = luaL_ref(h.L, LUA_REGISTRYINDEX);
+
+    if (h.pack->hasFile("items.json"))
+        h.tracker->AddItems("items.json");
+    if (h.pack->hasFile("maps.json"))
+        h.tracker->AddMaps("maps.json");
+    if (h.pack->hasFile("locations.json"))
+        h.tracker->AddLocations("locations.json");
+    if (h.pack->hasFile("scripts/init.lua") && !h.scriptHost->LoadScript("scripts/init.lua"))
+        return false;
+    h.tracker->updateLuaStableIDs();
+    return true;
+}
+
+static BaseItem::Action parseAction(const std::string& s, bool& ok)
+{
+    ok = true;
+    if (s.empty() || s == "primary")
+        return BaseItem::Action::Primary;
+    if (s == "secondary")
+        return BaseItem::Action::Secondary;
+    if (s == "toggle")
+        return BaseItem::Action::Toggle;
+    if (s == "prev")
+        return BaseItem::Action::Prev;
+    if (s == "next")
+        return BaseItem::Action::Next;
+    ok = false;
+    return BaseItem::Action::Primary;
+}
+
+static bool loadEvents(Tracker& tracker, const std::string& file, std::vector<Event>& events)
+{
+    std::string s;
+    if (!readFile(pathFromUTF8(file), s)) {
+        fprintf(stderr, "Could not read %s\n", file.c_str());
+        return false;
+    }
+    json j = parse_jsonc(s);
+    if (!j.is_array()) {
+        fprintf(stderr, "%s: expected an array of events\n", file.c_str());
+        return false;
+    }
+    for (const auto& v: j) {
+        Event event;
+        if (!v.is_object()) {
+            fprintf(stderr, "%s: skipping invalid event %s\n", file.c_str(), v.dump().c_str());
+            continue;
+        }
+        if (v.contains("ap")) {
+            event.type = Event::Type::AP;
+            event.id = v.value("ap", "");
+            event.args = v.value("args", json::array());
+            if (!event.args.is_array())
+                event.args = json::array({event.args});
+        } else {
+            event.type = Event::Type::Item;
+            bool ok;
+            event.action = parseAction(v.value("action", ""), ok);
+            if (!ok) {
+                fprintf(stderr, "%s: skipping event with invalid action %s\n", file.c_str(), v.dump().c_str());
+                continue;
+            }
+            if (v.contains("item")) {
+                const auto& item = tracker.getItemByCode(v.value("item", ""));
+                if (item.getType() == BaseItem::Type::NONE) {
+                    fprintf(stderr, "%s: skipping event for unknown item %s\n", file.c_str(), v.dump().c_str());
+                    continue;
+                }
+                event.id = item.getID();
+            } else {
+                event.id = v.value("id", "");
+            }
+        }
+        events.push_back(std::move(event));
+    }
+    return true;
+}
+
+static std::vector<std::string> splitCodes(const std::string& s)
+{
+    // BaseItem::getCodesString joins with ", "
+    std::vector<std::string> res;
+    size_t start = 0;
+    while (start < s.length()) {
+        size_t end = s.find(", ", start);
+        if (end == s.npos)
+            end = s.length();
+        if (end > start)
+            res.push_back(s.substr(start, end - start));
+        start = end + 2;
+    }
+    return res;
+}
+
+static bool applyEvent(Headless& h, const Event& event)
+{
+    if (event.type == Event::Type::Item)
+        return h.tracker->changeItemState(event.id, event.action);
+    if (h.apDispatch == LUA_NOREF || !lua_checkstack(h.L, (int)event.args.size() + 3))
+        return false;
+    lua_pushcfunction(h.L, Tracker::luaErrorHandler);
+    lua_rawgeti(h.L, LUA_REGISTRYINDEX, h.apDispatch);
+    lua_pushstring(h.L, event.id.c_str());
+    for (const auto& arg: event.args)
+        json_to_lua(h.L, arg);
+    if (lua_pcall(h.L, (int)event.args.size() + 1, 0, -3 - (int)event.args.size())) {
+        const char* err = lua_tostring(h.L, -1);
+        printf("Error calling Archipelago %sHandler: %s\n", event.id.c_str(), err ? err : "Unknown");
+        lua_pop(h.L, 1); // error
+        luaL_dostring(h.L, "Tracker.BulkUpdate = false");
+    }
+    lua_pop(h.L, 1); // luaErrorHandler
+    return true;
+}
+
+static json summarize(std::vector<double>& samples)
+{
+    if (samples.empty())
+        return json(nullptr);
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (const double sample: samples)
+        sum += sample;
+    auto percentile = [&samples](double p) {
+        // nearest rank
+        const size_t rank = (size_t)std::ceil(p / 100.0 * samples.size());
+        return samples[rank ? rank - 1 : 0];
+    };
+    return {
+        {"mean", sum / samples.size()},
+        {"p50", percentile(50)},
+        {"p90", percentile(90)},
+        {"p99", percentile(99)},
+        {"max", samples.back()},
+    };
+}
+
+int runReplay(int argc, char** argv)
+{
+    Options opts;
+    if (!parseArgs(argc, argv, opts))
+        return 1;
+
+    Headless h;
+    const auto loadStart = Clock::now();
+    if (!(opts.pack.empty() ? loadSynthetic(h, opts) : loadPack(h, opts))) {
+        fprintf(stderr, "Error loading %s\n", opts.pack.empty() ? "synthetic pack" : opts.pack.c_str());
+        return 1;
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+    Tracker& tracker = *h.tracker;
+
+    // discover items, codes and locations through the save state, since Tracker does not list them
+    const json state = tracker.saveState()["tracker"];
+    std::vector<std::string> itemIDs;
+    std::vector<std::string> codes;
+    std::vector<std::pair<std::string, std::string>> itemCodes; // code -> ID, for generated events
+    for (const char* key: {"json_items", "lua_items"}) {
+        const auto it = state.find(key);
+        if (it == state.end() || !it->is_object())
+            continue;
+        for (const auto& [id, _]: it->items()) {
+            itemIDs.push_back(id);
+            const auto itemCodesList = splitCodes(tracker.getItemById(id).getCodesString());
+            if (!itemCodesList.empty())
+                itemCodes.emplace_back(itemCodesList.front(), id);
+            codes.insert(codes.end(), itemCodesList.begin(), itemCodesList.end());
+        }
+    }
+    std::sort(codes.begin(), codes.end());
+    codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+
+    std::vector<std::string> locationIDs;
+    {
+        std::set<std::string> seen;
+        const auto it = state.find("sections");
+        if (it != state.end() && it->is_object()) {
+            for (const auto& [id, _]: it->items()) {
+                const std::string& locID = tracker.getLocationSection(id).getParentID();
+                if (!locID.empty() && seen.insert(locID).second)
+                    locationIDs.push_back(locID);
+            }
+        }
+    }
+    std::vector<std::pair<std::string, Location::MapLocation>> mapLocations;
+    for (const auto& map: tracker.getMapNames()) {
+        for (auto& mapLoc: tracker.getMapLocations(map))
+            mapLocations.push_back(std::move(mapLoc));
+    }
+
+    // probes that make the tracker rebuild its caches on first access after a change
+    const Location* accessibilityProbe = nullptr;
+    const Location* visibilityProbe = nullptr;
+    for (const auto& id: locationIDs) {
+        const Location& loc = tracker.getLocation(id);
+        if (!accessibilityProbe)
+            accessibilityProbe = &loc;
+        if (!visibilityProbe && !loc.getVisibilityRules().empty())
+            visibilityProbe = &loc;
+    }
+    if (!accessibilityProbe) {
+        fprintf(stderr, "Pack has no locations\n");
+        return 1;
+    }
+
+    std::vector<Event> events;
+    if (!opts.events.empty()) {
+        if (!loadEvents(tracker, opts.events, events))
+            return 1;
+    } else if (!itemIDs.empty()) {
+        std::mt19937 rng(opts.seed);
+        std::uniform_int_distribution<size_t> pick(0, itemCodes.empty() ? itemIDs.size() - 1 : itemCodes.size() - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        json saved = json::array();
+        for (int i = 0; i < opts.count; i++) {
+            Event event;
+            event.type = Event::Type::Item;
+            event.action = percent(rng) < 70 ? BaseItem::Action::Primary : BaseItem::Action::Secondary;
+            const size_t n = pick(rng);
+            const std::string action = event.action == BaseItem::Action::Primary ? "primary" : "secondary";
+            if (itemCodes.empty()) {
+                event.id = itemIDs[n];
+                saved.push_back({{"id", event.id}, {"action", action}});
+            } else {
+                event.id = itemCodes[n].second;
+                saved.push_back({{"item", itemCodes[n].first}, {"action", action}});
+            }
+            events.push_back(std::move(event));
+        }
+        if (!opts.saveEvents.empty() && !writeFile(pathFromUTF8(opts.saveEvents), saved.dump(1)))
+            fprintf(stderr, "Could not write %s\n", opts.saveEvents.c_str());
+    }
+    if (events.empty()) {
+        fprintf(stderr, "No events to replay\n");
+        return 1;
+    }
+
+    int sink = 0; // keeps results alive
+    auto updateView = [&]() {
+        if (mapLocations.empty()) {
+            for (const auto& id: locationIDs)
+                sink += Ui::TrackerView::CalculateLocationState(&tracker, id);
+        } else {
+            for (const auto& [id, mapLoc]: mapLocations)
+                sink += Ui::TrackerView::CalculateLocationState(&tracker, id, mapLoc);
+        }
+    };
+    // prime caches like the initial render does
+    sink += (int)tracker.isReachable(*accessibilityProbe);
+    updateView();
+
+    std::vector<double> apply, accessibility, visibility, providers, locationState, total;
+    for (auto* samples: {&apply, &accessibility, &visibility, &providers, &locationState, &total})
+        samples->reserve(events.size());
+    auto us = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    };
+    size_t failed = 0;
+    for (const auto& event: events) {
+        const auto t0 = Clock::now();
+        if (!applyEvent(h, event))
+            failed++;
+        const auto t1 = Clock::now();
+        sink += (int)tracker.isReachable(*accessibilityProbe);
+        const auto t2 = Clock::now();
+        if (visibilityProbe)
+            sink += tracker.isVisible(*visibilityProbe);
+        const auto t3 = Clock::now();
+        for (const auto& code: codes)
+            sink += tracker.ProviderCountForCode(code);
+        const auto t4 = Clock::now();
+        updateView();
+        const auto t5 = Clock::now();
+        apply.push_back(us(t0, t1));
+        accessibility.push_back(us(t1, t2));
+        if (visibilityProbe)
+            visibility.push_back(us(t2, t3));
+        providers.push_back(us(t3, t4));
+        locationState.push_back(us(t4, t5));
+        total.push_back(us(t0, t5));
+    }
+
+    // state snapshot of an autosave; serializing and writing it happens on the Autosaver's worker
+    std::vector<double> snapshot;
+    snapshot.reserve(100);
+    for (int i = 0; i < 100; i++) {
+        const auto t0 = Clock::now();
+        const json state = StateManager::makeState(&tracker, {}, nullptr);
+        const auto t1 = Clock::now();
+        sink += (int)state.size();
+        snapshot.push_back(us(t0, t1));
+    }
+
+    json result = {
+        {"poptracker_version", APP_VERSION_STRING},
+        {"pack", opts.pack.empty() ? "synthetic" : opts.pack},
+        {"variant", opts.variant},
+        {"load_ms", loadMs},
+        {"events", events.size()},
+        {"failed_events", failed},
+        {"items", itemIDs.size()},
+        {"codes", codes.size()},
+        {"locations", locationIDs.size()},
+        {"map_locations", mapLocations.size()},
+        {"latency_us", {
+            {"apply", summarize(apply)},
+            {"update_accessibility", summarize(accessibility)},
+            {"cache_visibility", summarize(visibility)},
+            {"provider_count_for_code", summarize(providers)},
+            {"location_state", summarize(locationState)},
+            {"total", summarize(total)},
+            {"autosave_snapshot", summarize(snapshot)},
+        }},
+        {"checksum", sink},
+    };
+    const std::string out = result.dump(4);
+    if (opts.jsonOut.empty()) {
+        printf("%s\n", out.c_str());
+    } else if (!writeFile(pathFromUTF8(opts.jsonOut), out)) {
+        fprintf(stderr, "Could not write %s\n", opts.jsonOut.c_str());
+        return 1;
+    }
+    return 0;
+}
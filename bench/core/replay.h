@@ -0,0 +1,7 @@
+#pragma once
+
+
+/// Headless replay benchmark. Loads a pack (or a synthetic pack) without creating windows, replays item and AP
+/// events and reports per-event latency percentiles of the tracker's logic paths as JSON.
+/// argv[0] is expected to be "--replay". Returns the exit code.
+int runReplay(int argc, char** argv);
@@ -1,3 +1,12 @@
 #include <sltbench/BenchCore.h>
+#include <string.h>
+#include "core/replay.h"
 
-SLTBENCH_MAIN();
+
+int main(int argc, char** argv)
+{
+    // headless replay mode, see core/replay.cpp; everything else is handled by sltbench
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0)
+        return runReplay(argc - 1, argv + 1);
+    return sltbench::Main(argc, argv);
+}
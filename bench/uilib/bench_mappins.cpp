@@ -0,0 +1,499 @@
+#include <cassert>
+#include <cstdio>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <sltbench/Bench.h>
+#include "../../src/uilib/drawhelper.h"
+#include "../../src/uilib/geometrybatch.h"
+
+
+// Compares drawing 2000 map location pins the way MapWidget did before, with one SDL_RenderFillRect per rectangle
+// and one SDL_RenderGeometry per shape part, to collecting all glows and all pins into one GeometryBatch each
+// (as MapWidget does now).
+// Renders into a software renderer, so frame times are CPU bound; draw call count is printed once.
+
+using namespace Ui;
+
+static constexpr int NUM_PINS = 2000;
+
+enum class PinShape {
+    RECT,
+    DIAMOND,
+    TRAPEZOID,
+};
+
+struct Pin {
+    Position pos;
+    Size size;
+    int border;
+    PinShape shape;
+    Widget::Color topC, leftC, botC, rightC;
+    bool glow;
+};
+
+struct MapPinsBenchData {
+    SDL_Surface* surf = nullptr;
+    SDL_Renderer* renderer = nullptr;
+    std::vector<Pin> pins;
+};
+
+static void addPin(GeometryBatch& glowBatch, GeometryBatch& pinBatch, const Pin& pin)
+{
+    static const Widget::Color glowColor = {0xff, 0xd7, 0x00, 0xcc};
+    if (pin.glow) {
+        if (pin.shape == PinShape::DIAMOND)
+            drawDiamondGlow(glowBatch, pin.pos, pin.size, glowColor);
+        else if (pin.shape == PinShape::TRAPEZOID)
+            drawTrapezoidGlow(glowBatch, pin.pos, pin.size, glowColor);
+        else
+            drawRectGlow(glowBatch, pin.pos, pin.size, glowColor);
+    }
+    if (pin.shape == PinShape::DIAMOND)
+        drawDiamond(pinBatch, pin.pos, pin.size, pin.border, pin.topC, pin.leftC, pin.botC, pin.rightC);
+    else if (pin.shape == PinShape::TRAPEZOID)
+        drawTrapezoid(pinBatch, pin.pos, pin.size, pin.border, pin.topC, pin.leftC, pin.botC, pin.rightC);
+    else
+        drawRect(pinBatch, pin.pos, pin.size, pin.border, pin.topC, pin.leftC, pin.botC, pin.rightC);
+}
+
+// Pin drawing as it was before GeometryBatch, counting SDL calls.
+
+static int drawLegacyRect(SDL_Renderer* renderer, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC)
+{
+    int calls = 0;
+    SDL_Rect inner = {
+        pos.left, pos.top, size.width, size.height
+    };
+    SDL_Rect outer = {
+        pos.left-borderWidth, pos.top-borderWidth, size.width + 2*borderWidth, size.height + 2*borderWidth
+    };
+    SDL_Rect outerTop = {
+        outer.x, outer.y, outer.w, borderWidth
+    };
+    SDL_Rect outerBot = {
+        outer.x, outer.y + outer.h - borderWidth, outer.w, borderWidth
+    };
+    SDL_Rect outerLeft = {
+        outer.x, outer.y, borderWidth, outer.h
+    };
+    SDL_Rect outerRight = {
+        outer.x + outer.w - borderWidth, outer.y, borderWidth, outer.h
+    };
+
+    bool hasAlpha = topC.a != 0xff || leftC.a != 0xff || botC.a != 0xff || rightC.a != 0xff;
+
+    float fx = pos.left;
+    float fy = pos.top;
+    float fw = size.width;
+    float fh = size.height;
+
+    if (hasAlpha) {
+        // we have to draw 4 individual lines for border
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderFillRect(renderer, &outerTop);
+        calls++;
+        SDL_RenderFillRect(renderer, &outerBot);
+        calls++;
+        SDL_RenderFillRect(renderer, &outerLeft);
+        calls++;
+        SDL_RenderFillRect(renderer, &outerRight);
+        calls++;
+    } else {
+        // border as bigger background rect
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderFillRect(renderer, &outer);
+        calls++;
+    }
+
+    if (!hasAlpha || (topC == leftC && leftC == botC && botC == rightC)) {
+        SDL_SetRenderDrawColor(renderer, botC.r, botC.g, botC.b, botC.a);
+        SDL_RenderFillRect(renderer, &inner);
+        calls++;
+    } else if (botC == rightC) {
+        SDL_Color botRightColor = {botC.r, botC.g, botC.b, botC.a};
+        SDL_Vertex botRightVerts[] = {
+            {{fx + fw, fy}, botRightColor, {0, 0}},
+            {{fx, fy + fh}, botRightColor, {0, 0}},
+            {{fx + fw, fy + fh}, botRightColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, botRightVerts, 3, nullptr, 0);
+        calls++;
+    } else {
+        SDL_Color botColor = {botC.r, botC.g, botC.b, botC.a};
+        SDL_Vertex botVerts[] = {
+            {{fx, fy + fh}, botColor, {0, 0}},
+            {{fx + fw, fy + fw}, botColor, {0, 0}},
+            {{fx + fw/2, fy + fh/2}, botColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, botVerts, 3, nullptr, 0);
+        calls++;
+    }
+
+    if (botC != rightC) {
+        SDL_Color rightColor = {rightC.r, rightC.g, rightC.b, rightC.a};
+        SDL_Vertex rightVerts[] = {
+            {{fx + fw, fy}, rightColor, {0, 0}},
+            {{fx + fw/2, fy + fh/2}, rightColor, {0, 0}},
+            {{fx + fw, fy + fh}, rightColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, rightVerts, 3, nullptr, 0);
+        calls++;
+    }
+
+    if (topC == leftC && topC != botC) {
+        SDL_Color topLeftColor = {topC.r, topC.g, topC.b, topC.a};
+        SDL_Vertex topLeftVerts[] = {
+            {{fx, fy}, topLeftColor, {0, 0}},
+            {{fx, fy + fh}, topLeftColor, {0, 0}},
+            {{fx + fw, fy}, topLeftColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, topLeftVerts, 3, nullptr, 0);
+        calls++;
+    }
+
+    if (topC != leftC && topC != botC) {
+        SDL_Color topColor = {topC.r, topC.g, topC.b, topC.a};
+        SDL_Vertex topVerts[] = {
+            {{fx, fy}, topColor, {0, 0}},
+            {{fx + fw/2, fy + fh/2}, topColor, {0, 0}},
+            {{fx + fw, fy}, topColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, topVerts, 3, nullptr, 0);
+        calls++;
+    }
+
+    if (leftC != topC && leftC != botC) {
+        SDL_Color leftColor = {leftC.r, leftC.g, leftC.b, leftC.a};
+        SDL_Vertex leftVerts[] = {
+            {{fx, fy}, leftColor, {0, 0}},
+            {{fx, fy + fh}, leftColor, {0, 0}},
+            {{fx + fw/2, fy + fh/2}, leftColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, leftVerts, 3, nullptr, 0);
+        calls++;
+    }
+    return calls;
+}
+
+static int drawLegacyDiamond(SDL_Renderer* renderer, Position pos, Size size, int borderWidth,
+        Widget::Color tlC, Widget::Color blC, Widget::Color brC, Widget::Color trC)
+{
+    int calls = 0;
+    bool hasAlpha = tlC.a != 0xff || blC.a != 0xff || brC.a != 0xff || trC.a != 0xff;
+
+    float il = pos.left;
+    float it = pos.top;
+    float iw = size.width;
+    float ih = size.height;
+
+    float ol = il - borderWidth;
+    float ot = it - borderWidth;
+    float ow = iw + 2 * borderWidth;
+    float oh = ih + 2 * borderWidth;
+
+    if (hasAlpha) {
+        // we have to draw 4 individual lines for border
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        float x1 = ol, x2 = ol + borderWidth, x3 = ol + ow/2, x4 = ol + ow - borderWidth, x5 = ol + ow;
+        float y1 = ot, y2 = ot + borderWidth, y3 = ot + oh/2, y4 = ot + oh - borderWidth, y5 = ot + oh;
+        SDL_Color borderColor = {0, 0, 0, 255};
+        SDL_Vertex verts[] = {
+            {{x1, y3}, borderColor, {0, 0}},
+            {{x2, y3}, borderColor, {0, 0}},
+            {{x3, y2}, borderColor, {0, 0}},
+            {{x3, y1}, borderColor, {0, 0}},
+            {{x4, y3}, borderColor, {0, 0}},
+            {{x5, y3}, borderColor, {0, 0}},
+            {{x3, y4}, borderColor, {0, 0}},
+            {{x3, y5}, borderColor, {0, 0}},
+        };
+        int indices[] = {
+            0, 1, 2,
+            0, 2, 3,
+            2, 4, 3,
+            3, 4, 5,
+            4, 6, 5,
+            5, 6, 7,
+            1, 7, 6,
+            7, 1, 0,
+        };
+        SDL_RenderGeometry(renderer, nullptr, verts, 8, indices, 24);
+        calls++;
+    } else {
+        // border as bigger background rect
+        float x1 = ol, x2 = ol + ow/2, x3 = ol + ow;
+        float y1 = ot, y2 = ot + oh/2, y3 = ot + oh;
+        SDL_Color borderColor = {0, 0, 0, 255};
+        SDL_Vertex verts[] = {
+            {{x1, y2}, borderColor, {0, 0}},
+            {{x2, y3}, borderColor, {0, 0}},
+            {{x2, y1}, borderColor, {0, 0}},
+            {{x3, y2}, borderColor, {0, 0}},
+        };
+        int indices[] = {
+            0, 1, 2,
+            2, 1, 3
+        };
+        SDL_RenderGeometry(renderer, nullptr, verts, 4, indices, 6);
+        calls++;
+    }
+
+    {
+        float x1 = il, x2 = il + iw/2, x3 = il + iw;
+        float y1 = it, y2 = it + ih/2, y3 = it + ih;
+        if (tlC == blC) {
+            SDL_Color leftColor = {tlC.r, tlC.g, tlC.b, tlC.a};
+            SDL_Vertex verts[] = {
+                {{x1, y2}, leftColor, {0, 0}},
+                {{x2, y3}, leftColor, {0, 0}},
+                {{x2, y1}, leftColor, {0, 0}},
+            };
+            SDL_RenderGeometry(renderer, nullptr, verts, 3, nullptr, 0);
+            calls++;
+        } else {
+            SDL_Color tlColor = {tlC.r, tlC.g, tlC.b, tlC.a};
+            SDL_Color blColor = {blC.r, blC.g, blC.b, blC.a};
+            SDL_Vertex verts[] = {
+                {{x2, y2}, tlColor, {0, 0}},
+                {{x2, y1}, tlColor, {0, 0}},
+                {{x1, y2}, tlColor, {0, 0}},
+                {{x1, y2}, blColor, {0, 0}},
+                {{x2, y3}, blColor, {0, 0}},
+                {{x2, y2}, blColor, {0, 0}},
+            };
+            SDL_RenderGeometry(renderer, nullptr, verts, 6, nullptr, 0);
+            calls++;
+        }
+
+        if (brC == trC) {
+            SDL_Color rightColor = {trC.r, trC.g, trC.b, trC.a};
+            SDL_Vertex verts[] = {
+                {{x2, y1}, rightColor, {0, 0}},
+                {{x2, y3}, rightColor, {0, 0}},
+                {{x3, y2}, rightColor, {0, 0}},
+            };
+            SDL_RenderGeometry(renderer, nullptr, verts, 3, nullptr, 0);
+            calls++;
+        } else {
+            SDL_Color trColor = {trC.r, trC.g, trC.b, trC.a};
+            SDL_Color brColor = {brC.r, brC.g, brC.b, brC.a};
+            SDL_Vertex verts[] = {
+                {{x2, y1}, trColor, {0, 0}},
+                {{x2, y2}, trColor, {0, 0}},
+                {{x3, y2}, trColor, {0, 0}},
+                {{x3, y2}, brColor, {0, 0}},
+                {{x2, y2}, brColor, {0, 0}},
+                {{x2, y3}, brColor, {0, 0}},
+            };
+            SDL_RenderGeometry(renderer, nullptr, verts, 6, nullptr, 0);
+            calls++;
+        }
+    }
+    return calls;
+}
+
+static int drawLegacyTrapezoid(SDL_Renderer* renderer, Position pos, Size size, int borderWidth,
+        Widget::Color tC, Widget::Color lC, Widget::Color bC, Widget::Color rC)
+{
+    int calls = 0;
+    bool hasAlpha = tC.a != 0xff || lC.a != 0xff || bC.a != 0xff || rC.a != 0xff;
+
+    float il = pos.left;
+    float it = pos.top;
+    float iw = size.width;
+    float ih = size.height;
+
+    float ol = il - borderWidth;
+    float ot = it - borderWidth;
+    float ow = iw + 2 * borderWidth;
+    float oh = ih + 2 * borderWidth;
+    SDL_Color borderColor = {0, 0, 0, 255};
+
+    if (hasAlpha) {
+        // we have to draw 4 individual lines for border
+        float x1 = ol, x2 = ol + borderWidth, x3 = ol + ow/4, x4 = ol + ow/4 + borderWidth;
+        float x5 = ol + 3*ow/4 - borderWidth, x6 = ol + 3*ow/4, x7 = ol + ow - borderWidth, x8 = ol + ow;
+        float y1 = ot, y2 = ot + borderWidth, y3 = ot + oh - borderWidth, y4 = ot + oh;
+        SDL_Vertex verts[] = {
+            {{x1, y4}, borderColor, {0, 0}},
+            {{x2, y3}, borderColor, {0, 0}},
+            {{x3, y1}, borderColor, {0, 0}},
+            {{x4, y2}, borderColor, {0, 0}},
+            {{x5, y2}, borderColor, {0, 0}},
+            {{x6, y1}, borderColor, {0, 0}},
+            {{x7, y3}, borderColor, {0, 0}},
+            {{x8, y4}, borderColor, {0, 0}},
+        };
+        int indices[] = {
+            0, 1, 2,
+            2, 1, 3,
+            2, 3, 4,
+            2, 4, 5,
+            5, 4, 6,
+            5, 6, 7,
+            7, 1, 6,
+            7, 0, 1,
+        };
+        SDL_RenderGeometry(renderer, nullptr, verts, 8, indices, 24);
+        calls++;
+    } else {
+        // border as bigger background shape
+        float x1 = ol, x3 = ol + ow/4, x6 = ol + 3*ow/4, x8 = ol + ow;
+        float y1 = ot, y4 = ot + oh;
+        SDL_Vertex verts[] = {
+            {{x1, y4}, borderColor, {0, 0}},
+            {{x3, y1}, borderColor, {0, 0}},
+            {{x6, y1}, borderColor, {0, 0}},
+            {{x8, y4}, borderColor, {0, 0}},
+        };
+        int indices[] = {
+            0, 3, 1,
+            1, 3, 2
+        };
+        SDL_RenderGeometry(renderer, nullptr, verts, 4, indices, 6);
+        calls++;
+    }
+
+    {
+        float x1 = il, x2 = ol + ow/4 + borderWidth, x3 = il + iw/2, x4 = ol + 3*ow/4 - borderWidth, x5 = il + iw;
+        float y1 = it, y2 = it + ih/2, y3 = it + ih;
+
+        SDL_Color tColor = {tC.r, tC.g, tC.b, tC.a};
+        SDL_Color lColor = {lC.r, lC.g, lC.b, lC.a};
+        SDL_Color bColor = {bC.r, bC.g, bC.b, bC.a};
+        SDL_Color rColor = {rC.r, rC.g, rC.b, rC.a};
+        SDL_Vertex verts[] = {
+            {{x2, y1}, tColor, {0, 0}},
+            {{x3, y2}, tColor, {0, 0}},
+            {{x4, y1}, tColor, {0, 0}},
+            {{x1, y3}, lColor, {0, 0}},
+            {{x3, y2}, lColor, {0, 0}},
+            {{x2, y1}, lColor, {0, 0}},
+            {{x1, y3}, bColor, {0, 0}},
+            {{x5, y3}, bColor, {0, 0}},
+            {{x3, y2}, bColor, {0, 0}},
+            {{x5, y3}, rColor, {0, 0}},
+            {{x4, y1}, rColor, {0, 0}},
+            {{x3, y2}, rColor, {0, 0}},
+        };
+        SDL_RenderGeometry(renderer, nullptr, verts, 12, nullptr, 0);
+        calls++;
+    }
+    return calls;
+}
+
+
+/// Draws every rectangle and shape part on its own. Returns the number of draw calls.
+static int renderIndividually(MapPinsBenchData& data)
+{
+    // glows were a single SDL_RenderGeometry each before, too; the glow texture is not available in the
+    // benchmark, so glows are drawn untextured
+    static const Widget::Color glowColor = {0xff, 0xd7, 0x00, 0xcc};
+    int calls = 0;
+    GeometryBatch glowBatch;
+    for (const auto& pin: data.pins) {
+        if (!pin.glow)
+            continue;
+        if (pin.shape == PinShape::DIAMOND)
+            drawDiamondGlow(glowBatch, pin.pos, pin.size, glowColor);
+        else if (pin.shape == PinShape::TRAPEZOID)
+            drawTrapezoidGlow(glowBatch, pin.pos, pin.size, glowColor);
+        else
+            drawRectGlow(glowBatch, pin.pos, pin.size, glowColor);
+        calls += glowBatch.render(data.renderer, nullptr);
+        glowBatch.clear();
+    }
+    for (const auto& pin: data.pins) {
+        if (pin.shape == PinShape::DIAMOND)
+            calls += drawLegacyDiamond(data.renderer, pin.pos, pin.size, pin.border,
+                    pin.topC, pin.leftC, pin.botC, pin.rightC);
+        else if (pin.shape == PinShape::TRAPEZOID)
+            calls += drawLegacyTrapezoid(data.renderer, pin.pos, pin.size, pin.border,
+                    pin.topC, pin.leftC, pin.botC, pin.rightC);
+        else
+            calls += drawLegacyRect(data.renderer, pin.pos, pin.size, pin.border,
+                    pin.topC, pin.leftC, pin.botC, pin.rightC);
+    }
+    return calls;
+}
+
+/// Draws all glows, then all pins, in one call each. Returns the number of draw calls.
+static int renderBatched(MapPinsBenchData& data)
+{
+    static GeometryBatch glowBatch, pinBatch; // keep allocations between frames like MapWidget does
+    for (const auto& pin: data.pins)
+        addPin(glowBatch, pinBatch, pin);
+    return glowBatch.render(data.renderer, nullptr) + pinBatch.render(data.renderer, nullptr);
+}
+
+class MapPinsFixture {
+public:
+    typedef MapPinsBenchData Type;
+
+    Type& SetUp()
+    {
+        if (_data.renderer)
+            return _data;
+
+        _data.surf = SDL_CreateRGBSurfaceWithFormat(0, 1920, 1080, 32, SDL_PIXELFORMAT_ARGB8888);
+        assert(_data.surf);
+        _data.renderer = SDL_CreateSoftwareRenderer(_data.surf);
+        assert(_data.renderer);
+        SDL_SetRenderDrawBlendMode(_data.renderer, SDL_BLENDMODE_BLEND);
+
+        const Widget::Color colors[] = {
+            {0x20, 0xff, 0x20}, {0xcf, 0x10, 0x10}, {0xff, 0xff, 0x20}, {0x30, 0x40, 0xff, 0xc0},
+        };
+        unsigned seed = 1;
+        auto rnd = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (int)((seed >> 16) & 0x7fff);
+        };
+        for (int i = 0; i < NUM_PINS; i++) {
+            const int size = 8 + rnd() % 16;
+            const Widget::Color& c1 = colors[rnd() % 4];
+            const Widget::Color& c2 = (i % 3) ? c1 : colors[rnd() % 4]; // some split shapes
+            _data.pins.push_back({
+                {rnd() % 1900, rnd() % 1060}, {size, size}, 2, (PinShape)(i % 3),
+                c1, c1, c2, c2, (i % 5) == 0,
+            });
+        }
+
+        const int individualCalls = renderIndividually(_data);
+        const int batchedCalls = renderBatched(_data);
+        printf("MapPins: %d pins, %d draw calls individually, %d draw calls batched\n",
+                NUM_PINS, individualCalls, batchedCalls);
+
+        return _data;
+    }
+
+    void TearDown()
+    {
+    }
+
+    ~MapPinsFixture()
+    {
+        if (_data.renderer)
+            SDL_DestroyRenderer(_data.renderer);
+        if (_data.surf)
+            SDL_FreeSurface(_data.surf);
+    }
+
+private:
+    Type _data;
+};
+
+int mapPinsSink = 0;
+
+void BenchMapPinsIndividual(MapPinsFixture::Type& data)
+{
+    mapPinsSink += renderIndividually(data);
+}
+SLTBENCH_FUNCTION_WITH_FIXTURE(BenchMapPinsIndividual, MapPinsFixture);
+
+void BenchMapPinsBatched(MapPinsFixture::Type& data)
+{
+    mapPinsSink += renderBatched(data);
+}
+SLTBENCH_FUNCTION_WITH_FIXTURE(BenchMapPinsBatched, MapPinsFixture);
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/// Keeps track of what APTracker delivered to the pack, to decide whether a reconnect can resume the pack's state,
+/// which items to deliver and how a sync has to be done. Does not talk to the server.
+class APSyncState final {
+public:
+    enum class ItemAction {
+        SKIP, ///< already delivered or out of order
+        DELIVER,
+        REPLAY_AND_DELIVER, ///< a sync is done, replay onClear and checked locations first
+    };
+
+    enum class SyncAction {
+        FAIL, ///< not connected
+        REQUEST, ///< ask the server to send all items again, then call syncRequested
+        REPLAY_CLEAR, ///< no item was received yet, replay onClear and checked locations right away
+        PENDING, ///< a requested sync did not finish yet
+    };
+
+    /// Call when a slot is connected. Returns true if the pack's state can be resumed from what was delivered for
+    /// the same seed, team and slot before. Otherwise everything is delivered again, starting with onClear.
+    bool connected(const std::string& seed, int team, int slot)
+    {
+        _applied = true;
+        if (canResume(seed, team, slot)) {
+            _itemIndex = _resume.itemIndex;
+            return true;
+        }
+        _itemIndex = 0;
+        _resume = {seed, team, slot, 0, {}};
+        return false;
+    }
+
+    /// Call when the slot is disconnected with the locations that were checked at that time.
+    void disconnected(const std::set<int64_t>& checkedLocations)
+    {
+        save(checkedLocations);
+        _syncing = false;
+    }
+
+    /// Call when the connection is dropped, with the locations that were checked at that time.
+    void reset(const std::set<int64_t>& checkedLocations)
+    {
+        disconnected(checkedLocations);
+        _applied = false;
+        _itemIndex = 0;
+    }
+
+    /// Decides what to do with a received item. Call itemDelivered after delivering it.
+    ItemAction receiveItem(int index)
+    {
+        if (index != _itemIndex)
+            return ItemAction::SKIP;
+        // TODO: Sync if index > _itemIndex
+        if (_syncing) {
+            // we started a sync to reset state
+            _syncing = false;
+            return ItemAction::REPLAY_AND_DELIVER;
+        }
+        return ItemAction::DELIVER;
+    }
+
+    void itemDelivered()
+    {
+        _itemIndex++;
+    }
+
+    /// Decides how to sync after the state was changed outside of AP. A reconnect has to replay everything then.
+    SyncAction sync(bool isConnected)
+    {
+        if (!isConnected) {
+            _resume = {};
+            return SyncAction::FAIL;
+        }
+        if (_itemIndex > 0 && !_syncing)
+            return SyncAction::REQUEST;
+        if (!_syncing)
+            return SyncAction::REPLAY_CLEAR;
+        return SyncAction::PENDING;
+    }
+
+    /// Call after SyncAction::REQUEST with the result of sending the request.
+    void syncRequested(bool ok)
+    {
+        if (!ok) {
+            _resume = {};
+            return;
+        }
+        _syncing = true;
+        _itemIndex = 0;
+    }
+
+    /// Returns the locations in checkedLocations that were not checked when the resumed state was saved.
+    std::vector<int64_t> newLocations(const std::set<int64_t>& checkedLocations) const
+    {
+        std::vector<int64_t> res;
+        std::set_difference(checkedLocations.begin(), checkedLocations.end(),
+                _resume.checkedLocations.begin(), _resume.checkedLocations.end(),
+                std::back_inserter(res));
+        return res;
+    }
+
+    int getItemIndex() const
+    {
+        return _itemIndex;
+    }
+
+    bool isSyncing() const
+    {
+        return _syncing;
+    }
+
+private:
+    /// What was delivered to the pack for a slot, so a reconnect to the same slot only has to deliver the difference.
+    struct ResumeState final {
+        std::string seed; ///< empty if there is nothing to resume
+        int team = -1;
+        int slot = -1;
+        int itemIndex = 0;
+        std::set<int64_t> checkedLocations;
+    };
+
+    [[nodiscard]]
+    bool canResume(const std::string& seed, int team, int slot) const
+    {
+        return !_resume.seed.empty() && _resume.seed == seed && _resume.team == team && _resume.slot == slot;
+    }
+
+    void save(const std::set<int64_t>& checkedLocations)
+    {
+        if (!_applied || _resume.seed.empty())
+            return;
+        if (_syncing) {
+            // replay was not finished, so the pack's state is incomplete
+            _resume = {};
+            return;
+        }
+        _resume.itemIndex = _itemIndex;
+        _resume.checkedLocations = checkedLocations;
+    }
+
+    int _itemIndex = 0;
+    bool _syncing = false;
+    bool _applied = false; ///< _itemIndex and checked locations were delivered for _resume's slot
+    ResumeState _resume;
+};
@@ -6,6 +6,8 @@
 #include <string>
 #include <map>
 #include <list>
+#include <set>
+#include "apsyncstate.h"
 #include "../core/signal.h"
 #include "../core/fileutil.h"
 #include "../core/assets.h"
@@ -16,11 +18,24 @@
 #include <time.h>
 #include <random>
 #include <stdint.h>
+#include <vector>
 
 
 class APTracker final {
     typedef nlohmann::json json;
 public:
+    struct ItemEvent final {
+        int index;
+        int64_t item;
+        std::string itemName;
+        int player;
+    };
+
+    struct LocationEvent final {
+        int64_t location;
+        std::string locationName;
+    };
+
     APTracker(const std::string& appname, const std::string& game="", bool allowSend=false, bool allowScout=false)
             : _appname(appname), _game(game), _allowSend(allowSend), _allowScout(allowScout)
     {
@@ -126,18 +141,23 @@ public:
         _ap->set_slot_connected_handler([this](const json& slotData) {
             auto lock = EventLock(_event);
             onStateChanged.emit(this, _ap->get_state());
-            _itemIndex = 0;
             _slotData = slotData;
             _checkedLocations = _ap->get_checked_locations();
             _uncheckedLocations = _ap->get_missing_locations();
-            onClear.emit(this, slotData);
+            if (_sync.connected(_ap->get_seed(), _ap->get_team_number(), _ap->get_player_number())) {
+                // same slot of the same seed -> only deliver what changed while we were gone
+                resume();
+            } else {
+                _notifyKeys.clear();
+                onClear.emit(this, slotData);
+            }
 
             // update mtime of uuid file
             touchUUID();
         });
         _ap->set_slot_disconnected_handler([this]() {
             auto lock = EventLock(_event);
-            _syncing = false;
+            _sync.disconnected(_checkedLocations);
             onStateChanged.emit(this, _ap->get_state());
         });
         _ap->set_bounced_handler([this](const json& packet) {
@@ -146,31 +166,35 @@ public:
         });
         _ap->set_items_received_handler([this](const std::list<APClient::NetworkItem>& items) {
             auto lock = EventLock(_event);
+            std::vector<ItemEvent> batch;
             for (const auto& item: items) {
-                if (item.index != _itemIndex) continue;
-                // TODO: Sync if item.index > _itemIndex
-                if (_syncing) {
-                    // we started a sync to reset state -> replay onClear and onLocationChecked
-                    _syncing = false;
-                    onClear.emit(this, _slotData);
-                    // create copy in case Lua checks locations
-                    const auto checkedLocations = _checkedLocations;
-                    for (int64_t location: checkedLocations) {
-                        _uncheckedLocations.erase(location);
-                        onLocationChecked.emit(this, location, _ap->get_location_name(location, _ap->get_game()));
-                    }
-                }
-                onItem.emit(this, item.index, item.item, _ap->get_item_name(item.item, _ap->get_game()), item.player);
-                _itemIndex++;
+                const auto action = _sync.receiveItem(item.index);
+                if (action == APSyncState::ItemAction::SKIP)
+                    continue;
+                if (action == APSyncState::ItemAction::REPLAY_AND_DELIVER)
+                    replayClear(); // we started a sync to reset state -> replay onClear and onLocationChecked
+                ItemEvent event{item.index, item.item, _ap->get_item_name(item.item, _ap->get_game()), item.player};
+                onItem.emit(this, event.index, event.item, event.itemName, event.player);
+                if (!onItems.empty())
+                    batch.push_back(std::move(event));
+                _sync.itemDelivered();
             }
+            if (!batch.empty())
+                onItems.emit(this, batch);
         });
         _ap->set_location_checked_handler([this](const std::list<int64_t>& locations) {
             auto lock = EventLock(_event);
+            std::vector<LocationEvent> batch;
             for (int64_t location: locations) {
                 _checkedLocations.insert(location);
                 _uncheckedLocations.erase(location);
-                onLocationChecked.emit(this, location, _ap->get_location_name(location, _ap->get_game()));
+                LocationEvent event{location, _ap->get_location_name(location, _ap->get_game())};
+                onLocationChecked.emit(this, event.location, event.locationName);
+                if (!onLocationsChecked.empty())
+                    batch.push_back(std::move(event));
             }
+            if (!batch.empty())
+                onLocationsChecked.emit(this, batch);
         });
         _ap->set_location_info_handler([this](const std::list<APClient::NetworkItem>& scouts) {
             auto lock = EventLock(_event);
@@ -204,13 +228,12 @@ public:
             return;
         }
         bool wasConnected = _ap && _ap->get_state() != APClient::State::DISCONNECTED;
+        _sync.reset(_checkedLocations);
         if (_ap) delete _ap;
         _ap = nullptr;
         if (wasConnected)
             onStateChanged.emit(this, APClient::State::DISCONNECTED);
         _scheduleDisconnect = false;
-        _itemIndex = 0;
-        _syncing = false;
         _slotData.clear();
         _checkedLocations.clear();
         _uncheckedLocations.clear();
@@ -289,7 +312,13 @@ public:
 
     bool SetNotify(const std::list<std::string>& keys)
     {
-        return _ap ? _ap->SetNotify(keys) : false;
+        if (!_ap || !_ap->SetNotify(keys))
+            return false;
+        for (const auto& key: keys) {
+            if (std::find(_notifyKeys.begin(), _notifyKeys.end(), key) == _notifyKeys.end())
+                _notifyKeys.push_back(key);
+        }
+        return true;
     }
 
     bool Get(const std::list<std::string>& keys)
@@ -299,22 +328,21 @@ public:
 
     bool Sync()
     {
-        if (!_ap)
-            return false;
-        if (_itemIndex > 0 && !_syncing) {
-            if (!_ap->Sync())
+        // state was changed outside of AP, so a reconnect has to replay everything
+        switch (_sync.sync(_ap != nullptr)) {
+            case APSyncState::SyncAction::FAIL:
                 return false;
-            _syncing = true;
-            _itemIndex = 0;
-        } else if (!_syncing) {
-            // never received an item, so we can immediately run onClear
-            onClear.emit(this, _slotData);
-            // create copy in case Lua checks locations
-            const auto checkedLocations = _checkedLocations;
-            for (int64_t location: checkedLocations) {
-                _uncheckedLocations.erase(location);
-                onLocationChecked.emit(this, location, _ap->get_location_name(location, _ap->get_game()));
+            case APSyncState::SyncAction::REQUEST: {
+                const bool ok = _ap->Sync();
+                _sync.syncRequested(ok);
+                return ok;
             }
+            case APSyncState::SyncAction::REPLAY_CLEAR:
+                // never received an item, so we can immediately run onClear
+                replayClear();
+                break;
+            case APSyncState::SyncAction::PENDING:
+                break;
         }
         return true;
     }
@@ -374,11 +402,52 @@ public:
     Signal<int, int64_t, const std::string&, int> onItem; // index, item, item_name, player
     Signal<int64_t, const std::string&, int64_t, const std::string&, int> onScout; // location, location_name, item, item_name, target player
     Signal<int64_t, const std::string&> onLocationChecked; // location, location_name
+    Signal<const std::vector<ItemEvent>&> onItems; // all items of a packet, after the individual onItem
+    Signal<const std::vector<LocationEvent>&> onLocationsChecked; // all locations of a packet, after onLocationChecked
     Signal<const json&> onBounced; // packet
     Signal<const std::string&, const json&> onRetrieved;
     Signal<const std::string&, const json&, const json&> onSetReply;
 
 private:
+    /// Re-registers data storage notifications and emits locations that were checked since the state was saved.
+    /// Items are filtered by index when they arrive.
+    void resume()
+    {
+        if (!_notifyKeys.empty()) {
+            // values may have changed while disconnected; they arrive as Retrieved
+            _ap->SetNotify(_notifyKeys);
+            _ap->Get(_notifyKeys);
+        }
+        const std::vector<int64_t> newLocations = _sync.newLocations(_checkedLocations);
+        std::vector<LocationEvent> batch;
+        for (int64_t location: newLocations) {
+            LocationEvent event{location, _ap->get_location_name(location, _ap->get_game())};
+            onLocationChecked.emit(this, event.location, event.locationName);
+            if (!onLocationsChecked.empty())
+                batch.push_back(std::move(event));
+        }
+        if (!batch.empty())
+            onLocationsChecked.emit(this, batch);
+    }
+
+    /// Emits onClear followed by all checked locations.
+    void replayClear()
+    {
+        onClear.emit(this, _slotData);
+        // create copy in case Lua checks locations
+        const auto checkedLocations = _checkedLocations;
+        std::vector<LocationEvent> batch;
+        for (int64_t location: checkedLocations) {
+            _uncheckedLocations.erase(location);
+            LocationEvent event{location, _ap->get_location_name(location, _ap->get_game())};
+            onLocationChecked.emit(this, event.location, event.locationName);
+            if (!onLocationsChecked.empty())
+                batch.push_back(std::move(event));
+        }
+        if (!batch.empty())
+            onLocationsChecked.emit(this, batch);
+    }
+
     bool connectSlot(const std::string& slot, const std::string& pw) const
     {
         std::list<std::string> tags = {"PopTracker", "NoText"};
@@ -397,13 +466,13 @@ private:
     bool _allowSend;
     bool _allowScout;
     std::string _uuid;
-    int _itemIndex = 0;
     std::set<int64_t> _checkedLocations;
     std::set<int64_t> _uncheckedLocations;
     int _event = 0;
     bool _scheduleDisconnect = false;
     json _slotData;
-    bool _syncing = false;
+    APSyncState _sync;
+    std::list<std::string> _notifyKeys; ///< keys passed to SetNotify since the last onClear
 
     static const std::map<std::string, std::string> _errorMessages;
 
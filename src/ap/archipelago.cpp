@@ -11,6 +11,8 @@ const LuaInterface<Archipelago>::MethodMap Archipelago::Lua_Methods = {
     LUA_METHOD(Archipelago, AddClearHandler, const char*, LuaRef),
     LUA_METHOD(Archipelago, AddItemHandler, const char*, LuaRef),
     LUA_METHOD(Archipelago, AddLocationHandler, const char*, LuaRef),
+    LUA_METHOD(Archipelago, AddItemsHandler, const char*, LuaRef),
+    LUA_METHOD(Archipelago, AddLocationsHandler, const char*, LuaRef),
     LUA_METHOD(Archipelago, AddScoutHandler, const char*, LuaRef),
     LUA_METHOD(Archipelago, AddBouncedHandler, const char*, LuaRef),
     LUA_METHOD(Archipelago, AddRetrievedHandler, const char*, LuaRef),
@@ -27,8 +29,32 @@ const LuaInterface<Archipelago>::MethodMap Archipelago::Lua_Methods = {
     LUA_METHOD(Archipelago, GetLocationName, int, const char*),
 };
 
-Archipelago::Archipelago(lua_State *L, APTracker *ap)
-    : _L(L), _ap(ap)
+namespace {
+
+/// Sets BulkUpdate on the tracker for its lifetime, unless it was already set.
+class ScopedBulkUpdate final {
+public:
+    explicit ScopedBulkUpdate(Tracker* tracker)
+        : _tracker((tracker && !tracker->isBulkUpdate()) ? tracker : nullptr)
+    {
+        if (_tracker)
+            _tracker->setBulkUpdate(true);
+    }
+
+    ~ScopedBulkUpdate()
+    {
+        if (_tracker)
+            _tracker->setBulkUpdate(false);
+    }
+
+private:
+    Tracker* _tracker;
+};
+
+} // namespace
+
+Archipelago::Archipelago(lua_State *L, APTracker *ap, Tracker *tracker)
+    : _L(L), _ap(ap), _tracker(tracker)
 {
 }
 
@@ -112,6 +138,94 @@ bool Archipelago::AddLocationHandler(const std::string& name, LuaRef callback)
     return true;
 }
 
+bool Archipelago::AddItemsHandler(const std::string& name, LuaRef callback)
+{
+    if (!_ap || !callback.valid()) return false;
+    if (_itemsHandlers.empty()) {
+        _ap->onItems += {this, [this](void*, const std::vector<APTracker::ItemEvent>& items) {
+            runItemsHandlers(items);
+        }};
+    }
+    _itemsHandlers.emplace_back(name, callback.ref);
+    return true;
+}
+
+bool Archipelago::AddLocationsHandler(const std::string& name, LuaRef callback)
+{
+    if (!_ap || !callback.valid()) return false;
+    if (_locationsHandlers.empty()) {
+        _ap->onLocationsChecked += {this, [this](void*, const std::vector<APTracker::LocationEvent>& locations) {
+            runLocationsHandlers(locations);
+        }};
+    }
+    _locationsHandlers.emplace_back(name, callback.ref);
+    return true;
+}
+
+void Archipelago::runItemsHandlers(const std::vector<APTracker::ItemEvent>& items)
+{
+    // logic and UI are updated once after all handlers ran
+    ScopedBulkUpdate bulkUpdate(_tracker);
+    const auto handlers = _itemsHandlers; // copy in case Lua adds handlers
+    for (const auto& handler: handlers) {
+        if (!lua_checkstack(_L, 5))
+            return;
+        lua_pushcfunction(_L, Tracker::luaErrorHandler);
+        lua_rawgeti(_L, LUA_REGISTRYINDEX, handler.second);
+        lua_createtable(_L, (int)items.size(), 0);
+        for (size_t i = 0; i < items.size(); i++) {
+            const auto& item = items[i];
+            lua_createtable(_L, 0, 4);
+            Lua(_L).Push(item.index);
+            lua_setfield(_L, -2, "index");
+            Lua(_L).Push(item.item);
+            lua_setfield(_L, -2, "item");
+            Lua(_L).Push(item.itemName.c_str());
+            lua_setfield(_L, -2, "item_name");
+            Lua(_L).Push(item.player);
+            lua_setfield(_L, -2, "player");
+            lua_rawseti(_L, -2, (lua_Integer)i + 1);
+        }
+        if (lua_pcall(_L, 1, 0, -3)) {
+            const char* err = lua_tostring(_L, -1);
+            printf("Error calling Archipelago ItemsHandler for %s: %s\n",
+                    handler.first.c_str(), err ? err : "Unknown");
+            lua_pop(_L, 1); // error
+        }
+        lua_pop(_L, 1); // luaErrorHandler
+    }
+}
+
+void Archipelago::runLocationsHandlers(const std::vector<APTracker::LocationEvent>& locations)
+{
+    // logic and UI are updated once after all handlers ran
+    ScopedBulkUpdate bulkUpdate(_tracker);
+    const auto handlers = _locationsHandlers; // copy in case Lua adds handlers
+    for (const auto& handler: handlers) {
+        if (!lua_checkstack(_L, 5))
+            return;
+        lua_pushcfunction(_L, Tracker::luaErrorHandler);
+        lua_rawgeti(_L, LUA_REGISTRYINDEX, handler.second);
+        lua_createtable(_L, (int)locations.size(), 0);
+        for (size_t i = 0; i < locations.size(); i++) {
+            const auto& location = locations[i];
+            lua_createtable(_L, 0, 2);
+            Lua(_L).Push(location.location);
+            lua_setfield(_L, -2, "location");
+            Lua(_L).Push(location.locationName.c_str());
+            lua_setfield(_L, -2, "location_name");
+            lua_rawseti(_L, -2, (lua_Integer)i + 1);
+        }
+        if (lua_pcall(_L, 1, 0, -3)) {
+            const char* err = lua_tostring(_L, -1);
+            printf("Error calling Archipelago LocationsHandler for %s: %s\n",
+                    handler.first.c_str(), err ? err : "Unknown");
+            lua_pop(_L, 1); // error
+        }
+        lua_pop(_L, 1); // luaErrorHandler
+    }
+}
+
 bool Archipelago::AddScoutHandler(const std::string& name, LuaRef callback)
 {
     if (!_ap || !callback.valid()) return false;
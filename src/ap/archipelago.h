@@ -7,6 +7,12 @@
 #include <luaglue/lua_json.h>
 #include "../core/autotracker.h"
 #include "../ap/aptracker.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+
+class Tracker;
 
 class Archipelago;
 
@@ -14,12 +20,14 @@ class Archipelago : public LuaInterface<Archipelago> {
     friend class LuaInterface;
 
 public:
-    Archipelago(lua_State *L, APTracker *ap);
+    Archipelago(lua_State *L, APTracker *ap, Tracker *tracker = nullptr);
     virtual ~Archipelago();
 
     bool AddClearHandler(const std::string& name, LuaRef callback);
     bool AddItemHandler(const std::string& name, LuaRef callback);
     bool AddLocationHandler(const std::string& name, LuaRef callback);
+    bool AddItemsHandler(const std::string& name, LuaRef callback);
+    bool AddLocationsHandler(const std::string& name, LuaRef callback);
     bool AddScoutHandler(const std::string& name, LuaRef callback);
     bool AddBouncedHandler(const std::string& name, LuaRef callback);
     bool AddRetrievedHandler(const std::string& name, LuaRef callback);
@@ -38,6 +46,12 @@ public:
 protected:
     lua_State *_L;
     APTracker *_ap;
+    Tracker *_tracker; ///< wrapped in BulkUpdate while running batch handlers
+    std::vector<std::pair<std::string, int>> _itemsHandlers; ///< name, callback ref
+    std::vector<std::pair<std::string, int>> _locationsHandlers;
+
+    void runItemsHandlers(const std::vector<APTracker::ItemEvent>& items);
+    void runLocationsHandlers(const std::vector<APTracker::LocationEvent>& locations);
 
 protected: // Lua interface implementation
     static constexpr const char Lua_Name[] = "Archipelago";
@@ -0,0 +1,99 @@
+#include "autosaver.h"
+#include "fileutil.h"
+#include "statemanager.h"
+
+
+using nlohmann::json;
+
+
+Autosaver::Autosaver(Tracker* tracker, const std::string& name)
+    : _tracker(tracker), _name(name)
+{
+    _binary = StateManager::isBinary();
+    _file = StateManager::getStateFile(tracker->getPack(), name);
+    _tracker->onStateChanged += {this, [this](void*, const std::string&) {
+        _dirty = true;
+    }};
+    _tracker->onLocationSectionChanged += {this, [this](void*, const LocationSection&) {
+        _dirty = true;
+    }};
+    _thread = std::thread(&Autosaver::run, this);
+}
+
+Autosaver::~Autosaver()
+{
+    _tracker->onStateChanged -= this;
+    _tracker->onLocationSectionChanged -= this;
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join(); // writes what is still queued
+}
+
+bool Autosaver::saveIfChanged(const std::list<std::pair<std::string, std::string>>& uiHints, const json& extra)
+{
+    if (!_dirty && uiHints == _lastUiHints && extra == _lastExtra)
+        return false;
+    return save(uiHints, extra);
+}
+
+bool Autosaver::save(const std::list<std::pair<std::string, std::string>>& uiHints, const json& extra)
+{
+    json state = StateManager::makeState(_tracker, uiHints, extra);
+    if (state.is_null())
+        return false;
+    _dirty = false;
+    _lastUiHints = uiHints;
+    _lastExtra = extra;
+    printf("Saving state \"%s\" to file %s in background...\n",
+            _name.c_str(), sanitize_print(_file).c_str());
+    {
+        std::lock_guard lock(_mutex);
+        _pending = std::move(state);
+        _hasPending = true;
+    }
+    _cv.notify_all();
+    return true;
+}
+
+void Autosaver::run()
+{
+    std::unique_lock lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this]() { return _hasPending || _stop; });
+        if (!_hasPending)
+            break;
+        json state = std::move(_pending);
+        _hasPending = false;
+        lock.unlock();
+        write(state);
+        lock.lock();
+    }
+}
+
+void Autosaver::write(const json& state)
+{
+    std::string data;
+    try {
+        data = StateManager::encodeState(state, _binary);
+    } catch (std::exception& ex) {
+        fprintf(stderr, "error saving: %s\n", ex.what());
+        return;
+    }
+    if (data == _written)
+        return;
+    if (_written.empty()) {
+        // first save; the file may already be up to date from loading it
+        std::string old;
+        if (readFile(_file, old) && old == data) {
+            _written = std::move(data);
+            return;
+        }
+    }
+    fs::error_code ec;
+    fs::create_directories(_file.parent_path(), ec);
+    if (StateManager::writeStateFile(_file, data))
+        _written = std::move(data);
+}
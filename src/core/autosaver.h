@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "fs.h"
+#include "tracker.h"
+
+
+/// Saves a tracker's state to its state file in the background. Snapshots are taken on the calling thread, which has
+/// to own the tracker, since Lua items save their state through Lua. Serializing and writing happens on a worker
+/// thread. The file is only written if its content would change. The tracker has to outlive the Autosaver, which
+/// writes what is still queued when destroyed.
+class Autosaver final {
+public:
+    explicit Autosaver(Tracker* tracker, const std::string& name = "autosave");
+    Autosaver(const Autosaver&) = delete;
+    ~Autosaver();
+
+    /// Snapshots the state and queues it for writing, replacing a snapshot that is still queued.
+    /// Returns false if there was nothing to save.
+    bool save(const std::list<std::pair<std::string, std::string>>& uiHints, const nlohmann::json& extra);
+    /// Like save, but skips the snapshot if no change was signaled and ui hints and extra are unchanged.
+    /// Use this for periodic saves; not every change is signaled.
+    bool saveIfChanged(const std::list<std::pair<std::string, std::string>>& uiHints, const nlohmann::json& extra);
+
+private:
+    void run();
+    void write(const nlohmann::json& state);
+
+    Tracker* _tracker;
+    std::string _name;
+    fs::path _file;
+    bool _binary;
+    bool _dirty = true; ///< hint for saveIfChanged
+    std::list<std::pair<std::string, std::string>> _lastUiHints;
+    nlohmann::json _lastExtra;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    nlohmann::json _pending;
+    bool _hasPending = false;
+    bool _stop = false;
+    std::string _written; ///< last data in _file, only used by the worker
+    std::thread _thread;
+};
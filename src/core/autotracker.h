@@ -170,7 +170,8 @@ public:
 
     Signal<int, State> onStateChange;
     Signal<int, const std::string&> onSubNameChange;
-    Signal<> onDataChange;
+    /// Emitted with the changed ranges in backend address space (see mapRange) or nullptr if anything may have changed.
+    Signal<const std::vector<RangeSet::Range>*> onDataChange;
     Signal<const std::list<std::string>&> onVariablesChanged;
     Signal<const std::string&> onError;
 
@@ -194,6 +195,13 @@ public:
         return State::Unavailable;
     }
 
+    /// Returns true if an enabled backend has to be polled from the main thread.
+    /// USB2SNES runs in its own thread and wakes up the main loop instead.
+    bool needsPolling()
+    {
+        return backendEnabled(_ap) || backendEnabled(_uat) || backendEnabled(_provider);
+    }
+
     bool isAnyMemoryConnected()
     {
         for (int index = 0; index < (int)_state.size(); ++index) {
@@ -273,6 +281,9 @@ public:
 
             USB2SNES::Change changed = _snes->poll();
             if (!!changed) {
+                const std::vector<RangeSet::Range>* dirty = nullptr;
+                if (!!(changed & USB2SNES::Change::DATA) && _snes->takeDirtyRanges(_dirtyRanges))
+                    dirty = &_dirtyRanges;
                 int index = _backendIndex[_snes];
                 State oldState = _state[index];
                 bool wsConnected = _snes->wsConnected();
@@ -280,7 +291,7 @@ public:
 
                 if (!snesConnected && !!(changed & USB2SNES::Change::DATA)) {
                     // fire data change before firing disconnect
-                    onDataChange.emit(this);
+                    onDataChange.emit(this, dirty);
                 }
 
                 if (snesConnected) {
@@ -297,7 +308,7 @@ public:
 
                 if (snesConnected && !!(changed & USB2SNES::Change::DATA)) {
                     // fire data change after firing connect
-                    onDataChange.emit(this);
+                    onDataChange.emit(this, dirty);
                 }
 
                 res = true;
@@ -348,8 +359,9 @@ public:
             }
 
             if (_provider->update()) {
+                const bool known = _provider->takeDirtyRanges(_dirtyRanges);
                 if (_state[index] == State::ConsoleConnected) {
-                    onDataChange.emit(this);
+                    onDataChange.emit(this, known ? &_dirtyRanges : nullptr);
                 }
 
                 res = true;
@@ -359,32 +371,35 @@ public:
         return res;
     }
     
-    bool addWatch(unsigned addr, unsigned len)
+    /// Adds a watch that is polled every interval ms. 0 uses the interval set by setInterval.
+    /// removeWatch has to be called with the same interval.
+    bool addWatch(unsigned addr, unsigned len, unsigned interval=0)
     {
         if (addr<=0xffffff && _snes) {
-            _snes->addWatch((uint32_t)addr, len);
+            _snes->addWatch((uint32_t)addr, len, interval);
             return true;
         }
         if (_provider) {
-            _provider->addWatch((uint32_t)addr, len);
+            _provider->addWatch((uint32_t)addr, len, interval);
             return true;
         }
         return false;
     }
 
-    bool removeWatch(unsigned addr, unsigned len)
+    bool removeWatch(unsigned addr, unsigned len, unsigned interval=0)
     {
         if (addr<=0xffffff && _snes) {
-            _snes->removeWatch((uint32_t)addr, len);
+            _snes->removeWatch((uint32_t)addr, len, interval);
             return true;
         }
         if (_provider) {
-            _provider->removeWatch((uint32_t)addr, len);
+            _provider->removeWatch((uint32_t)addr, len, interval);
             return true;
         }
         return false;
     }
 
+    /// Sets the default polling interval for watches without their own interval.
     void setInterval(unsigned ms)
     {
         _interval = ms;
@@ -403,7 +418,43 @@ public:
             _provider->clearCache();
     }
     
+    /// Returns the range in backend address space that a watch of [addr, addr+len) receives changes for.
+    /// Returns false if the watch is not contiguous in backend address space or there is no backend for it.
+    bool mapRange(unsigned addr, unsigned len, RangeSet::Range& out)
+    {
+        if (!len)
+            return false;
+        uint32_t start, last;
+        if (addr<=0xffffff && _snes) {
+            start = _snes->mapaddr((uint32_t)addr);
+            last = _snes->mapaddr((uint32_t)(addr + len - 1));
+        } else if (_provider) {
+            start = _provider->mapAddress((uint32_t)addr);
+            last = _provider->mapAddress((uint32_t)(addr + len - 1));
+        } else {
+            return false;
+        }
+        if (last < start || last - start != len - 1)
+            return false;
+        out = {start, len};
+        return true;
+    }
+
+    /// Same as read below without allocating. Returns false if there is no backend to read from.
+    bool read(unsigned addr, unsigned len, uint8_t* out)
+    {
+        if (_snes) {
+            _snes->read((uint32_t)addr, len, out);
+            return true;
+        } else if (_provider) {
+            _provider->readFromCache(out, (uint32_t)addr, len);
+            return true;
+        }
+        return false;
+    }
+
     // TODO: canRead(addr,len) to detect incomplete segment
+
     std::vector<uint8_t> read(unsigned addr, unsigned len)
     {
         std::vector<uint8_t> res;
@@ -614,6 +665,31 @@ public:
         return _provider;
     }
 
+    /// Replaces the memory provider, or adds it as a new back-end if there was none. Takes ownership.
+    /// The provider starts disabled.
+    void setAutotrackProvider(IAutotrackProvider* provider)
+    {
+        int index;
+        if (_provider) {
+            index = _backendIndex[_provider];
+            if (backendEnabled(_provider))
+                _provider->stop();
+            _backendIndex.erase(_provider);
+            delete _provider;
+        } else {
+            index = ++_lastBackendIndex;
+            _state.push_back(State::Disabled);
+        }
+        _provider = provider;
+        _backendIndex[_provider] = index;
+        if (_interval != INTERVAL_UNSET)
+            _provider->setWatchUpdateInterval(_interval);
+        if (_state[index] != State::Disabled) {
+            _state[index] = State::Disabled;
+            onStateChange.emit(this, index, _state[index]);
+        }
+    }
+
     void setSnesAddresses(const std::vector<std::string>& addresses)
     {
         _snesAddresses = addresses;
@@ -660,6 +736,7 @@ protected:
     unsigned _interval = INTERVAL_UNSET;
     USB2SNES::Mapping _snesMapping;
     std::string _apAlias;
+    std::vector<RangeSet::Range> _dirtyRanges; ///< reused for onDataChange
 
     static constexpr unsigned INTERVAL_UNSET = std::numeric_limits<unsigned>::max();
 
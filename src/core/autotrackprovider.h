@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include "rangeset.h"
 
 class IAutotrackProvider {
 public:
@@ -22,8 +23,17 @@ public:
 
     virtual void clearCache() = 0;
 
-    virtual void addWatch(uint32_t address, unsigned int length) = 0;
-    virtual void removeWatch(uint32_t address, unsigned int length) = 0;
+    // Moves the address ranges (as returned by mapAddress) changed since the last call into out.
+    // Returns false if the provider does not track changed ranges, i.e. all data has to be considered dirty.
+    virtual bool takeDirtyRanges(std::vector<RangeSet::Range>& out)
+    {
+        out.clear();
+        return false;
+    }
+
+    // interval is in ms, 0 means the interval set by setWatchUpdateInterval
+    virtual void addWatch(uint32_t address, unsigned int length, unsigned interval = 0) = 0;
+    virtual void removeWatch(uint32_t address, unsigned int length, unsigned interval = 0) = 0;
     virtual void setWatchUpdateInterval(size_t interval) = 0;
 
     virtual void setMapping(const std::set<std::string>& flags) = 0;
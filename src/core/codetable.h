@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/// Interns strings (item codes, location references, ...) so they can be referenced by a small integer ID.
+class CodeTable final {
+public:
+    typedef uint32_t ID;
+    static constexpr ID INVALID = UINT32_MAX;
+
+    /// Returns the ID for code, adding it if it does not exist yet.
+    ID intern(const std::string& code)
+    {
+        const auto it = _ids.find(code);
+        if (it != _ids.end())
+            return it->second;
+        const auto id = static_cast<ID>(_names.size());
+        _names.push_back(code);
+        _ids.emplace(code, id);
+        return id;
+    }
+
+    /// Returns the ID for code or INVALID if it was never interned.
+    ID find(const std::string& code) const
+    {
+        const auto it = _ids.find(code);
+        return it == _ids.end() ? INVALID : it->second;
+    }
+
+    const std::string& name(const ID id) const
+    {
+        return _names[id];
+    }
+
+    size_t size() const
+    {
+        return _names.size();
+    }
+
+private:
+    std::vector<std::string> _names;
+    std::unordered_map<std::string, ID> _ids;
+};
@@ -0,0 +1,79 @@
+#include "compiledrules.h"
+#include <cstdio>
+#include <cstdlib>
+#include "util.h"
+
+
+CompiledRules CompiledRules::Compile(const std::list<std::list<std::string>>& rules,
+                                     const Interner& internCode, const Interner& internReference)
+{
+    CompiledRules res;
+    for (const auto& ruleset : rules) { //<-- these are all to be ORed
+        bool inspectOnly = false;
+        bool hasLevel = false;
+        for (const auto& rule : ruleset) { //<-- these are all to be ANDed
+            if (rule.empty())
+                continue; // empty/missing code is true
+            std::string s = rule;
+            uint8_t flags = 0;
+            // '{' ... '}' means required to check (i.e. the rule never returns "reachable", but "checkable" instead)
+            if (s[0] == '{') {
+                inspectOnly = true;
+                flags |= FLAG_BRACE_OPEN;
+                s = s.substr(1);
+            }
+            if (!inspectOnly && hasLevel && !s.empty() && s.back() == '}') {
+                // a previous ^$-rule returning "inspect" enables inspect-only at runtime, which strips the '}'
+                res.compileRule(s, false, flags | FLAG_HAS_ALT, internCode, internReference);
+                res.compileRule(s, true, 0, internCode, internReference);
+            } else {
+                res.compileRule(s, inspectOnly, flags, internCode, internReference);
+            }
+            if (res._ops.back().type == OpType::LEVEL)
+                hasLevel = true;
+        }
+        res._ops.push_back({OpType::END, 0, 0, 0});
+    }
+    return res;
+}
+
+void CompiledRules::compileRule(std::string s, const bool inspectOnly, uint8_t flags,
+                                const Interner& internCode, const Interner& internReference)
+{
+    if (inspectOnly && !s.empty() && s.back() == '}')
+        s.pop_back();
+    // '[' ... ']' means optional/glitches required (different color)
+    if (s.length() > 1 && s[0] == '[' && s.back() == ']') {
+        flags |= FLAG_OPTIONAL;
+        s = s.substr(1, s.length() - 2);
+    }
+    if (inspectOnly && s.empty()) {
+        _ops.push_back({OpType::SKIP, flags, 0, 0});
+        return;
+    }
+    // '^$func' gives direct accessibility level rather than an integer code count
+    const bool isAccessibilityLevel = !s.empty() && s[0] == '^';
+    // '@...' references another location or section
+    const bool isLocationReference = !s.empty() && s[0] == '@';
+    // '<rule>:<count>' checks count (e.g. consumables) instead of bool
+    int count = 1;
+    const auto p = s.find(':');
+    if (!isAccessibilityLevel && !isLocationReference && p != s.npos) {
+        count = atoi(s.c_str() + p + 1);
+        s = s.substr(0, p);
+    }
+    if (isAccessibilityLevel) {
+        if (s.length() < 3 || s[1] != '$') { // only ^$ supported
+            fprintf(stderr, "Warning: invalid rule \"%s\"\n", sanitize_print(s).c_str());
+            _ops.push_back({OpType::INVALID, flags, 0, 0});
+            return;
+        }
+        _ops.push_back({OpType::LEVEL, flags, internCode(s.substr(1)), 0});
+    } else if (isLocationReference) {
+        _ops.push_back({OpType::REFERENCE, flags, internReference(s.substr(1)), 0});
+    } else {
+        // '$' calls into Lua, other: references codes (with or without count)
+        // an empty code, e.g. from "[]" or ":2", is never provided
+        _ops.push_back({OpType::CODE, flags, internCode(s), count});
+    }
+}
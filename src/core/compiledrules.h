@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+
+/// Access or visibility rules compiled into a flat list of operations.
+/// Parsing of the rule strings happens once in Compile, Tracker::resolveRules only walks the operations.
+class CompiledRules final {
+public:
+    enum class OpType : uint8_t {
+        SKIP, ///< no test, but may still carry flags
+        CODE, ///< code has to be provided at least count times
+        LEVEL, ///< ^$-code, result is an AccessibilityLevel
+        REFERENCE, ///< @-reference to a location or section
+        INVALID, ///< invalid rule, fails the set of rules
+        END, ///< end of a set of rules that are ANDed; sets are ORed
+    };
+
+    enum Flags : uint8_t {
+        FLAG_BRACE_OPEN = 1, ///< '{': rest of the set is only required to inspect
+        FLAG_OPTIONAL = 2, ///< '[...]': glitches/sequence break required
+        FLAG_HAS_ALT = 4, ///< next op replaces this one if the set became inspect-only during evaluation
+    };
+
+    struct Op final {
+        OpType type;
+        uint8_t flags;
+        uint32_t arg; ///< code ID or reference ID
+        int count;
+    };
+
+    /// Interns a string and returns its ID
+    typedef std::function<uint32_t(const std::string&)> Interner;
+
+    static CompiledRules Compile(const std::list<std::list<std::string>>& rules,
+                                 const Interner& internCode, const Interner& internReference);
+
+    bool empty() const { return _ops.empty(); }
+    const Op* begin() const { return _ops.data(); }
+    const Op* end() const { return _ops.data() + _ops.size(); }
+
+private:
+    std::vector<Op> _ops;
+
+    void compileRule(std::string s, bool inspectOnly, uint8_t flags,
+                     const Interner& internCode, const Interner& internReference);
+};
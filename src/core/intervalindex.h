@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+
+/// Static index of address intervals with a value each, answering which intervals overlap a range.
+/// Entries are sorted by start address and carry the largest end address seen so far, so a query only looks at
+/// entries that start before the queried range ends and stops at the first one that can not reach it.
+template<typename T>
+class IntervalIndex final {
+public:
+    void clear()
+    {
+        _entries.clear();
+        _sorted = true;
+    }
+
+    /// Adds [start, start+length). Empty intervals never match.
+    void add(uint32_t start, uint32_t length, const T& value)
+    {
+        if (!length)
+            return;
+        _entries.push_back({start, (uint64_t)start + length, 0, value});
+        _sorted = false;
+    }
+
+    /// Calls f(value) for every interval overlapping [start, start+length).
+    template<typename F>
+    void query(uint32_t start, uint32_t length, F f)
+    {
+        if (!length)
+            return;
+        if (!_sorted)
+            sort();
+        const uint64_t end = (uint64_t)start + length;
+        auto it = std::lower_bound(_entries.begin(), _entries.end(), end, [](const Entry& entry, uint64_t addr) {
+            return entry.start < addr;
+        });
+        while (it != _entries.begin()) {
+            --it;
+            if (it->maxEnd <= start)
+                break;
+            if (it->end > start)
+                f(it->value);
+        }
+    }
+
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+    bool empty() const
+    {
+        return _entries.empty();
+    }
+
+private:
+    struct Entry final {
+        uint32_t start;
+        uint64_t end;
+        uint64_t maxEnd; ///< largest end of this and all previous entries
+        T value;
+    };
+
+    std::vector<Entry> _entries;
+    bool _sorted = true;
+
+    void sort()
+    {
+        std::stable_sort(_entries.begin(), _entries.end(), [](const Entry& a, const Entry& b) {
+            return a.start < b.start;
+        });
+        uint64_t maxEnd = 0;
+        for (auto& entry: _entries) {
+            maxEnd = std::max(maxEnd, entry.end);
+            entry.maxEnd = maxEnd;
+        }
+        _sorted = true;
+    }
+};
@@ -30,6 +30,22 @@ std::string JsonItem::getCodesString() const {
     return s;
 }
 
+std::vector<std::string> JsonItem::getProvidableCodes() const {
+#ifdef JSONITEM_CI_QUIRK
+    return {_ciAllCodes.begin(), _ciAllCodes.end()};
+#else
+    std::vector<std::string> res = _codes;
+    if (_type != Type::COMPOSITE_TOGGLE) {
+        // stages can provide codes, but not for composite toggle since the stages are fake
+        for (const auto& stage : _stages)
+            for (const auto& code : stage.getCodes())
+                if (std::find(res.begin(), res.end(), code) == res.end())
+                    res.push_back(code);
+    }
+    return res;
+#endif
+}
+
 const std::vector<std::string>& JsonItem::getCodes(int stage) const {
     if (_type == Type::TOGGLE) return _codes;
     if (stage>=0 && (size_t)stage<_stages.size()) return _stages[stage].getCodes();
@@ -150,6 +150,9 @@ public:
     }
 #endif
 
+    /// Returns all codes canProvideCode is true for. Lower case with JSONITEM_CI_QUIRK.
+    std::vector<std::string> getProvidableCodes() const;
+
     bool canProvideCode(const std::string& code) const override
     {
 #ifdef JSONITEM_CI_QUIRK
@@ -252,6 +252,24 @@ void Location::merge(const Location& other)
     }
 }
 
+void Location::compileRules(const CompiledRules::Interner& internCode,
+                            const CompiledRules::Interner& internReference)
+{
+    _compiledAccessRules = CompiledRules::Compile(_accessRules, internCode, internReference);
+    _compiledVisibilityRules = CompiledRules::Compile(_visibilityRules, internCode, internReference);
+    for (auto& maploc: _mapLocations)
+        maploc.compileRules(internCode, internReference);
+    for (auto& sec: _sections)
+        sec.compileRules(internCode, internReference);
+}
+
+void Location::MapLocation::compileRules(const CompiledRules::Interner& internCode,
+                                         const CompiledRules::Interner& internReference)
+{
+    _compiledVisibilityRules = CompiledRules::Compile(_visibilityRules, internCode, internReference);
+    _compiledInvisibilityRules = CompiledRules::Compile(_invisibilityRules, internCode, internReference);
+}
+
 Location::MapLocation Location::MapLocation::FromJSON(json& j)
 {
     MapLocation maploc;
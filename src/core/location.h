@@ -4,6 +4,7 @@
 #include <string>
 #include <luaglue/luainterface.h>
 #include <nlohmann/json.hpp>
+#include "compiledrules.h"
 #include "locationsection.h"
 
 
@@ -39,6 +40,8 @@ public:
         int _borderThickness = -1;
         std::list<std::list<std::string> > _visibilityRules;
         std::list<std::list<std::string> > _invisibilityRules;
+        CompiledRules _compiledVisibilityRules;
+        CompiledRules _compiledInvisibilityRules;
         Shape _shape = Shape::UNSPECIFIED;
 
     public:
@@ -55,6 +58,11 @@ public:
 
         const std::list<std::list<std::string>>& getVisibilityRules() const { return _visibilityRules; }
         const std::list<std::list<std::string>>& getInvisibilityRules() const { return _invisibilityRules; }
+        const CompiledRules& getCompiledVisibilityRules() const { return _compiledVisibilityRules; }
+        const CompiledRules& getCompiledInvisibilityRules() const { return _compiledInvisibilityRules; }
+
+        /// Compiles visibility rules for use in Tracker::resolveRules.
+        void compileRules(const CompiledRules::Interner& internCode, const CompiledRules::Interner& internReference);
     };
 
     static std::list<Location> FromJSON(
@@ -76,6 +84,8 @@ protected:
     std::list<LocationSection> _sections;
     std::list< std::list<std::string> > _accessRules; // this is only used if referenced through @-Rules
     std::list< std::list<std::string> > _visibilityRules;
+    CompiledRules _compiledAccessRules;
+    CompiledRules _compiledVisibilityRules;
     bool _glitchedScoutableAsGlitched = false;
 
 public:
@@ -89,9 +99,14 @@ public:
     const std::list< std::list<std::string> >& getAccessRules() const { return _accessRules; }
     std::list< std::list<std::string> >& getVisibilityRules() { return _visibilityRules; }
     const std::list< std::list<std::string> >& getVisibilityRules() const { return _visibilityRules; }
+    const CompiledRules& getCompiledAccessRules() const { return _compiledAccessRules; }
+    const CompiledRules& getCompiledVisibilityRules() const { return _compiledVisibilityRules; }
     bool getGlitchedScoutableAsGlitched() const { return _glitchedScoutableAsGlitched; }
     void merge(const Location& other);
 
+    /// Compiles access and visibility rules of the location, its sections and map locations.
+    void compileRules(const CompiledRules::Interner& internCode, const CompiledRules::Interner& internReference);
+
 #ifndef NDEBUG
     void dump(bool compact=false);
 #endif
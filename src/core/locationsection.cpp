@@ -150,6 +150,14 @@ LocationSection LocationSection::FromJSON(
 }
 
 
+void LocationSection::compileRules(const CompiledRules::Interner& internCode,
+                                   const CompiledRules::Interner& internReference)
+{
+    _compiledAccessRules = CompiledRules::Compile(_accessRules, internCode, internReference);
+    _compiledVisibilityRules = CompiledRules::Compile(_visibilityRules, internCode, internReference);
+}
+
+
 bool LocationSection::clearItem(bool all)
 {
     if (_itemCleared >= _itemCount) return false;
@@ -5,6 +5,7 @@
 #include <string_view>
 #include <luaglue/luainterface.h>
 #include <nlohmann/json.hpp>
+#include "compiledrules.h"
 #include "layoutnode.h" // Size
 #include "../core/signal.h"
 
@@ -47,6 +48,8 @@ protected:
     std::list<std::string> _hostedItems;
     std::list< std::list<std::string> > _accessRules;
     std::list< std::list<std::string> > _visibilityRules;
+    CompiledRules _compiledAccessRules;
+    CompiledRules _compiledVisibilityRules;
     std::string _overlayBackground;
     std::string _ref; // path to actual section if it's just a reference
     bool _glitchedScoutableAsGlitched = false;
@@ -56,8 +59,10 @@ protected:
 public:
     // getters
     const std::string& getName() const { return _name; }
-    const std::list< std::list<std::string> > getAccessRules() const { return _accessRules; }
-    const std::list< std::list<std::string> > getVisibilityRules() const { return _visibilityRules; }
+    const std::list< std::list<std::string> >& getAccessRules() const { return _accessRules; }
+    const std::list< std::list<std::string> >& getVisibilityRules() const { return _visibilityRules; }
+    const CompiledRules& getCompiledAccessRules() const { return _compiledAccessRules; }
+    const CompiledRules& getCompiledVisibilityRules() const { return _compiledVisibilityRules; }
     int getItemCount() const { return _itemCount; }
     int getItemCleared() const { return _itemCleared; }
     bool clearItem(bool all = false);
@@ -76,6 +81,9 @@ public:
 
     void setParentID(const std::string& id) { _parentId = id; }
 
+    /// Compiles access and visibility rules for use in Tracker::resolveRules.
+    void compileRules(const CompiledRules::Interner& internCode, const CompiledRules::Interner& internReference);
+
     nlohmann::json save() const;
     bool load(nlohmann::json& j);
 
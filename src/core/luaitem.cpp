@@ -109,6 +109,7 @@ bool LuaItem::Lua_NewIndex(lua_State *L, const char *key) {
     } else if (strcmp(key,"ItemState")==0) {
         if (_itemState.valid()) luaL_unref(L, LUA_REGISTRYINDEX, _itemState.ref);
         _itemState.ref = luaL_ref(L, LUA_REGISTRYINDEX); // pop copy and store
+        invalidateCanProvideCode();
         return true;
     } else if (strcmp(key,"Icon")==0) {
         // NOTE: this is a fake ImageReference, not just a path, so this can include ":mods" to preapply mods
@@ -148,6 +149,7 @@ bool LuaItem::Lua_NewIndex(lua_State *L, const char *key) {
         return true;
     } else if (strcmp(key,"CanProvideCodeFunc")==0) {
         _canProvideCodeFunc.ref = luaL_ref(L, LUA_REGISTRYINDEX); // pop copy and store
+        invalidateCanProvideCode();
         return true;
     } else if (strcmp(key,"ProvidesCodeFunc")==0) {
         _providesCodeFunc.ref = luaL_ref(L, LUA_REGISTRYINDEX); // pop copy and store
@@ -196,6 +198,7 @@ bool LuaItem::Lua_NewIndex(lua_State *L, const char *key) {
             luaL_error(L, msg.c_str());
             return false;
         }
+        invalidateCanProvideCode();
         return true;
     }
 
@@ -209,20 +212,29 @@ bool LuaItem::canProvideCode(const std::string& code) const
         return std::find(_potentialCodes->begin(), _potentialCodes->end(), code) != _potentialCodes->end();
     if (!_canProvideCodeFunc.valid())
         return false;
-    // TODO: cache result for performance reasons?
+    const auto it = _canProvideCodeCache.find(code);
+    if (it != _canProvideCodeCache.end())
+        return it->second;
     lua_rawgeti(_L, LUA_REGISTRYINDEX, _canProvideCodeFunc.ref);
     Lua_Push(_L); // arg1: this
     lua_pushstring(_L, code.c_str()); // arg2: code
     if (lua_pcall(_L, 2, 1, 0)) {
         printf("Error calling Item:CanProvideCode: %s\n", lua_tostring(_L, -1));
         lua_pop(_L, 1);
-        return false;
+        return false; // not cached, so the error is visible every time
     }
     const bool res = lua_toboolean(_L, -1);
     lua_pop(_L, 1);
+    _canProvideCodeCache.emplace(code, res);
     return res;
 }
 
+void LuaItem::invalidateCanProvideCode()
+{
+    _canProvideCodeCache.clear();
+    onCanProvideCodeChanged.emit(this);
+}
+
 int LuaItem::providesCode(const std::string& code) const
 {
     if (!_providesCodeFunc.valid())
@@ -337,6 +349,7 @@ void LuaItem::Set(const char* key, const LuaVariant& value)
         // otherwise keep track in an internal map
         _properties[key] = value;
     }
+    invalidateCanProvideCode();
     if (_propertyChangedFunc.valid()) {
         lua_rawgeti(_L, LUA_REGISTRYINDEX, _propertyChangedFunc.ref);
         Lua_Push(_L);            // arg1: this
@@ -393,7 +406,9 @@ bool LuaItem::load(json& j)
         lua_pop(_L, 2);
         return false;
     }
-    if (lua_pcall(_L, 2, 0, 0)) {
+    const int status = lua_pcall(_L, 2, 0, 0);
+    invalidateCanProvideCode(); // state may have changed even on error
+    if (status) {
         printf("Error calling Item:load for \"%s\": %s\n",
                 sanitize_print(_name).c_str(), lua_tostring(_L, -1));
         lua_pop(_L, 1);
@@ -3,6 +3,7 @@
 #include <list>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <luaglue/luainterface.h>
 #include <luaglue/luavariant.h>
@@ -22,6 +23,7 @@ public:
     void Set(const char* key, const LuaVariant& value);
     LuaVariant Get(const char* key);
 
+    /// Results of CanProvideCodeFunc are memoized until invalidateCanProvideCode is called.
     bool canProvideCode(const std::string& code) const override;
     int providesCode(const std::string& code) const override;
     bool changeState(Action action) override;
@@ -95,11 +97,19 @@ public:
 
     nlohmann::json save() const;
     bool load(nlohmann::json& j);
+
+    /// Drops memoized CanProvideCode results. Called when CanProvideCodeFunc, ItemState, PotentialCodes or a property
+    /// changed and after load, but not on every state change.
+    void invalidateCanProvideCode();
+
+    /// Emitted when the codes this item can provide may have changed.
+    Signal<> onCanProvideCodeChanged;
     
 private:
     lua_State *_L = nullptr; // FIXME: fix this
 
     std::optional<std::vector<std::string>> _potentialCodes; // vector should be faster than set for the common cases
+    mutable std::unordered_map<std::string, bool> _canProvideCodeCache; // code -> result of _canProvideCodeFunc
     LuaRef _itemState;
     LuaRef _onLeftClickFunc;
     LuaRef _onRightClickFunc;
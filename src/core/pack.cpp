@@ -4,6 +4,7 @@
 #include <utility>
 #include "fileutil.h"
 #include "jsonutil.h"
+#include "packcatalog.h"
 #include "sha256.h"
 #include "util.h"
 #include "version.h"
@@ -110,8 +111,12 @@ static bool dirNewerThan(const fs::path& path, const std::chrono::system_clock::
 }
 
 
+static constexpr size_t ZIP_CACHE_LIMIT = 4 * 1024 * 1024; // decompressed files read more than once
+
+
 std::vector<fs::path> Pack::_searchPaths;
 std::vector<fs::path> Pack::_overrideSearchPaths;
+std::unique_ptr<PackCatalog> Pack::_catalog;
 
 
 Pack::Pack(const fs::path& path) : _path(path)
@@ -120,6 +125,7 @@ Pack::Pack(const fs::path& path) : _path(path)
     std::string s;
     if (fs::is_regular_file(path)) {
         _zip = std::make_unique<Zip>(path.u8string().c_str());
+        _zip->setCacheLimit(ZIP_CACHE_LIMIT);
         const auto root = _zip->list();
         if (root.size() == 1 && root[0].first == Zip::EntryType::DIR) {
             _zip->setDir(root[0].second);
@@ -412,22 +418,68 @@ std::string Pack::getSHA256() const
     return "";
 }
 
+bool Pack::readStoredFile(const std::string& userFile, std::string_view& out) const
+{
+    // only for zips without user override, otherwise use ReadFile
+    if (!_zip || _override)
+        return false;
+    std::string file;
+    if (!sanitizePath(userFile, file))
+        return false;
+    if (!_variant.empty() && _zip->hasFile(_variant + "/" + file))
+        return _zip->readStoredFile(_variant + "/" + file, out);
+    return _zip->readStoredFile(file, out);
+}
+
 Ui::Size Pack::getImageSize(const std::string &userFile) const
 {
-    std::lock_guard lock(_imageSizeMutex);
-    const auto it = _imageSizeCache.find(userFile);
-    if (it != _imageSizeCache.end())
-        return it->second;
+    {
+        std::lock_guard lock(_imageSizeMutex);
+        const auto it = _imageSizeCache.find(userFile);
+        if (it != _imageSizeCache.end())
+            return it->second;
+    }
+    // read without lock, so sizes can be fetched in parallel
     std::string data;
     Ui::Size size = Ui::Size::UNDEFINED;
     if (ReadFile(userFile, data, true, Ui::getMaxImageHeaderLength()))
         size = Ui::getImageSize(data);
     else
         fprintf(stderr, "Error reading image file %s to get size\n", sanitize_print(userFile).c_str());
+    std::lock_guard lock(_imageSizeMutex);
     _imageSizeCache.emplace(userFile, size);
     return size;
 }
 
+std::vector<std::string> Pack::listFiles() const
+{
+    std::vector<std::string> res;
+    if (_zip) {
+        for (auto& [type, name]: _zip->list(true)) {
+            if (type == Zip::EntryType::FILE)
+                res.push_back(std::move(name));
+        }
+    } else if (fs::is_directory(_path)) {
+        std::string root = _path.u8string();
+        while (!root.empty() && (root.back() == '/' || root.back() == '\\'))
+            root.pop_back();
+        fs::error_code ec;
+        for (const auto& dirEntry: fs::recursive_directory_iterator{_path, ec}) {
+            if (!dirEntry.is_regular_file())
+                continue;
+            std::string name = dirEntry.path().u8string();
+            if (name.length() <= root.length() + 1 || name.compare(0, root.length(), root) != 0)
+                continue;
+            name = name.substr(root.length() + 1);
+#ifdef _WIN32
+            std::replace(name.begin(), name.end(), '\\', '/');
+#endif
+            res.push_back(std::move(name));
+        }
+    }
+    return res;
+}
+
 SDL_Surface* Pack::getImage(const std::string &userFile) const
 {
     {
@@ -442,11 +494,15 @@ SDL_Surface* Pack::getImage(const std::string &userFile) const
         }
     }
     std::string data;
-    if (!ReadFile(userFile, data, true)) {
-        fprintf(stderr, "Error reading image file %s for pixels\n", sanitize_print(userFile).c_str());
-        return nullptr;
+    std::string_view view;
+    if (!readStoredFile(userFile, view)) {
+        if (!ReadFile(userFile, data, true)) {
+            fprintf(stderr, "Error reading image file %s for pixels\n", sanitize_print(userFile).c_str());
+            return nullptr;
+        }
+        view = data;
     }
-    SDL_Surface* surface = Ui::LoadImageFromData(data);
+    SDL_Surface* surface = Ui::LoadImageFromData(view);
     if (surface && surface->w <= 4096 && surface->h <= 4096 && surface->w * surface->h <= 4096) {
         // cache 64x64 (16KB) and smaller
         std::lock_guard lock(_smallImageMutex);
@@ -464,17 +520,7 @@ SDL_Surface* Pack::getImage(const std::string &userFile) const
 
 std::vector<Pack::Info> Pack::ListAvailable()
 {
-    std::vector<Pack::Info> res;
-    for (auto& searchPath: _searchPaths) {
-        if (!fs::is_directory(searchPath))
-            continue;
-        for (auto const& dirEntry : fs::directory_iterator{searchPath}) {
-            Pack pack(dirEntry.path());
-            if (!pack.isValid())
-                continue;
-            res.push_back(pack.getInfo());
-        }
-    }
+    std::vector<Pack::Info> res = getCatalog().list(_searchPaths);
 
     std::sort(res.begin(), res.end(), [](const Pack::Info& lhs, const Pack::Info& rhs) {
         int n = strcasecmp(lhs.packName.c_str(), rhs.packName.c_str());
@@ -490,25 +536,21 @@ std::vector<Pack::Info> Pack::ListAvailable()
 
 Pack::Info Pack::Find(const std::string& uid, const std::string& version, const std::string& sha256)
 {
+    auto& catalog = getCatalog();
     std::vector<Pack::Info> packs;
-    for (auto& searchPath: _searchPaths) {
-        if (!fs::is_directory(searchPath))
+    for (auto& info: catalog.list(_searchPaths)) {
+        if (info.uid != uid)
             continue;
-        for (auto const& dirEntry : fs::directory_iterator{searchPath}) {
-            Pack pack(dirEntry.path());
-            if (!pack.isValid() || pack.getUID() != uid)
-                continue;
-            if (!sha256.empty()) {
-                // require exact match if hash is given
-                if ((version.empty() || pack.getVersion() == version) &&
-                        strcasecmp(pack.getSHA256().c_str(), sha256.c_str()) == 0) {
-                    return pack.getInfo(); // return exact match
-                }
-            } else if (!version.empty() && pack.getVersion() == version) {
-                return pack.getInfo(); // return exact version match
-            } else {
-                packs.push_back(pack.getInfo());
+        if (!sha256.empty()) {
+            // require exact match if hash is given
+            if ((version.empty() || info.version == version) &&
+                    strcasecmp(catalog.getSHA256(info.path).c_str(), sha256.c_str()) == 0) {
+                return info; // return exact match
             }
+        } else if (!version.empty() && info.version == version) {
+            return info; // return exact version match
+        } else {
+            packs.push_back(std::move(info));
         }
     }
 
@@ -577,6 +619,20 @@ void Pack::addOverrideSearchPath(const fs::path& path)
     addPath(path, _overrideSearchPaths);
 }
 
+void Pack::setCatalogFile(const fs::path& path)
+{
+    _catalog.reset(); // finish and save previous one first
+    _catalog = std::make_unique<PackCatalog>(path);
+    _catalog->updateAsync(_searchPaths);
+}
+
+PackCatalog& Pack::getCatalog()
+{
+    if (!_catalog)
+        _catalog = std::make_unique<PackCatalog>();
+    return *_catalog;
+}
+
 Pack::Override::Override(fs::path path)
     : _path(std::move(path))
 {
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <SDL2/SDL_surface.h>
@@ -13,6 +15,8 @@
 #include "../uilib/size.h"
 
 
+class PackCatalog;
+
 class Pack final {
 public:
     struct VariantInfo {
@@ -69,6 +73,8 @@ public:
     Ui::Size getImageSize(const std::string& userFile) const;
     /// return shared copy of decoded image
     SDL_Surface* getImage(const std::string& userFile) const;
+    /// return names of all files in the pack, including variant folders, but not user overrides
+    std::vector<std::string> listFiles() const;
 
     static std::vector<Info> ListAvailable();
     static Info Find(const std::string& uid, const std::string& version="", const std::string& sha256="");
@@ -77,6 +83,8 @@ public:
     static const std::vector<fs::path>& getSearchPaths();
 
     static void addOverrideSearchPath(const fs::path& path);
+    /// Persists the pack catalog used by ListAvailable and Find to file and refreshes it in the background.
+    static void setCatalogFile(const fs::path& path);
 
 private:
     class Override {
@@ -93,6 +101,8 @@ private:
     };
 
     void clearImageCaches();
+    /// Zero-copy read of a file stored uncompressed in a zip. Returns false if ReadFile has to be used instead.
+    bool readStoredFile(const std::string& userFile, std::string_view& out) const;
 
     std::unique_ptr<Zip> _zip;
     std::unique_ptr<Override> _override;
@@ -118,4 +128,7 @@ private:
 
     static std::vector<fs::path> _searchPaths;
     static std::vector<fs::path> _overrideSearchPaths;
+    static std::unique_ptr<PackCatalog> _catalog;
+
+    static PackCatalog& getCatalog();
 };
@@ -0,0 +1,318 @@
+#include "packcatalog.h"
+#include <set>
+#include <nlohmann/json.hpp>
+#include "fileutil.h"
+#include "jsonutil.h"
+#include "sha256.h"
+
+
+using nlohmann::json;
+
+
+static constexpr int FORMAT_VERSION = 2; // 2: sub-second mtime
+
+
+/// Returns true and sets mtime to the modification time of path with the best available resolution.
+static bool getMTime(const fs::path& path, int64_t& mtime)
+{
+    fs::error_code ec;
+    const auto t = fs::last_write_time(path, ec);
+    if (ec)
+        return false;
+#ifdef FS_USE_STD_FILESYSTEM
+    mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+#else
+    mtime = (int64_t)t;
+#endif
+    return true;
+}
+
+
+PackCatalog::PackCatalog(fs::path file)
+    : _file(std::move(file)), _queue(decltype(_queue)::getHardwareConcurrency())
+{
+    if (!_file.empty())
+        load();
+}
+
+PackCatalog::~PackCatalog()
+{
+    _stopping = true;
+    wait();
+    save();
+}
+
+size_t PackCatalog::size() const
+{
+    std::lock_guard lock(_mutex);
+    return _entries.size();
+}
+
+PackCatalog::Stamp PackCatalog::getStamp(const fs::path& path, bool& isZip)
+{
+    // for directories, only manifest.json is relevant for Info
+    fs::error_code ec;
+    isZip = fs::is_regular_file(path, ec);
+    const fs::path file = isZip ? path : (path / "manifest.json");
+    Stamp stamp;
+    if (getMTime(file, stamp.mtime)) {
+        stamp.size = fs::file_size(file, ec);
+        if (ec)
+            stamp.size = 0;
+    } else if (!getMTime(path, stamp.mtime)) {
+        // no manifest, directory mtime is used to detect it being added
+        stamp.mtime = 0;
+    }
+    return stamp;
+}
+
+PackCatalog::Entry PackCatalog::makeEntry(const fs::path& path, Stamp stamp, bool isZip, bool hash)
+{
+    Entry entry;
+    entry.stamp = stamp;
+    entry.isZip = isZip;
+    Pack pack(path);
+    if (!pack.isValid())
+        return entry;
+    entry.info = pack.getInfo();
+    if (hash) {
+        entry.sha256 = pack.getSHA256();
+        entry.hashed = true;
+    }
+    return entry;
+}
+
+std::vector<std::string> PackCatalog::update(const std::vector<fs::path>& searchPaths, bool hash)
+{
+    std::vector<std::string> found;
+    std::map<std::string, std::pair<fs::path, size_t>> tasks; // key -> path, task
+    std::set<std::string> searched;
+
+    for (const auto& searchPath: searchPaths) {
+        if (_stopping)
+            break;
+        fs::error_code ec;
+        if (!fs::is_directory(searchPath, ec))
+            continue;
+        fs::directory_iterator dirIt(searchPath, ec);
+        for (; !ec && dirIt != fs::directory_iterator(); dirIt.increment(ec)) {
+            if (_stopping)
+                break;
+            const fs::path& path = dirIt->path();
+            const std::string key = path.u8string();
+            bool isZip;
+            const Stamp stamp = getStamp(path, isZip);
+            found.push_back(key);
+            {
+                std::lock_guard lock(_mutex);
+                const auto it = _entries.find(key);
+                if (it != _entries.end() && it->second.stamp == stamp && it->second.isZip == isZip
+                        && (!hash || it->second.hashed || !isZip || it->second.info.uid.empty()))
+                    continue;
+            }
+            if (tasks.find(key) != tasks.end())
+                continue;
+            const bool hashThis = hash && isZip;
+            tasks.emplace(key, std::make_pair(path, _queue.enqueue([this, path, stamp, isZip, hashThis]() {
+                if (_stopping)
+                    return Entry{}; // discarded below
+                return makeEntry(path, stamp, isZip, hashThis);
+            })));
+        }
+        if (ec) {
+            // entries of a partially listed directory are kept
+            fprintf(stderr, "PackCatalog: could not list %s: %s\n",
+                    sanitize_print(searchPath).c_str(), ec.message().c_str());
+        } else if (!_stopping) {
+            searched.insert(searchPath.u8string());
+        }
+    }
+
+    std::map<std::string, Entry> updated;
+    for (auto& [key, task]: tasks)
+        updated.emplace(key, _queue.get(task.second));
+    if (_stopping)
+        return found;
+
+    std::lock_guard lock(_mutex);
+    for (auto& [key, entry]: updated) {
+        _entries[key] = std::move(entry);
+        _dirty = true;
+    }
+    // drop packs that vanished from directories that were scanned
+    const std::set<std::string> foundSet(found.begin(), found.end());
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        const std::string parent = pathFromUTF8(it->first).parent_path().u8string();
+        if (searched.find(parent) != searched.end() && foundSet.find(it->first) == foundSet.end()) {
+            it = _entries.erase(it);
+            _dirty = true;
+        } else {
+            ++it;
+        }
+    }
+    return found;
+}
+
+std::vector<Pack::Info> PackCatalog::list(const std::vector<fs::path>& searchPaths)
+{
+    const auto found = update(searchPaths, false);
+    std::vector<Pack::Info> res;
+    std::lock_guard lock(_mutex);
+    for (const auto& key: found) {
+        const auto it = _entries.find(key);
+        if (it != _entries.end() && !it->second.info.uid.empty())
+            res.push_back(it->second.info);
+    }
+    return res;
+}
+
+std::string PackCatalog::getSHA256(const fs::path& path)
+{
+    const std::string key = path.u8string();
+    bool isZip;
+    const Stamp stamp = getStamp(path, isZip);
+    if (!isZip)
+        return "";
+    {
+        std::lock_guard lock(_mutex);
+        const auto it = _entries.find(key);
+        if (it != _entries.end() && it->second.stamp == stamp && it->second.isZip && it->second.hashed)
+            return it->second.sha256;
+    }
+    std::string sha256 = SHA256_File(path);
+    std::lock_guard lock(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end() || it->second.stamp != stamp || !it->second.isZip) {
+        // not listed yet or outdated; this should not happen from Pack::Find
+        Entry entry = makeEntry(path, stamp, isZip, false);
+        it = _entries.insert_or_assign(key, std::move(entry)).first;
+    }
+    it->second.sha256 = sha256;
+    it->second.hashed = true;
+    _dirty = true;
+    return sha256;
+}
+
+void PackCatalog::updateAsync(const std::vector<fs::path>& searchPaths)
+{
+    wait();
+    _updateThread = std::thread([this, searchPaths]() {
+        try {
+            update(searchPaths, true);
+        } catch (const std::exception& ex) {
+            // e.g. a pack that vanished while being read
+            fprintf(stderr, "PackCatalog: update failed: %s\n", ex.what());
+            return;
+        }
+        if (!_stopping)
+            save();
+    });
+}
+
+void PackCatalog::wait()
+{
+    if (_updateThread.joinable())
+        _updateThread.join();
+}
+
+void PackCatalog::load()
+{
+    std::string s;
+    if (!readFile(_file, s))
+        return; // does not exist yet
+    json j = parse_jsonc(s);
+    if (!j.is_object() || j.value("version", 0) != FORMAT_VERSION) {
+        fprintf(stderr, "PackCatalog: ignoring invalid or outdated %s\n", sanitize_print(_file).c_str());
+        return;
+    }
+    const auto packsIt = j.find("packs");
+    if (packsIt == j.end() || !packsIt->is_object())
+        return;
+
+    std::lock_guard lock(_mutex);
+    for (const auto& [key, v]: packsIt->items()) {
+        if (!v.is_object())
+            continue;
+        try {
+            Entry entry;
+            entry.stamp.size = v.value("size", (uintmax_t)0);
+            entry.stamp.mtime = v.value("mtime", (int64_t)0);
+            entry.isZip = v.value("zip", false);
+            entry.hashed = v.contains("sha256");
+            entry.sha256 = v.value("sha256", "");
+            auto& info = entry.info;
+            info.path = pathFromUTF8(key);
+            info.uid = v.value("uid", "");
+            info.version = v.value("version", "");
+            info.platform = v.value("platform", "");
+            info.gameName = v.value("game_name", "");
+            info.packName = v.value("pack_name", "");
+            info.minPoptrackerVersion = Version(v.value("min_poptracker_version", ""));
+            const auto variantsIt = v.find("variants");
+            if (variantsIt != v.end() && variantsIt->is_array()) {
+                for (const auto& variant: *variantsIt) {
+                    if (variant.is_array() && variant.size() == 2)
+                        info.variants.push_back({variant[0].get<std::string>(), variant[1].get<std::string>()});
+                }
+            }
+            _entries.emplace(key, std::move(entry));
+        } catch (const json::exception& ex) {
+            fprintf(stderr, "PackCatalog: skipping invalid entry: %s\n", ex.what());
+        }
+    }
+}
+
+bool PackCatalog::save()
+{
+    if (_file.empty())
+        return true;
+
+    json packs = json::object();
+    {
+        std::lock_guard lock(_mutex);
+        if (!_dirty)
+            return true;
+        for (const auto& [key, entry]: _entries) {
+            const auto& info = entry.info;
+            json variants = json::array();
+            for (const auto& variant: info.variants)
+                variants.push_back({variant.variant, variant.name});
+            json v = {
+                {"size", entry.stamp.size},
+                {"mtime", entry.stamp.mtime},
+                {"zip", entry.isZip},
+                {"uid", info.uid},
+                {"version", info.version},
+                {"platform", info.platform},
+                {"game_name", info.gameName},
+                {"pack_name", info.packName},
+                {"min_poptracker_version", info.minPoptrackerVersion.to_string()},
+                {"variants", variants},
+            };
+            if (entry.hashed)
+                v["sha256"] = entry.sha256;
+            packs[key] = v;
+        }
+        _dirty = false;
+    }
+
+    json j = {
+        {"version", FORMAT_VERSION},
+        {"packs", packs},
+    };
+    const fs::path tmp = pathFromUTF8(_file.u8string() + ".tmp");
+    if (!writeFile(tmp, j.dump())) {
+        std::lock_guard lock(_mutex);
+        _dirty = true;
+        return false;
+    }
+    fs::error_code ec;
+    fs::rename(tmp, _file, ec);
+    if (ec) {
+        fprintf(stderr, "PackCatalog: could not write %s: %s\n", sanitize_print(_file).c_str(), ec.message().c_str());
+        std::lock_guard lock(_mutex);
+        _dirty = true;
+        return false;
+    }
+    return true;
+}
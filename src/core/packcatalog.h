@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fs.h"
+#include "pack.h"
+#include "taskqueue.hpp"
+
+
+/// Cache of Pack::Info and SHA-256 of installed packs, keyed by path and validated by size and modification time,
+/// so listing and finding packs does not have to open every pack. Can be persisted to disk. Thread safe.
+class PackCatalog final {
+public:
+    /// Loads the catalog from file. An empty path keeps it in memory only.
+    explicit PackCatalog(fs::path file = {});
+    PackCatalog(const PackCatalog&) = delete;
+    ~PackCatalog();
+
+    /// Returns info of all valid packs in searchPaths, in directory order. Only opens packs that changed.
+    std::vector<Pack::Info> list(const std::vector<fs::path>& searchPaths);
+    /// Returns SHA-256 of a pack zip, or an empty string for directories and on error. Only hashes if it changed.
+    std::string getSHA256(const fs::path& path);
+    /// Validates all packs and hashes all zips in the background, then saves.
+    void updateAsync(const std::vector<fs::path>& searchPaths);
+    /// Blocks until a running background update finished.
+    void wait();
+    /// Writes the catalog to file if anything changed.
+    bool save();
+
+    size_t size() const;
+
+private:
+    struct Stamp final {
+        uintmax_t size = 0;
+        int64_t mtime = 0; ///< in ns, or s with boost::filesystem
+
+        bool operator==(const Stamp& other) const { return size == other.size && mtime == other.mtime; }
+        bool operator!=(const Stamp& other) const { return !(*this == other); }
+    };
+
+    struct Entry final {
+        Stamp stamp;
+        Pack::Info info; // empty uid if not a valid pack
+        bool isZip = false;
+        bool hashed = false;
+        std::string sha256;
+    };
+
+    static Stamp getStamp(const fs::path& path, bool& isZip);
+    static Entry makeEntry(const fs::path& path, Stamp stamp, bool isZip, bool hash);
+
+    /// Brings entries for searchPaths up to date. Returns the paths found, in directory order.
+    std::vector<std::string> update(const std::vector<fs::path>& searchPaths, bool hash);
+    void load();
+
+    const fs::path _file;
+    mutable std::mutex _mutex;
+    std::map<std::string, Entry> _entries; // by u8 path
+    bool _dirty = false;
+    pop::TaskQueue<Entry> _queue;
+    std::thread _updateThread;
+    std::atomic<bool> _stopping = false;
+};
@@ -0,0 +1,105 @@
+#include "packpreloader.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include "jsonutil.h"
+
+
+using nlohmann::json;
+
+
+static bool endsWith(const std::string& s, const char* suffix)
+{
+    const size_t len = strlen(suffix);
+    if (s.length() < len)
+        return false;
+    return std::equal(s.end() - len, s.end(), suffix, [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+PackPreloader::PackPreloader(const Pack* pack)
+    : _pack(pack), _queue(decltype(_queue)::getHardwareConcurrency())
+{
+    _start = std::chrono::steady_clock::now();
+    const std::string variantPrefix = pack->getVariant().empty() ? "" : (pack->getVariant() + "/");
+    std::vector<std::string> otherVariantPrefixes;
+    for (const auto& info: pack->getInfo().variants) {
+        if (!info.variant.empty() && info.variant != pack->getVariant())
+            otherVariantPrefixes.push_back(info.variant + "/");
+    }
+    std::vector<std::string> images;
+    std::lock_guard lock(_mutex);
+    for (auto& name: pack->listFiles()) {
+        // only root files and the active variant's folder can be loaded
+        if (std::any_of(otherVariantPrefixes.begin(), otherVariantPrefixes.end(), [&name](const std::string& prefix) {
+            return name.compare(0, prefix.length(), prefix) == 0;
+        }))
+            continue;
+        // Pack::ReadFile resolves the variant, so strip it to get the name used by the pack
+        if (!variantPrefix.empty() && name.compare(0, variantPrefix.length(), variantPrefix) == 0)
+            name = name.substr(variantPrefix.length());
+        if (endsWith(name, ".json") || endsWith(name, ".jsonc")) {
+            if (_jsonTasks.find(name) != _jsonTasks.end())
+                continue;
+            _jsonTasks.emplace(name, _queue.enqueue([pack, name]() {
+                std::string s;
+                if (!pack->ReadFile(name, s))
+                    return json(json::value_t::discarded);
+                return parse_jsonc(s);
+            }));
+        } else if (endsWith(name, ".png") || endsWith(name, ".jpg") || endsWith(name, ".jpeg")
+                || endsWith(name, ".bmp")) {
+            images.push_back(std::move(name));
+        }
+    }
+    // queue images last, json is required first
+    std::sort(images.begin(), images.end());
+    images.erase(std::unique(images.begin(), images.end()), images.end());
+    for (auto& name: images) {
+        _imageTasks.push_back(_queue.enqueue([pack, name]() {
+            pack->getImageSize(name);
+            return json();
+        }));
+    }
+    printf("Preloading %zu json files and %zu image sizes...\n", _jsonTasks.size(), _imageTasks.size());
+}
+
+PackPreloader::~PackPreloader()
+{
+    std::lock_guard lock(_mutex);
+    for (const auto& [_, task]: _jsonTasks) {
+        if (!_queue.cancel(task))
+            _queue.get(task);
+    }
+    for (const auto task: _imageTasks) {
+        if (!_queue.cancel(task))
+            _queue.get(task);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - _start);
+    printf("Preloader: used %zu of %zu json files, finished after %.1fms\n",
+            _taken, _taken + _jsonTasks.size(), elapsed.count() / 1000.0);
+}
+
+bool PackPreloader::take(const std::string& file, json& out)
+{
+    size_t task;
+    {
+        std::lock_guard lock(_mutex);
+        std::string name = file;
+        while (name.length() >= 2 && name[0] == '.' && (name[1] == '/' || name[1] == '\\'))
+            name = name.substr(2);
+        const auto it = _jsonTasks.find(name);
+        if (it == _jsonTasks.end())
+            return false;
+        task = it->second;
+        _jsonTasks.erase(it);
+        _taken++;
+    }
+    _queue.prioritize(task);
+    out = _queue.get(task);
+    if (out.is_discarded())
+        return false; // could not read; let the caller report it
+    return true;
+}
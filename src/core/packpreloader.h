@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "pack.h"
+#include "taskqueue.hpp"
+
+
+/// Reads and parses the JSON files of a pack and its active variant and pre-warms image sizes on worker threads
+/// while Lua runs on the main thread, so Tracker::Add* only has to apply the result. The pack and its variant have
+/// to stay unchanged for the lifetime of the preloader.
+class PackPreloader final {
+public:
+    explicit PackPreloader(const Pack* pack);
+    PackPreloader(const PackPreloader&) = delete;
+    ~PackPreloader();
+
+    /// Moves the parsed json of file into out, waiting for it if required. Returns false if file was not preloaded
+    /// or was already taken, in which case the caller has to read it itself.
+    bool take(const std::string& file, nlohmann::json& out);
+
+private:
+    const Pack* _pack;
+    pop::TaskQueue<nlohmann::json> _queue;
+    std::mutex _mutex;
+    std::map<std::string, size_t> _jsonTasks; // file -> task
+    std::vector<size_t> _imageTasks;
+    std::chrono::steady_clock::time_point _start;
+    size_t _taken = 0;
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <memory>
+#include <stdint.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+#include "rangeset.h"
+
+
+/// Sparse mirror of a 32bit address space, stored in 4KiB pages that remember which bytes were written.
+/// Reads and writes are memcpy per page instead of one lookup per byte. Not thread safe.
+class PagedMemory final {
+public:
+    static constexpr unsigned PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+
+    /// Copies length bytes to out, filling unknown bytes with 0. Returns false if any byte was unknown.
+    bool read(uint32_t address, size_t length, void* out) const
+    {
+        uint8_t* dst = (uint8_t*)out;
+        bool isCached = true;
+
+        while (length) {
+            const uint32_t offset = address & (PAGE_SIZE - 1);
+            const size_t n = std::min<size_t>(length, PAGE_SIZE - offset);
+            const auto it = _pages.find(address >> PAGE_BITS);
+            if (it == _pages.end()) {
+                memset(dst, 0, n);
+                isCached = false;
+            } else if (it->second->isValid(offset, n)) {
+                memcpy(dst, it->second->data + offset, n);
+            } else {
+                const Page& page = *it->second;
+                for (size_t i = 0; i < n; i++)
+                    dst[i] = page.isValid(offset + i, 1) ? page.data[offset + i] : 0;
+                isCached = false;
+            }
+            dst += n;
+            address += (uint32_t)n;
+            length -= n;
+        }
+
+        return isCached;
+    }
+
+    /// Reads a little endian integer. Returns false if any byte was unknown.
+    template<typename R>
+    bool readInt(uint32_t address, R& out) const
+    {
+        uint8_t buf[sizeof(R)];
+        bool isCached = read(address, sizeof(R), buf);
+        out = 0;
+        for (size_t n = 0; n < sizeof(R); n++) {
+            out <<= 8;
+            out += buf[sizeof(R) - n - 1];
+        }
+        return isCached;
+    }
+
+    /// Stores length bytes from in. Returns true if any byte changed or was unknown before.
+    /// If changes is not null, the changed ranges are appended to it, trimmed to the first and last changed byte per
+    /// page.
+    bool write(uint32_t address, size_t length, const void* in, std::vector<RangeSet::Range>* changes = nullptr)
+    {
+        const uint8_t* src = (const uint8_t*)in;
+        bool changed = false;
+
+        while (length) {
+            const uint32_t offset = address & (PAGE_SIZE - 1);
+            const size_t n = std::min<size_t>(length, PAGE_SIZE - offset);
+            auto& page = _pages[address >> PAGE_BITS];
+            if (!page)
+                page.reset(new Page());
+            if (!page->isValid(offset, n)) {
+                page->setValid(offset, n);
+                changed = true;
+                if (changes)
+                    addChange(*changes, address, (uint32_t)n);
+            } else if (changes) {
+                const uint8_t* old = page->data + offset;
+                size_t first = 0;
+                while (first < n && old[first] == src[first])
+                    first++;
+                if (first < n) {
+                    size_t last = n - 1;
+                    while (old[last] == src[last])
+                        last--;
+                    changed = true;
+                    addChange(*changes, address + (uint32_t)first, (uint32_t)(last - first + 1));
+                }
+            } else if (!changed && memcmp(page->data + offset, src, n) != 0) {
+                changed = true;
+            }
+            memcpy(page->data + offset, src, n);
+            src += n;
+            address += (uint32_t)n;
+            length -= n;
+        }
+
+        return changed;
+    }
+
+    void clear()
+    {
+        _pages.clear();
+    }
+
+    bool empty() const
+    {
+        return _pages.empty();
+    }
+
+private:
+    struct Page final {
+        uint8_t data[PAGE_SIZE] = {};
+        uint64_t valid[PAGE_SIZE / 64] = {};
+        uint32_t validCount = 0;
+
+        bool isValid(uint32_t offset, size_t length) const
+        {
+            if (validCount == PAGE_SIZE)
+                return true;
+            bool res = true;
+            forEachWord(offset, length, [&](size_t word, uint64_t mask) {
+                res = res && (valid[word] & mask) == mask;
+            });
+            return res;
+        }
+
+        void setValid(uint32_t offset, size_t length)
+        {
+            forEachWord(offset, length, [&](size_t word, uint64_t mask) {
+                validCount += (uint32_t)std::bitset<64>(mask & ~valid[word]).count();
+                valid[word] |= mask;
+            });
+        }
+
+        template<typename F>
+        static void forEachWord(uint32_t offset, size_t length, F f)
+        {
+            while (length) {
+                const size_t bit = offset % 64;
+                const size_t n = std::min<size_t>(length, 64 - bit);
+                const uint64_t mask = (n == 64) ? ~(uint64_t)0 : (((uint64_t)1 << n) - 1) << bit;
+                f(offset / 64, mask);
+                offset += (uint32_t)n;
+                length -= n;
+            }
+        }
+    };
+
+    std::unordered_map<uint32_t, std::unique_ptr<Page>> _pages;
+
+    static void addChange(std::vector<RangeSet::Range>& changes, uint32_t start, uint32_t length)
+    {
+        if (!changes.empty() && changes.back().end() == start)
+            changes.back().length += length;
+        else
+            changes.push_back({start, length});
+    }
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+
+/// Set of address ranges with a reference count per byte.
+/// Adding the same or overlapping ranges multiple times requires removing them as often.
+class RangeSet final {
+public:
+    struct Range final {
+        uint32_t start;
+        uint32_t length;
+
+        uint32_t end() const { return start + length; }
+        bool operator==(const Range& other) const { return start == other.start && length == other.length; }
+    };
+
+    /// Increments the count of [start, start+length). Returns true if a byte got added to the set.
+    bool add(uint32_t start, uint32_t length)
+    {
+        if (!length)
+            return false;
+        bool added = false;
+        auto it = split(start);
+        auto last = split(start + length);
+        for (; it != last; ++it) {
+            if (it->second++ == 0)
+                added = true;
+        }
+        normalize(start, start + length);
+        return added;
+    }
+
+    /// Decrements the count of [start, start+length). Returns true if a byte got removed from the set.
+    bool remove(uint32_t start, uint32_t length)
+    {
+        if (!length)
+            return false;
+        bool removed = false;
+        auto it = split(start);
+        auto last = split(start + length);
+        for (; it != last; ++it) {
+            if (it->second > 0 && --it->second == 0)
+                removed = true;
+        }
+        normalize(start, start + length);
+        return removed;
+    }
+
+    /// Returns true if every byte of [start, start+length) is in the set.
+    bool contains(uint32_t start, uint32_t length) const
+    {
+        auto it = _counts.upper_bound(start);
+        if (it == _counts.begin())
+            return length == 0;
+        --it;
+        const uint32_t end = start + length;
+        while (it != _counts.end() && it->first < end) {
+            if (it->second == 0)
+                return false;
+            ++it;
+        }
+        return true;
+    }
+
+    /// Returns the disjoint ranges in the set, sorted by address.
+    std::vector<Range> ranges() const
+    {
+        std::vector<Range> res;
+        for (auto it = _counts.begin(); it != _counts.end(); ++it) {
+            if (it->second == 0)
+                continue;
+            const auto next = std::next(it); // exists, since the set always ends with a 0-count boundary
+            if (!res.empty() && res.back().end() == it->first)
+                res.back().length += next->first - it->first;
+            else
+                res.push_back({it->first, next->first - it->first});
+        }
+        return res;
+    }
+
+    /// Returns ranges merged across gaps of up to maxGap unused bytes, split so no range exceeds maxLength.
+    std::vector<Range> coalesce(uint32_t maxGap, uint32_t maxLength) const
+    {
+        std::vector<Range> res;
+        if (!maxLength)
+            return res;
+        for (auto range: ranges()) {
+            if (!res.empty()) {
+                auto& prev = res.back();
+                const uint32_t gap = range.start - prev.end();
+                if (gap <= maxGap && prev.length + gap + range.length <= maxLength) {
+                    prev.length += gap + range.length;
+                    continue;
+                }
+            }
+            while (range.length > maxLength) {
+                res.push_back({range.start, maxLength});
+                range.start += maxLength;
+                range.length -= maxLength;
+            }
+            res.push_back(range);
+        }
+        return res;
+    }
+
+    bool empty() const
+    {
+        return _counts.empty();
+    }
+
+    void clear()
+    {
+        _counts.clear();
+    }
+
+private:
+    /// boundary -> count of every byte from boundary up to the next one. The last boundary has count 0.
+    std::map<uint32_t, unsigned> _counts;
+
+    std::map<uint32_t, unsigned>::iterator split(uint32_t addr)
+    {
+        auto it = _counts.lower_bound(addr);
+        if (it != _counts.end() && it->first == addr)
+            return it;
+        const unsigned count = (it == _counts.begin()) ? 0 : std::prev(it)->second;
+        return _counts.emplace_hint(it, addr, count);
+    }
+
+    /// Removes redundant boundaries around [start, end].
+    void normalize(uint32_t start, uint32_t end)
+    {
+        auto it = _counts.find(start);
+        if (it != _counts.begin())
+            --it;
+        while (it != _counts.end() && it->first <= end) {
+            const auto next = std::next(it);
+            const unsigned prevCount = (it == _counts.begin()) ? 0 : std::prev(it)->second;
+            if (it->second == prevCount)
+                _counts.erase(it);
+            it = next;
+        }
+    }
+};
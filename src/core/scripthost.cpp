@@ -1,6 +1,7 @@
 #include "scripthost.h"
 #include <luaglue/luamethod.h>
 #include <luaglue/lua_json.h>
+#include <algorithm>
 #include <stdio.h>
 #include "gameinfo.h"
 #include "util.h"
@@ -65,31 +66,33 @@ ScriptHost::ScriptHost(Pack* pack, lua_State *L, Tracker *tracker)
                 lua_pop(_L, 1); // error object
             }
             // re-add watches to new backend object
+            _memoryWatchIndexValid = false;
             for (const auto& w: _memoryWatches) {
-                _autoTracker->addWatch((unsigned)w.addr, (unsigned)w.len);
+                _autoTracker->addWatch((unsigned)w.addr, (unsigned)w.len, (unsigned)w.interval);
             }
         }
     }};
-    _autoTracker->onDataChange += {this, [this](void*) {
+    _autoTracker->onDataChange += {this, [this](void*, const std::vector<RangeSet::Range>* ranges) {
         DEBUG_printf("AutoTracker: Data changed!\n");
-        for (size_t i=0; i<_memoryWatches.size(); i++) {
-            // NOTE: since watches can change in a callback, we use vector
-            auto& w = _memoryWatches[i];
-            auto newData = _autoTracker->read((unsigned)w.addr, (unsigned)w.len);
-            if (w.data != newData) {
-                DEBUG_printf("  %s changed\n", w.name.c_str());
-#ifdef DEBUG_TRACKER
-                for (size_t i=0; i<(std::min(w.data.size(), newData.size())); i++) {
-                    if (w.data[i] != newData[i])
-                        DEBUG_printf("%02x: %02x -> %02x\n", (unsigned)i,
-                                ((unsigned)w.data[i])&0xff, ((unsigned)newData[i])&0xff);
-                }
-#endif
-                w.data = newData;
-                w.dirty = true;
-            }
-            // NOTE: we run the user callbacks in runMemoryWatchCallbacks
+        if (!ranges || !_memoryWatchIndexValid) {
+            // unknown changes or watches changed since the last update
+            for (auto& w: _memoryWatches)
+                updateMemoryWatch(w);
+            buildMemoryWatchIndex();
+            return;
+        }
+        // only compare watches that overlap changed ranges
+        _changedMemoryWatches = _unindexedMemoryWatches;
+        for (const auto& range: *ranges) {
+            _memoryWatchIndex.query(range.start, range.length, [this](size_t i) {
+                _changedMemoryWatches.push_back(i);
+            });
         }
+        std::sort(_changedMemoryWatches.begin(), _changedMemoryWatches.end());
+        auto last = std::unique(_changedMemoryWatches.begin(), _changedMemoryWatches.end());
+        for (auto it = _changedMemoryWatches.begin(); it != last; ++it)
+            updateMemoryWatch(_memoryWatches[*it]);
+        // NOTE: we run the user callbacks in runMemoryWatchCallbacks
     }};
     _autoTracker->onVariablesChanged += {this, [this](void*, const std::list<std::string>& vars) {
         std::list<std::string> watchVars;
@@ -252,9 +255,10 @@ std::string ScriptHost::AddMemoryWatch(const std::string& name, unsigned int add
     w.name = name;
     w.dirty = false;
     
-    if (_autoTracker->addWatch((unsigned)w.addr, (unsigned)w.len)) {
-        printf("Added watch %s for <0x%06x,0x%02x>\n",
-                w.name.c_str(), (unsigned)w.addr, (unsigned)w.len);
+    if (_autoTracker->addWatch((unsigned)w.addr, (unsigned)w.len, (unsigned)w.interval)) {
+        printf("Added watch %s for <0x%06x,0x%02x> every %dms\n",
+                w.name.c_str(), (unsigned)w.addr, (unsigned)w.len, w.interval);
+        // backends poll each watch at its own interval; the fastest one is the default for reads without watch
         bool updateInterval = true;
         for (auto& other : _memoryWatches) {
             if (other.interval <= w.interval) {
@@ -264,6 +268,7 @@ std::string ScriptHost::AddMemoryWatch(const std::string& name, unsigned int add
         }
         if (updateInterval) _autoTracker->setInterval(w.interval);
         _memoryWatches.push_back(w);
+        _memoryWatchIndexValid = false;
         return name;
     } else {
         luaL_unref(_L, LUA_REGISTRYINDEX, w.callback);
@@ -276,45 +281,17 @@ bool ScriptHost::RemoveMemoryWatch(const std::string& name)
     // TODO: use a map instead?
     for (auto it=_memoryWatches.begin(); it!=_memoryWatches.end(); it++) {
         if (it->name == name) {
-            bool split = false;
             auto name = it->name;
             auto addr = it->addr;
             auto len = it->len;
+            auto interval = it->interval;
             luaL_unref(_L, LUA_REGISTRYINDEX, it->callback);
             _memoryWatches.erase(it);
-            // NOTE: AutoTracker::RemoveWatch takes a simple byte range at the moment
-            for (const auto& other: _memoryWatches) {
-                if (other.addr<=addr && other.addr+other.len>=addr+len) {
-                    // entire range still being watched
-                    split = false;
-                    len = 0;
-                    break;
-                } else if (other.addr<=addr && other.addr+other.len>addr) {
-                    // start still being watched
-                    size_t n = other.addr + other.len - addr;
-                    addr += n;
-                    len -= n;
-                    if (!len) break;
-                } else if (other.addr<addr+len && other.addr+other.len>=addr+len) {
-                    // end still being watched
-                    len = other.addr-addr;
-                    if (!len) break;
-                } else if (other.addr>addr && other.addr+other.len<addr+len) {
-                    // some range in the middle still being watched, not implemented
-                    split = true;
-                    len = 0;
-                }
-            }
-            if (split) {
-                fprintf(stderr, "WARNING: RemoveWatch: splitting existing byte ranges not implemented\n");
-            }
-            if (len) {
-                _autoTracker->removeWatch(addr,len);
-                printf("Removed watch %s, range <0x%06x,0x%02x>\n",
-                        name.c_str(), (unsigned)addr, (unsigned)len);
-            } else {
-                printf("Removed watch %s\n", name.c_str());
-            }
+            _memoryWatchIndexValid = false;
+            // NOTE: backends count references, so overlapping watches stay active
+            _autoTracker->removeWatch(addr,len,interval);
+            printf("Removed watch %s, range <0x%06x,0x%02x>\n",
+                    name.c_str(), (unsigned)addr, (unsigned)len);
             return true;
         }
     }
@@ -561,8 +538,42 @@ void ScriptHost::resetWatches()
     }
     _autoTracker->clearCache();
     if (changed && _autoTracker) {
-        _autoTracker->onDataChange.emit(_autoTracker);
+        _autoTracker->onDataChange.emit(_autoTracker, nullptr);
+    }
+}
+
+void ScriptHost::updateMemoryWatch(MemoryWatch& w)
+{
+    _memoryWatchBuffer.resize((size_t)w.len);
+    if (!_autoTracker->read((unsigned)w.addr, (unsigned)w.len, _memoryWatchBuffer.data()))
+        _memoryWatchBuffer.clear();
+    if (w.data == _memoryWatchBuffer)
+        return;
+    DEBUG_printf("  %s changed\n", w.name.c_str());
+#ifdef DEBUG_TRACKER
+    for (size_t i=0; i<(std::min(w.data.size(), _memoryWatchBuffer.size())); i++) {
+        if (w.data[i] != _memoryWatchBuffer[i])
+            DEBUG_printf("%02x: %02x -> %02x\n", (unsigned)i,
+                    ((unsigned)w.data[i])&0xff, ((unsigned)_memoryWatchBuffer[i])&0xff);
+    }
+#endif
+    w.data = _memoryWatchBuffer;
+    w.dirty = true;
+}
+
+void ScriptHost::buildMemoryWatchIndex()
+{
+    _memoryWatchIndex.clear();
+    _unindexedMemoryWatches.clear();
+    for (size_t i=0; i<_memoryWatches.size(); i++) {
+        const auto& w = _memoryWatches[i];
+        RangeSet::Range range;
+        if (_autoTracker->mapRange((unsigned)w.addr, (unsigned)w.len, range))
+            _memoryWatchIndex.add(range.start, range.length, i);
+        else
+            _unindexedMemoryWatches.push_back(i);
     }
+    _memoryWatchIndexValid = true;
 }
 
 void ScriptHost::runMemoryWatchCallbacks()
@@ -5,6 +5,7 @@
 #include <luaglue/lua_json.h>
 #include <luaglue/luapp.h>
 #include "autotracker.h"
+#include "intervalindex.h"
 #include "pack.h"
 #include "tracker.h"
 #include "luaitem.h"
@@ -87,6 +88,9 @@ public:
     // This is called every frame. Returns true if state was changed by auto-tracking.
     bool onFrame();
 
+    // Returns true if onFrame has to be called every frame, i.e. there are frame handlers or async tasks.
+    bool needsFrames() const { return !_onFrameHandlers.empty() || !_asyncTasks.empty(); }
+
     void runMemoryWatchCallbacks();
 
     AutoTracker* getAutoTracker() { return _autoTracker; }
@@ -130,6 +134,11 @@ protected:
     Pack *_pack;
     Tracker *_tracker;
     std::vector<MemoryWatch> _memoryWatches;
+    IntervalIndex<size_t> _memoryWatchIndex; ///< backend address range -> index into _memoryWatches
+    std::vector<size_t> _unindexedMemoryWatches; ///< watches that are checked on every data change
+    bool _memoryWatchIndexValid = false;
+    std::vector<size_t> _changedMemoryWatches; ///< reused by onDataChange
+    std::vector<uint8_t> _memoryWatchBuffer; ///< reused by updateMemoryWatch
     std::vector<std::pair<std::string, CodeWatch> > _codeWatches;
     std::vector<std::pair<std::string, VarWatch> > _varWatches;
     std::vector<OnFrameHandler> _onFrameHandlers;
@@ -140,6 +149,9 @@ protected:
 private:
     // This will be called every frame to run auto-tracking
     bool autoTrack();
+    // Compare watched memory with the last known data and flag the watch dirty if it changed.
+    void updateMemoryWatch(MemoryWatch& w);
+    void buildMemoryWatchIndex();
     json runAsync(const std::string& name, const std::string& script, const json& arg, LuaRef completeCallback, LuaRef progressCallback);
     // Run a Lua function defined in ref, return its result as boolean.
     // ArgsHook can push arguments to the stack and return the number of pushed arguments.
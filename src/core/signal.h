@@ -61,6 +61,11 @@ public:
         *_modified = true;
     }
 
+    bool empty() const
+    {
+        return _slots.empty();
+    }
+
     Signal()
     {
         _modified = std::make_shared<bool>(false);
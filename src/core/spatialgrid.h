@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+
+/// Uniform grid of values stored at integer points, for finding all points inside a rectangle
+/// without visiting every point. Not thread safe.
+template<typename T>
+class SpatialGrid final {
+public:
+    explicit SpatialGrid(int cellSize = 64)
+        : _cellSize(std::max(1, cellSize))
+    {
+    }
+
+    void insert(int x, int y, const T& value)
+    {
+        _cells[key(cell(x), cell(y))].push_back({x, y, value});
+        _left = std::min(_left, x);
+        _top = std::min(_top, y);
+        _right = std::max(_right, x);
+        _bottom = std::max(_bottom, y);
+        _size++;
+    }
+
+    void clear()
+    {
+        _cells.clear();
+        _left = _top = INT_MAX;
+        _right = _bottom = INT_MIN;
+        _size = 0;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /// Calls f(x, y, value) for every point inside [left, right] x [top, bottom], in no particular order.
+    template<typename F>
+    void query(int left, int top, int right, int bottom, F f) const
+    {
+        // only visit cells that can have points
+        left = std::max(left, _left);
+        top = std::max(top, _top);
+        right = std::min(right, _right);
+        bottom = std::min(bottom, _bottom);
+        if (left > right || top > bottom)
+            return;
+        for (int cy = cell(top); cy <= cell(bottom); cy++) {
+            for (int cx = cell(left); cx <= cell(right); cx++) {
+                const auto it = _cells.find(key(cx, cy));
+                if (it == _cells.end())
+                    continue;
+                for (const auto& entry: it->second) {
+                    if (entry.x >= left && entry.x <= right && entry.y >= top && entry.y <= bottom)
+                        f(entry.x, entry.y, entry.value);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry final {
+        int x;
+        int y;
+        T value;
+    };
+
+    int _cellSize;
+    std::unordered_map<uint64_t, std::vector<Entry>> _cells;
+    int _left = INT_MAX;
+    int _top = INT_MAX;
+    int _right = INT_MIN;
+    int _bottom = INT_MIN;
+    size_t _size = 0;
+
+    int cell(int v) const
+    {
+        // round towards negative infinity, so cells don't overlap at 0
+        return (v >= 0) ? v / _cellSize : (int)-((-(int64_t)v + _cellSize - 1) / _cellSize);
+    }
+
+    static uint64_t key(int cx, int cy)
+    {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+    }
+};
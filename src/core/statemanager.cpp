@@ -7,12 +7,23 @@ using nlohmann::json;
 
 std::map<StateManager::StateID, json> StateManager::_states;
 fs::path StateManager::_dir;
+bool StateManager::_binary = false;
 
 void StateManager::setDir(const fs::path& dir)
 {
     _dir = dir;
 }
 
+void StateManager::setBinary(bool binary)
+{
+    _binary = binary;
+}
+
+bool StateManager::isBinary()
+{
+    return _binary;
+}
+
 static void replayHints(Tracker* tracker, json& state)
 {    
     // replay stored ui hints
@@ -26,14 +37,13 @@ static void replayHints(Tracker* tracker, json& state)
     }
 }
 
-bool StateManager::saveState(Tracker* tracker, ScriptHost*,
-        std::list< std::pair<std::string,std::string> > uiHints, const json& extra,
-        bool tofile, const std::string& name, bool external)
+json StateManager::makeState(Tracker* tracker,
+        const std::list< std::pair<std::string,std::string> >& uiHints, const json& extra)
 {
-    if (!tracker) return false;
+    if (!tracker) return nullptr;
     auto pack = tracker->getPack();
-    if (!pack) return false;
-    
+    if (!pack) return nullptr;
+
     auto state = tracker->saveState();
     
     auto jUiHints = json::array();
@@ -48,6 +58,78 @@ bool StateManager::saveState(Tracker* tracker, ScriptHost*,
         { "version", pack->getVersion() },
     };
     state["extra"] = extra;
+    return state;
+}
+
+fs::path StateManager::getStateFile(const Pack* pack, const std::string& name)
+{
+    return _dir /
+            sanitize_dir(pack->getUID()) /
+            sanitize_dir(pack->getVersion()) /
+            sanitize_dir(pack->getVariant()) / (name + (_binary ? ".cbor" : ".json"));
+}
+
+fs::path StateManager::findStateFile(const Pack* pack, const std::string& name)
+{
+    // the format may have been switched since the last save, so use whichever file is newer
+    fs::path preferred = getStateFile(pack, name);
+    fs::path other = preferred;
+    other.replace_extension(_binary ? ".json" : ".cbor");
+    std::chrono::system_clock::time_point preferredTime, otherTime;
+    if (!getFileMTime(other, otherTime))
+        return preferred;
+    if (!getFileMTime(preferred, preferredTime) || otherTime > preferredTime)
+        return other;
+    return preferred;
+}
+
+std::string StateManager::encodeState(const json& state, bool binary)
+{
+    if (!binary)
+        return state.dump();
+    const auto cbor = json::to_cbor(state);
+    return std::string(cbor.begin(), cbor.end());
+}
+
+json StateManager::decodeState(std::string& data)
+{
+    // a state is an object, so CBOR starts with a map header while JSON starts with text
+    const auto start = data.find_first_not_of(" \t\r\n");
+    if (start != data.npos && (uint8_t)data[start] >= 0xa0 && (uint8_t)data[start] <= 0xbf) {
+        json j = json::from_cbor(data, true, false);
+        if (j.is_discarded()) {
+            fprintf(stderr, "Could not parse CBOR state\n");
+            return nullptr;
+        }
+        return j;
+    }
+    return parse_jsonc(data);
+}
+
+bool StateManager::writeStateFile(const fs::path& filename, const std::string& data)
+{
+    const fs::path tmp = pathFromUTF8(filename.u8string() + ".tmp");
+    if (!writeFile(tmp, data))
+        return false;
+    fs::error_code ec;
+    fs::rename(tmp, filename, ec);
+    if (ec) {
+        fprintf(stderr, "error saving %s: %s\n", sanitize_print(filename).c_str(), ec.message().c_str());
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool StateManager::saveState(Tracker* tracker, ScriptHost*,
+        std::list< std::pair<std::string,std::string> > uiHints, const json& extra,
+        bool tofile, const std::string& name, bool external)
+{
+    if (!tracker) return false;
+    auto pack = tracker->getPack();
+    if (!pack) return false;
+    
+    auto state = makeState(tracker, uiHints, extra);
 
     if (!tofile) {
         printf("Saving state \"%s\" to RAM...\n", name.c_str());
@@ -59,20 +141,16 @@ bool StateManager::saveState(Tracker* tracker, ScriptHost*,
         if (external) {
             filename = name;
         } else {
-            auto dirname = _dir /
-                    sanitize_dir(pack->getUID()) /
-                    sanitize_dir(pack->getVersion()) /
-                    sanitize_dir(pack->getVariant());
-            fs::create_directories(dirname);
-            filename = dirname / (name + ".json");
+            filename = getStateFile(pack, name);
+            fs::create_directories(filename.parent_path());
         }
         printf("Saving state \"%s\" to file %s...\n",
                 external ? "export" : name.c_str(), sanitize_print(filename).c_str());
         try {
-            std::string new_state = state.dump();
+            std::string new_state = encodeState(state, !external && _binary);
             std::string old_state;
             if (!readFile(filename, old_state) || old_state != new_state)
-                return writeFile(filename, new_state);
+                return writeStateFile(filename, new_state);
         } catch (std::exception& ex) {
             fprintf(stderr, "error saving: %s\n", ex.what());
             return false;
@@ -102,10 +180,7 @@ bool StateManager::loadState(Tracker* tracker, ScriptHost* scripthost, json& ext
         extra_out = it->second["extra"];
     } else {
         std::string s;
-        fs::path filename = external ? fs::u8path(name) : (_dir /
-                sanitize_dir(pack->getUID()) /
-                sanitize_dir(pack->getVersion()) /
-                sanitize_dir(pack->getVariant()) / (name + ".json"));
+        fs::path filename = external ? fs::u8path(name) : findStateFile(pack, name);
         printf("Loading state \"%s\" from file %s...",
                 external ? "import" : name.c_str(), sanitize_print(filename).c_str());
         if (!readFile(filename, s)) {
@@ -113,7 +188,11 @@ bool StateManager::loadState(Tracker* tracker, ScriptHost* scripthost, json& ext
             return false;
         }
         printf("\n");
-        auto j = parse_jsonc(s);
+        auto j = decodeState(s);
+        if (!j.is_object()) {
+            printf("error\n");
+            return false;
+        }
         res = tracker->loadState(j);
         replayHints(tracker, j);
         extra_out = j["extra"];
@@ -143,12 +222,9 @@ json StateManager::getStateExtra(Tracker* tracker,
         }
     } else {
         std::string s;
-        fs::path filename = external ? fs::path(name) : _dir /
-                sanitize_dir(pack->getUID()) /
-                sanitize_dir(pack->getVersion()) /
-                sanitize_dir(pack->getVariant()) / (name+".json");
+        fs::path filename = external ? fs::path(name) : findStateFile(pack, name);
         if (readFile(filename, s)) {
-            auto j = parse_jsonc(s);
+            auto j = decodeState(s);
             if (j.is_object())
                 return j["extra"];
         }
@@ -21,6 +21,20 @@ public:
             bool file=false, const std::string& name="autosave",
             bool external=false);
     static void setDir(const fs::path& dir);
+    /// Builds the json of a state file. Has to be called from the thread that owns tracker.
+    static json makeState(Tracker* tracker,
+            const std::list< std::pair<std::string,std::string> >& uiHints, const json& extra);
+    /// Store internal states (autosave) as CBOR instead of JSON. Exports are always JSON.
+    static void setBinary(bool binary);
+    static bool isBinary();
+    /// Returns the file that stores state name for the loaded pack, version and variant in the current format.
+    static fs::path getStateFile(const Pack* pack, const std::string& name);
+    /// Serializes state, as CBOR if binary is true.
+    static std::string encodeState(const json& state, bool binary);
+    /// Parses a state file in either format. Returns null if the data is invalid.
+    static json decodeState(std::string& data);
+    /// Writes data through a temporary file and rename, so a crash can not leave a truncated state file behind.
+    static bool writeStateFile(const fs::path& filename, const std::string& data);
     
 private:
     struct StateID {
@@ -44,6 +58,9 @@ private:
     
     static std::map<StateID, nlohmann::json> _states;
     static fs::path _dir;
+    static bool _binary;
+
+    static fs::path findStateFile(const Pack* pack, const std::string& name);
 };
 
 #endif /* _CORE_STATEMANAGER_H */
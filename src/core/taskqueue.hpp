@@ -7,15 +7,34 @@
 #include <functional>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <thread>
+#include <vector>
 
 namespace pop {
 
+/// Runs tasks on a fixed number of worker threads that are started with the first task.
+/// Prioritized tasks run before all others, the rest in order of enqueueing.
 template<class T>
 class TaskQueue {
 public:
     static constexpr size_t NO_TASK = 0;
 
+    /// Returns the number of workers that saturates all cores.
+    static size_t getHardwareConcurrency()
+    {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 1;
+    }
+
+    explicit TaskQueue(size_t workers = 1)
+        : _workerCount(std::max<size_t>(workers, 1))
+    {
+    }
+
+    TaskQueue(const TaskQueue&) = delete;
+
     size_t enqueue(std::function<T()>&& func)
     {
         std::lock_guard lock(_taskMutex);
@@ -25,18 +44,20 @@ public:
         {
             // TODO: reuse of taskNumber is very unlikely on 64bit. Skip this?
             std::lock_guard resultMutex(_resultMutex);
-            while (_tasks.find(_lastTaskNumber) != _tasks.end() || _results.find(_lastTaskNumber) != _results.end()) {
+            while (_tasks.find(_lastTaskNumber) != _tasks.end()
+                    || _activeTasks.find(_lastTaskNumber) != _activeTasks.end()
+                    || _results.find(_lastTaskNumber) != _results.end()) {
                 _lastTaskNumber++;
                 if (_lastTaskNumber == NO_TASK)
                     _lastTaskNumber++;
             }
         }
         _tasks.emplace(_lastTaskNumber, std::move(func));
-        if (_tasks.size() == 1) { // TODO: one fixed thread and wake it instead?
-            if (_thread.joinable())
-                _thread.join();
-            _thread = std::thread(&TaskQueue::run, this);
+        if (_workers.empty()) {
+            for (size_t i = 0; i < _workerCount; i++)
+                _workers.emplace_back(&TaskQueue::run, this);
         }
+        _taskCondition.notify_one();
         return _lastTaskNumber;
     }
 
@@ -75,7 +96,9 @@ public:
 
     void prioritize(const size_t taskNumber)
     {
-        std::lock_guard lock(_priorityMutex);
+        std::lock_guard lock(_taskMutex);
+        if (_tasks.find(taskNumber) == _tasks.end())
+            return; // already running or completed
         if (std::find(_priorityQueue.begin(), _priorityQueue.end(), taskNumber) != _priorityQueue.end())
             return;
         _priorityQueue.emplace_back(taskNumber);
@@ -84,13 +107,12 @@ public:
     bool cancel(const size_t taskNumber)
     {
         std::lock_guard lock(_taskMutex);
-        if (_activeTaskNumber == taskNumber)
+        if (_activeTasks.find(taskNumber) != _activeTasks.end())
             return false; // already running
         auto it = _tasks.find(taskNumber);
         if (it == _tasks.end())
             return false; // already completed
-        if (_tasks.size() == 1)
-            return false; // about to start, could deadlock the thread restart logic
+        // not dequeued by a worker yet, so it will never start
         _tasks.erase(it);
         return true;
     }
@@ -100,92 +122,70 @@ public:
         // NOTE: this should run after dtor of all task owners, so _tasks should be empty.
         //       Uncollected/uncanceled tasks are potential memory leaks.
         std::unique_lock taskLock(_taskMutex);
-        if (!_tasks.empty()) {
+        if (!_tasks.empty() || !_activeTasks.empty()) {
             // Getting here is a bug in the program. We assume that the owners of tasks are dead and try to shut down.
-            fprintf(stderr, "WARNING: destroying task queue with %zu queued tasks!\n", _tasks.size());
+            fprintf(stderr, "WARNING: destroying task queue with %zu queued tasks!\n",
+                    _tasks.size() + _activeTasks.size());
             // Give it some time to finish since we don't know if cancelling tasks is safe.
             for (int i = 0; i < 100; ++i) {
                 taskLock.unlock();
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 taskLock.lock();
-                if (_tasks.empty()) {
+                if (_tasks.empty() && _activeTasks.empty()) {
                     break;
                 }
             }
-            // Try to cancel tasks that can be canceled, and finish the remaining ones.
-            std::vector<size_t> taskNumbers;
-            for (const auto& pair: _tasks) {
-                taskNumbers.emplace_back(pair.first);
-            }
-            taskLock.unlock();
-            for (auto& taskNumber: taskNumbers) {
-                if (cancel(taskNumber))
-                    taskNumber = NO_TASK;
-            }
-            for (const auto taskNumber: taskNumbers) {
-                if (taskNumber != NO_TASK)
-                    get(taskNumber);
-            }
-        } else {
-            taskLock.unlock();
+            // Cancel tasks that did not start yet. Running tasks are finished when joining the workers.
+            _tasks.clear();
+            _priorityQueue.clear();
         }
+        _stopping = true;
+        taskLock.unlock();
+        _taskCondition.notify_all();
+        for (auto& worker: _workers)
+            worker.join();
         {
             std::lock_guard lock(_resultMutex);
             if (!_results.empty()) {
                 fprintf(stderr, "WARNING: destroying task queue with %zu pending results!\n", _results.size());
             }
         }
-        if (_thread.joinable())
-            _thread.join();
     }
 
 private:
     void run()
     {
-        // NOTE: because of the thread restart logic, this lock is awkward
         std::unique_lock taskLock(_taskMutex);
         while (true) {
-            size_t taskNumber = NO_TASK;
-            std::function<T()> func;
-            // find priority task to execute
-            while (taskNumber == NO_TASK) {
-                {
-                    std::lock_guard lock(_priorityMutex);
-                    if (_priorityQueue.empty())
-                        break;
-                    taskNumber = _priorityQueue.front();
-                    _priorityQueue.erase(_priorityQueue.begin());
-                }
-                {
-                    auto work = _tasks.find(taskNumber);
-                    if (work != _tasks.end()) {
-                        _activeTaskNumber = taskNumber;
-                        func = std::move(work->second);
-                        break;
-                    }
-                    taskNumber = NO_TASK; // try next
-                }
-            }
-            // if no priority task was found, execute first task
-            if (taskNumber == NO_TASK) {
-                if (_tasks.empty())
-                    break;
-                auto work = _tasks.begin();
-                taskNumber = work->first;
-                _activeTaskNumber = taskNumber;
-                func = std::move(work->second);
+            _taskCondition.wait(taskLock, [this] { return _stopping || !_tasks.empty(); });
+            if (_stopping)
+                break;
+            // find priority task to execute, otherwise execute first task
+            auto work = _tasks.end();
+            while (work == _tasks.end() && !_priorityQueue.empty()) {
+                work = _tasks.find(_priorityQueue.front());
+                _priorityQueue.erase(_priorityQueue.begin());
             }
+            if (work == _tasks.end())
+                work = _tasks.begin();
+            const size_t taskNumber = work->first;
+            std::function<T()> func = std::move(work->second);
+            _tasks.erase(work);
+            _activeTasks.insert(taskNumber);
             taskLock.unlock();
             // ReSharper disable once CppTooWideScope
             T res = func();
+            func = nullptr;
+            // mark as done before publishing the result, so the task is gone once get() returns
+            taskLock.lock();
+            _activeTasks.erase(taskNumber);
+            taskLock.unlock();
             {
                 std::lock_guard lock(_resultMutex);
                 _results.emplace(taskNumber, std::move(res));
                 _resultCondition.notify_all();
             }
             taskLock.lock();
-            _tasks.erase(taskNumber);
-            _activeTaskNumber = NO_TASK;
         }
 #ifdef SDL_INIT_EVERYTHING
         // if SDL is included, assume the tasks may have used SDL
@@ -193,16 +193,18 @@ private:
 #endif
     }
 
+    const size_t _workerCount;
     size_t _lastTaskNumber = NO_TASK;
-    size_t _activeTaskNumber = NO_TASK;
     std::mutex _taskMutex;
+    std::condition_variable _taskCondition;
     std::map<size_t, std::function<T()>> _tasks;
-    std::mutex _priorityMutex;
+    std::set<size_t> _activeTasks;
     std::vector<size_t> _priorityQueue;
+    bool _stopping = false;
     std::mutex _resultMutex;
     std::condition_variable _resultCondition;
     std::map<size_t, T> _results;
-    std::thread _thread;
+    std::vector<std::thread> _workers;
 };
 
 } // namespace pop
@@ -1,9 +1,13 @@
 #include "tracker.h"
+#include <algorithm>
 #include <cstring>
+#include <deque>
 #include <sstream>
+#include <unordered_map>
 #include <luaglue/luamethod.h>
 #include <nlohmann/json.hpp>
 #include "jsonutil.h"
+#include "packpreloader.h"
 #include "util.h"
 #include "../http/http.h"
 #include "../http/httputil.hpp"
@@ -166,22 +170,42 @@ int Tracker::runLuaFunction(lua_State* L, const std::string& name, int &out)
     return callStatus;
 }
 
-bool Tracker::AddItems(const std::string& file)
+void Tracker::setPreloader(PackPreloader* preloader)
 {
-    printf("Loading items from \"%s\"...\n", file.c_str());
+    _preloader = preloader;
+}
+
+bool Tracker::readJson(const std::string& file, json& j)
+{
+    if (_preloader && _preloader->take(file, j))
+        return true;
     std::string s;
     if (!_pack->ReadFile(file, s)) {
         // TODO: throw lua error?
         fprintf(stderr, "WARNING: unable to read file\n");
         return false;
     }
-    return AddItemsFromString(s);
+    j = parse_jsonc(s);
+    return true;
+}
+
+bool Tracker::AddItems(const std::string& file)
+{
+    printf("Loading items from \"%s\"...\n", file.c_str());
+    json j;
+    if (!readJson(file, j))
+        return false;
+    return addItems(j);
 }
 
 bool Tracker::AddItemsFromString(std::string& s)
 {
     json j = parse_jsonc(s);
+    return addItems(j);
+}
 
+bool Tracker::addItems(json& j)
+{
     if (j.type() != json::value_t::array) {
         fprintf(stderr, "Bad json\n"); // TODO: throw lua error?
         return false;
@@ -200,11 +224,11 @@ bool Tracker::AddItemsFromString(std::string& s)
         auto& item = _jsonItems.back();
         item.setID(++_lastItemID);
         item.makeStableID(_itemStableNameCounter);
+        indexJsonItem(item);
         item.onChange += {this, [this](void* sender) {
             const auto* i = static_cast<JsonItem*>(sender);
             if (!_updatingCache || !_itemChangesDuringCacheUpdate.count(i->getID())) {
-                _providerCountCache.clear();
-                _accessibilityStale = true;
+                invalidateAccessibility(*i, true);
                 _visibilityStale = true;
                 if (_updatingCache)
                     _itemChangesDuringCacheUpdate.insert(i->getID());
@@ -371,19 +395,20 @@ bool Tracker::AddItemsFromString(std::string& s)
 bool Tracker::AddLocations(const std::string& file)
 {
     printf("Loading locations from \"%s\"...\n", file.c_str());
-    std::string s;
-    if (!_pack->ReadFile(file, s)) {
-        // TODO: throw lua error?
-        fprintf(stderr, "WARNING: unable to read file\n");
+    json j;
+    if (!readJson(file, j))
         return false;
-    }
-    return AddLocationsFromString(s);
+    return addLocations(j);
 }
 
 bool Tracker::AddLocationsFromString(std::string& s)
 {
     json j = parse_jsonc(s);
+    return addLocations(j);
+}
 
+bool Tracker::addLocations(json& j)
+{
     if (j.type() != json::value_t::array) {
         fprintf(stderr, "Bad json\n"); // TODO: throw lua error?
         return false;
@@ -394,6 +419,8 @@ bool Tracker::AddLocationsFromString(std::string& s)
     _sectionRefs.clear();
     _accessibilityStale = true;
     _visibilityStale = true;
+    for (auto& ref: _ruleReferences)
+        ref = {}; // new locations may change what @-rules point to
     const auto targetPopTrackerVersion = _pack->getTargetPopTrackerVersion();
     const bool glitchedScoutableAsGlitched =
             targetPopTrackerVersion > Version{0, 0, 0} &&
@@ -407,12 +434,13 @@ bool Tracker::AddLocationsFromString(std::string& s)
                 fprintf(stderr, "WARNING: merging duplicate location \"%s\"!\n", sanitize_print(loc.getID()).c_str());
                 other.merge(loc);
                 merged = true;
+                indexLocation(other);
+                compileRules(other);
                 for (auto& sec : other.getSections()) {
                     sec.onChange -= this;
                     sec.onChange += {this,[this,&sec](void*) {
-                        // TODO: only touch caches and stale if sec's AvailableChestCount is involved in logic
-                        _providerCountCache.clear();
-                        _accessibilityStale = true;
+                        // only Lua can read AvailableChestCount, so only codes running Lua have to be resolved again
+                        invalidateLuaDependents();
                         _visibilityStale = true;
                         if (_bulkUpdate)
                             _bulkSectionUpdates.push_back(sec.getFullID());
@@ -455,13 +483,14 @@ bool Tracker::AddLocationsFromString(std::string& s)
         }
 #endif
         _locations.push_back(std::move(loc)); // TODO: move constructor
+        indexLocation(_locations.back());
+        compileRules(_locations.back());
         for (auto& sec : _locations.back().getSections()) {
             if (!sec.getRef().empty())
                 _sectionNameRefs[sec.getRef()].push_back(sec.getFullID());
             sec.onChange += {this,[this,&sec](void*) {
-                // TODO: only touch caches and stale if sec's AvailableChestCount is involved in logic
-                _providerCountCache.clear();
-                _accessibilityStale = true;
+                // only Lua can read AvailableChestCount, so only codes running Lua have to be resolved again
+                invalidateLuaDependents();
                 _visibilityStale = true;
                 if (_bulkUpdate)
                     _bulkSectionUpdates.push_back(sec.getFullID());
@@ -477,13 +506,9 @@ bool Tracker::AddLocationsFromString(std::string& s)
 
 bool Tracker::AddMaps(const std::string& file) {
     printf("Loading maps from \"%s\"...\n", file.c_str());
-    std::string s;
-    if (!_pack->ReadFile(file, s)) {
-        // TODO: throw lua error?
-        fprintf(stderr, "WARNING: unable to read file\n");
+    json j;
+    if (!readJson(file, j))
         return false;
-    }
-    json j = parse_jsonc(s);
     
     if (j.type() != json::value_t::array) {
         fprintf(stderr, "Bad json\n"); // TODO: throw lua error?
@@ -504,13 +529,9 @@ bool Tracker::AddMaps(const std::string& file) {
 
 bool Tracker::AddLayouts(const std::string& file) {
     printf("Loading layouts from \"%s\"...\n", file.c_str());
-    std::string s;
-    if (!_pack->ReadFile(file, s)) {
-        // TODO: throw lua error?
-        fprintf(stderr, "WARNING: unable to read file\n");
+    json j;
+    if (!readJson(file, j))
         return false;
-    }
-    json j = parse_jsonc(s);
     
     if (j.type() != json::value_t::object) {
         fprintf(stderr, "Bad json\n"); // TODO: throw lua error?
@@ -541,13 +562,9 @@ bool Tracker::AddLayouts(const std::string& file) {
 
 bool Tracker::AddClasses(const std::string& file) {
     printf("Loading classes from \"%s\"...\n", file.c_str());
-    std::string s;
-    if (!_pack->ReadFile(file, s)) {
-        // TODO: throw lua error?
-        fprintf(stderr, "WARNING: unable to read file\n");
+    json j;
+    if (!readJson(file, j))
         return false;
-    }
-    json j = parse_jsonc(s);
     
     if (j.type() != json::value_t::object) {
         fprintf(stderr, "Bad json\n"); // TODO: throw lua error?
@@ -570,6 +587,14 @@ bool Tracker::AddClasses(const std::string& file) {
 
 int Tracker::ProviderCountForCode(const std::string& code)
 {
+    if (_resolvingNode) {
+        // remember who used the code, so we know what to update when it changes
+        if (!code.empty() && code[0] == '$')
+            _luaDependents.emplace(*_resolvingNode);
+        else
+            _codeDependents[code].emplace(*_resolvingNode);
+    }
+
     // cache this, because inefficient use can make the Lua script hang
     const auto it = _providerCountCache.find(code);
     if (it != _providerCountCache.end())
@@ -587,31 +612,33 @@ int Tracker::ProviderCountForCode(const std::string& code)
     }
 
     // other codes count items
-#ifdef JSONITEM_CI_QUIRK
-    {
-        const auto lower = JsonItem::toLower(code);
-        for (const auto& item : _jsonItems)
-        {
-            res += item.providesCodeLower(lower);
-        }
+    const auto codeID = findItemCode(code);
+    if (codeID != CodeTable::INVALID) {
+        for (const auto* item : _codeProviders[codeID])
+            res += item->providesCode(code);
     }
-#else
-    for (const auto& item : _jsonItems)
-    {
-        res += item.providesCode(code);
-    }
-#endif
 
-    for (const auto& item : _luaItems)
-    {
-        if (item.canProvideCode(code)) {
+    // Lua may change code providers while counting, which invalidates the list. Count again in that case.
+    int luaRes = 0;
+    uint64_t generation = 0;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        luaRes = 0;
+        const auto& luaProviders = getLuaCodeProviders(code);
+        generation = _luaProvidersGeneration;
+        for (size_t i = 0; _luaProvidersGeneration == generation && i < luaProviders.size(); i++) {
+            const auto* item = luaProviders[i];
+            _luaItemCodes[item->getID()].emplace(code);
+            _luaProvidedCodes.emplace(code);
             _luaCodesStack.emplace_back(code);
-            res += item.providesCode(code);
+            luaRes += item->providesCode(code);
             _luaCodesStack.pop_back();
         }
+        if (_luaProvidersGeneration == generation)
+            break;
     }
+    res += luaRes;
 
-    if (!_indirectlyConnectedLuaCodes.count(code))
+    if (_luaProvidersGeneration == generation && !_indirectlyConnectedLuaCodes.count(code))
         _providerCountCache[code] = res;
     return res;
 }
@@ -648,24 +675,13 @@ Tracker::Object Tracker::FindObjectForCode(const char* code)
             return _objectCache.emplace(code, &loc).first->second;
         }
     } else {
-#ifdef JSONITEM_CI_QUIRK
-        const auto lower = JsonItem::toLower(code);
-        for (auto& item : _jsonItems) {
-            if (item.canProvideCodeLower(lower))
-                return _objectCache.emplace(code, &item).first->second;
-        }
-#else
-        for (auto& item : _jsonItems) {
-            if (item.canProvideCode(code))
-                return _objectCache.emplace(code, &item).first->second;
-        }
-#endif
+        const auto codeID = findItemCode(code);
+        if (codeID != CodeTable::INVALID)
+            return _objectCache.emplace(code, _codeProviders[codeID].front()).first->second;
 
-        for (auto& item : _luaItems) {
-            if (item.canProvideCode(code)) {
-                return _objectCache.emplace(code, &item).first->second;
-            }
-        }
+        const auto& luaProviders = getLuaCodeProviders(code);
+        if (!luaProviders.empty())
+            return _objectCache.emplace(code, luaProviders.front()).first->second;
     }
     printf("Did not find object for code \"%s\".\n", sanitize_print(code).c_str());
     return nullptr;
@@ -749,23 +765,7 @@ bool Tracker::Lua_NewIndex(lua_State *L, const char* key) {
         luaL_error(L, "Tried to write read-only property Tracker.%s", key);
     } else if (strcmp(key, "BulkUpdate") == 0) {
         bool val = lua_isnumber(L, -1) ? (lua_tonumber(L, -1) != 0) : lua_toboolean(L, -1);
-        if (_bulkUpdate && !val) {
-            eraseDuplicates(_bulkItemUpdates);
-            for (const auto& id: _bulkItemUpdates)
-                onStateChanged.emit(this, id);
-            _bulkItemUpdates.clear();
-            eraseDuplicates(_bulkItemDisplayUpdates);
-            for (const auto& id: _bulkItemDisplayUpdates)
-                onDisplayChanged.emit(this, id);
-            _bulkItemDisplayUpdates.clear();
-            for (const auto& id: _bulkSectionUpdates)
-                onLocationSectionChanged.emit(this, getLocationSection(id));
-            _bulkSectionUpdates.clear();
-            _bulkUpdate = false;
-            onBulkUpdateDone.emit(this);
-        } else {
-            _bulkUpdate = val;
-        }
+        setBulkUpdate(val);
         return true;
     } else if (strcmp(key, "AllowDeferredLogicUpdate") == 0) {
         bool val = lua_isnumber(L, -1) ? (lua_tonumber(L, -1) != 0) : lua_toboolean(L, -1);
@@ -801,20 +801,11 @@ bool Tracker::hasLayout(const std::string& name) const
 
 const BaseItem& Tracker::getItemByCode(const std::string& code) const
 {
-#ifdef JSONITEM_CI_QUIRK
-    const auto lower = JsonItem::toLower(code);
-    for (const auto& item: _jsonItems) {
-        if (item.canProvideCodeLower(lower))
-            return item;
-    }
-#else
-    for (const auto& item: _jsonItems) {
-        if (item.canProvideCode(code))
-            return item;
-    }
-#endif
+    const auto codeID = findItemCode(code);
+    if (codeID != CodeTable::INVALID)
+        return *_codeProviders[codeID].front();
 
-    for (const auto& item: _luaItems) {
+    for (const auto& item : _luaItems) {
         if (item.canProvideCode(code))
             return item;
     }
@@ -824,13 +815,8 @@ const BaseItem& Tracker::getItemByCode(const std::string& code) const
 
 BaseItem& Tracker::getItemById(const std::string& id)
 {
-    for (auto& item: _jsonItems) {
-        if (item.getID() == id) return item;
-    }
-    for (auto& item: _luaItems) {
-        if (item.getID() == id) return item;
-    }
-    return blankItem;
+    const auto it = _itemsByID.find(id);
+    return it == _itemsByID.end() ? blankItem : *it->second;
 }
 
 std::list< std::pair<std::string, Location::MapLocation> > Tracker::getMapLocations(const std::string& mapname) const
@@ -848,30 +834,23 @@ std::list< std::pair<std::string, Location::MapLocation> > Tracker::getMapLocati
 
 Location& Tracker::getLocation(const std::string& id, const bool partialMatch)
 {
-    for (auto& loc : _locations) {
-        if (loc.getID() == id)
-            return loc;
-    }
+    const auto it = _locationsByID.find(id);
+    if (it != _locationsByID.end())
+        return *it->second;
     if (partialMatch) {
-        if (id.find('/') == std::string::npos) {
-            for (auto& loc : _locations) {
-                if (loc.getName() == id)
-                    return loc;
-            }
-        } else {
-            const std::string search = "/" + id;
-            for (auto& loc : _locations) {
-                const auto& s = loc.getID();
-                if (s.size() > search.size() && s.compare(s.size() - search.size(), search.size(), search) == 0)
-                    return loc;
-            }
-        }
+        const auto& index = (id.find('/') == std::string::npos) ? _locationsByName : _locationsBySuffix;
+        const auto partialIt = index.find(id);
+        if (partialIt != index.end())
+            return *partialIt->second;
     }
     return blankLocation;
 }
 
 std::pair<Location&, LocationSection&> Tracker::getLocationAndSection(const std::string& id)
 {
+    const auto it = _sectionsByID.find(id);
+    if (it != _sectionsByID.end())
+        return {*it->second.first, *it->second.second};
     const char *start = id.c_str();
     const char *t = strrchr(start, '/');
     if (t) { // valid section identifier
@@ -930,6 +909,27 @@ bool Tracker::isBulkUpdate() const
     return _bulkUpdate;
 }
 
+void Tracker::setBulkUpdate(bool value)
+{
+    if (_bulkUpdate && !value) {
+        eraseDuplicates(_bulkItemUpdates);
+        for (const auto& id: _bulkItemUpdates)
+            onStateChanged.emit(this, id);
+        _bulkItemUpdates.clear();
+        eraseDuplicates(_bulkItemDisplayUpdates);
+        for (const auto& id: _bulkItemDisplayUpdates)
+            onDisplayChanged.emit(this, id);
+        _bulkItemDisplayUpdates.clear();
+        for (const auto& id: _bulkSectionUpdates)
+            onLocationSectionChanged.emit(this, getLocationSection(id));
+        _bulkSectionUpdates.clear();
+        _bulkUpdate = false;
+        onBulkUpdateDone.emit(this);
+    } else {
+        _bulkUpdate = value;
+    }
+}
+
 bool Tracker::allowDeferredLogicUpdate() const
 {
     return _allowDeferredLogicUpdate;
@@ -948,23 +948,13 @@ const Pack* Tracker::getPack() const
 bool Tracker::changeItemState(const std::string& id, BaseItem::Action action)
 {
     std::string baseCode; // for type: toggle_badged
-    for (auto& item: _jsonItems) {
-        if (item.getID() != id) continue;
-        if (item.changeState(action)) {
-            // NOTE: item fires onChanged
-            return true;
-        }
-        baseCode = item.getBaseItem();
-        break;
-    }
-    for (auto& item: _luaItems) {
-        if (item.getID() != id) continue;
-        if (item.changeState(action)) {
+    const auto it = _itemsByID.find(id);
+    if (it != _itemsByID.end()) {
+        if (it->second->changeState(action)) {
             // NOTE: item fires onChanged
             return true;
         }
-        baseCode = item.getBaseItem();
-        break;
+        baseCode = it->second->getBaseItem();
     }
     if (!baseCode.empty()) {
         // for items that have a base item, propagate click
@@ -1012,93 +1002,63 @@ AccessibilityLevel Tracker::isReachable(const LocationSection& section)
 bool Tracker::isVisible(const Location::MapLocation& mapLoc)
 {
     if (!mapLoc.getInvisibilityRules().empty()
-            && resolveRules(mapLoc.getInvisibilityRules(), true, false) != AccessibilityLevel::NONE)
+            && resolveRules(mapLoc.getCompiledInvisibilityRules(), true, false) != AccessibilityLevel::NONE)
         return false;
-    return resolveRules(mapLoc.getVisibilityRules(), true, false) != AccessibilityLevel::NONE;
+    return resolveRules(mapLoc.getCompiledVisibilityRules(), true, false) != AccessibilityLevel::NONE;
 }
 
 AccessibilityLevel Tracker::resolveRules(
-    const std::list< std::list<std::string> >& rules,
+    const CompiledRules& rules,
     const bool visibilityRules,
     const bool glitchedScoutableAsGlitched
 )
 {
+    using OpType = CompiledRules::OpType;
     bool glitchedReachable = false;
     bool inspectOnlyReachable = false;
     if (rules.empty()) return AccessibilityLevel::NORMAL;
-    for (const auto& ruleset : rules) { //<-- these are all to be ORed
-        if (ruleset.empty()) return AccessibilityLevel::NORMAL; // any empty rule set means true
+    const auto* op = rules.begin();
+    while (op != rules.end()) { //<-- sets of rules are all to be ORed
+        if (op->type == OpType::END) return AccessibilityLevel::NORMAL; // any empty rule set means true
         AccessibilityLevel reachable = AccessibilityLevel::NORMAL;
         bool inspectOnly = false;
-        for (const auto& rule: ruleset) { //<-- these are all to be ANDed
-            if (rule.empty()) continue; // empty/missing code is true
-            std::string s = rule;
+        for (; op->type != OpType::END; ++op) { //<-- these are all to be ANDed
             // '{' ... '}' means required to check (i.e. the rule never returns "reachable", but "checkable" instead)
-            if (!s.empty() && s[0] == '{') {
+            if (op->flags & CompiledRules::FLAG_BRACE_OPEN)
                 inspectOnly = true;
-                s = s.substr(1,s.length()-1);
-            }
-            if (inspectOnly && !s.empty() && s[s.length()-1] == '}') {
-                s = s.substr(0, s.length()-1);
+            const auto* rule = op;
+            if (op->flags & CompiledRules::FLAG_HAS_ALT) {
+                ++op; // skip alternative
+                if (inspectOnly)
+                    rule = op; // use alternative
             }
             // '[' ... ']' means optional/glitches required (different color)
-            bool optional = false;
-            if (s.length() > 1 && s[0] == '[' && s[s.length()-1]==']') {
-                optional = true;
-                s = s.substr(1,s.length()-2);
-            }
-            if (inspectOnly && s.empty()) {
+            const bool optional = rule->flags & CompiledRules::FLAG_OPTIONAL;
+            if (rule->type == OpType::SKIP) {
                 continue;
-            }
-            // '^$func' gives direct accessibility level rather than an integer code count
-            bool isAccessibilitLevel = s[0] == '^'; // use value as level instead of count
-            // '@...' references another location or section
-            bool isLocationReference = s[0] == '@';
-            // '<rule>:<count>' checks count (e.g. consumables) instead of bool
-            int count = 1;
-            auto p = s.find(':');
-            if (!isAccessibilitLevel && !isLocationReference && p != s.npos) {
-                count = atoi(s.c_str()+p+1);
-                s = s.substr(0,p);
-            }
-            if (isAccessibilitLevel) {
-                if (s.length() < 3 || s[1] != '$') { // only ^$ supported
-                    fprintf(stderr, "Warning: invalid rule \"%s\"",
-                            sanitize_print(s).c_str());
-                    reachable = AccessibilityLevel::NONE;
-                    break;
-                }
-                s = s.substr(1);
-            }
-            if (s[0] == '@') {
-                const char* start = s.c_str()+1;
-                const char* t = strrchr(s.c_str()+1, '/');
-                std::string locid = s.substr(1);
-                auto& loc = getLocation(locid, true);
+            } else if (rule->type == OpType::INVALID) {
+                reachable = AccessibilityLevel::NONE;
+                break;
+            } else if (rule->type == OpType::REFERENCE) {
+                // '@...' references another location or section
+                const auto& ref = resolveRuleReference(rule->arg);
                 bool match = false;
                 AccessibilityLevel sub = AccessibilityLevel::NONE;
-                if (!loc.getID().empty()) {
+                if (ref.location && !ref.section) {
                     // @-Rule for location, not a section
                     if (visibilityRules)
-                        sub = isVisible(loc) ? AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
+                        sub = isVisible(*ref.location) ? AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
                     else
-                        sub = isReachable(loc);
+                        sub = isReachable(*ref.location);
+                    match = true;
+                } else if (ref.section) {
+                    // @-Rule for a section
+                    if (visibilityRules)
+                        sub = isVisible(*ref.location, *ref.section) ?
+                                AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
+                    else
+                        sub = isReachable(*ref.location, *ref.section);
                     match = true;
-                } else if (t) {
-                    // @-Rule for a section (also run for missing location with '/')
-                    std::string sublocid = locid.substr(0, t-start);
-                    std::string subsecname = t+1;
-                    auto& subloc = getLocation(sublocid, true);
-                    for (auto& subsec: subloc.getSections()) {
-                        if (subsec.getName() != subsecname)
-                            continue;
-                        if (visibilityRules)
-                            sub = isVisible(subloc, subsec) ? AccessibilityLevel::NORMAL : AccessibilityLevel::NONE;
-                        else
-                            sub = isReachable(subloc, subsec);
-                        match = true;
-                        break;
-                    }
                 }
                 if (match) {
                     // combine current state with sub-result
@@ -1111,31 +1071,30 @@ AccessibilityLevel Tracker::resolveRules(
                     if (sub == AccessibilityLevel::SEQUENCE_BREAK && reachable != AccessibilityLevel::NONE)
                         reachable = AccessibilityLevel::SEQUENCE_BREAK;
                 } else {
-                    printf("Could not find location %s for access rule!\n",
-                            sanitize_print(s).c_str());
+                    printf("Could not find location @%s for access rule!\n",
+                            sanitize_print(_ruleReferenceTargets.name(rule->arg)).c_str());
                 }
                 if (reachable == AccessibilityLevel::NONE) break;
-            }
-            // '$' calls into Lua, now also supported by ProviderCountForCode
-            // other: references codes (with or without count)
-            else {
+            } else if (rule->type == OpType::LEVEL) {
+                // '^$func' gives direct accessibility level rather than an integer code count
                 // NOTE: ProvideCountForCode has a cache
-                int n = ProviderCountForCode(s);
-                if (isAccessibilitLevel) { // TODO: merge this with '@' code path
-                    auto sub = static_cast<AccessibilityLevel>(n);
-                    if (!inspectOnly && sub == AccessibilityLevel::INSPECT)
-                        inspectOnly = true;
-                    else if (optional && sub == AccessibilityLevel::NONE)
-                        sub = AccessibilityLevel::SEQUENCE_BREAK;
-                    else if (sub == AccessibilityLevel::NONE)
-                        reachable = AccessibilityLevel::NONE;
-                    if (sub == AccessibilityLevel::SEQUENCE_BREAK && reachable != AccessibilityLevel::NONE)
-                        reachable = AccessibilityLevel::SEQUENCE_BREAK;
-                    if (reachable == AccessibilityLevel::NONE)
-                        break;
-                    continue;
-                }
-                if (n >= count)
+                auto sub = static_cast<AccessibilityLevel>(ProviderCountForCode(_ruleCodes.name(rule->arg)));
+                if (!inspectOnly && sub == AccessibilityLevel::INSPECT)
+                    inspectOnly = true;
+                else if (optional && sub == AccessibilityLevel::NONE)
+                    sub = AccessibilityLevel::SEQUENCE_BREAK;
+                else if (sub == AccessibilityLevel::NONE)
+                    reachable = AccessibilityLevel::NONE;
+                if (sub == AccessibilityLevel::SEQUENCE_BREAK && reachable != AccessibilityLevel::NONE)
+                    reachable = AccessibilityLevel::SEQUENCE_BREAK;
+                if (reachable == AccessibilityLevel::NONE)
+                    break;
+            } else {
+                // '$' calls into Lua, now also supported by ProviderCountForCode
+                // other: references codes (with or without count)
+                // NOTE: ProvideCountForCode has a cache
+                const int n = ProviderCountForCode(_ruleCodes.name(rule->arg));
+                if (n >= rule->count)
                     continue;
                 if (optional) {
                     reachable = AccessibilityLevel::SEQUENCE_BREAK;
@@ -1145,6 +1104,9 @@ AccessibilityLevel Tracker::resolveRules(
                 }
             }
         }
+        while (op->type != OpType::END) // skip remaining rules of the set after a break
+            ++op;
+        ++op;
         if (reachable == AccessibilityLevel::NORMAL && !inspectOnly)
             return AccessibilityLevel::NORMAL;
         if (reachable != AccessibilityLevel::NONE && inspectOnly)
@@ -1159,11 +1121,101 @@ AccessibilityLevel Tracker::resolveRules(
                AccessibilityLevel::NONE;
 }
 
+/// Looks up the location or section referenced by an @-rule.
+const Tracker::RuleReference& Tracker::resolveRuleReference(const CodeTable::ID id)
+{
+    auto& ref = _ruleReferences[id];
+    if (ref.resolved)
+        return ref;
+    ref.resolved = true;
+    const auto& target = _ruleReferenceTargets.name(id);
+    auto& loc = getLocation(target, true);
+    if (!loc.getID().empty()) {
+        ref.location = &loc;
+        return ref;
+    }
+    const auto p = target.rfind('/');
+    if (p != std::string::npos) {
+        // also run for missing location with '/'
+        auto& subloc = getLocation(target.substr(0, p), true);
+        const char* subsecname = target.c_str() + p + 1;
+        for (auto& subsec: subloc.getSections()) {
+            if (subsec.getName() != subsecname)
+                continue;
+            ref.location = &subloc;
+            ref.section = &subsec;
+            break;
+        }
+    }
+    return ref;
+}
+
+/// Adds item to the ID and code lookup indexes.
+void Tracker::indexJsonItem(JsonItem& item)
+{
+    _itemsByID.emplace(item.getID(), &item);
+    for (const auto& code: item.getProvidableCodes()) {
+        const auto codeID = _itemCodes.intern(code);
+        if (codeID >= _codeProviders.size())
+            _codeProviders.resize(codeID + 1);
+        _codeProviders[codeID].push_back(&item);
+    }
+}
+
+void Tracker::indexLocation(Location& location)
+{
+    const auto& id = location.getID();
+    _locationsByID.emplace(id, &location);
+    _locationsByName.emplace(location.getName(), &location);
+    // partial match with '/' matches the end of the ID after a '/', but never the full ID
+    for (size_t p = id.find('/', 1); p != std::string::npos; p = id.find('/', p + 1)) {
+        auto suffix = id.substr(p + 1);
+        if (suffix.find('/') != std::string::npos)
+            _locationsBySuffix.emplace(std::move(suffix), &location);
+    }
+    // full section IDs that would be split differently by getLocationAndSection are left to the slow path
+    for (auto& sec: location.getSections()) {
+        if (sec.getName().find('/') == std::string::npos)
+            _sectionsByID.emplace(id + "/" + sec.getName(), std::make_pair(&location, &sec));
+    }
+}
+
+/// Returns the ID of a code in _itemCodes or CodeTable::INVALID if no json item can provide it.
+CodeTable::ID Tracker::findItemCode(const std::string& code) const
+{
+#ifdef JSONITEM_CI_QUIRK
+    // most packs use consistent case, so this only has to convert if the fast path fails
+    const auto id = _itemCodes.find(code);
+    if (id != CodeTable::INVALID)
+        return id;
+    return _itemCodes.find(JsonItem::toLower(code));
+#else
+    return _itemCodes.find(code);
+#endif
+}
+
+/// Compiles all rules of location, interning codes and @-references.
+void Tracker::compileRules(Location& location)
+{
+    location.compileRules(
+        [this](const std::string& code) {
+            return _ruleCodes.intern(code);
+        },
+        [this](const std::string& target) {
+            const auto id = _ruleReferenceTargets.intern(target);
+            if (id >= _ruleReferences.size())
+                _ruleReferences.resize(id + 1);
+            return id;
+        }
+    );
+}
+
 AccessibilityLevel Tracker::isReachable(const Location&, const LocationSection& section)
 {
     cacheAccessibility();
     const LocationSection& realSection = section.getRef().empty() ? section : getLocationSection(section.getRef());
     std::string id = realSection.getFullID();
+    recordAccessibilityDependency(id);
     return _accessibilityCache[id];
 }
 
@@ -1180,6 +1232,7 @@ bool Tracker::isVisible(const Location&, const LocationSection& section)
 AccessibilityLevel Tracker::isReachable(const Location& location)
 {
     cacheAccessibility();
+    recordAccessibilityDependency(location.getID());
     return _accessibilityCache[location.getID()];
 }
 
@@ -1191,12 +1244,71 @@ bool Tracker::isVisible(const Location& location)
     return _visibilityCache[location.getID()];
 }
 
+const std::vector<LuaItem*>& Tracker::getLuaCodeProviders(const std::string& code)
+{
+    const uint64_t generation = _luaProvidersGeneration;
+    auto it = _luaCodeProviders.find(code);
+    if (it != _luaCodeProviders.end() && it->second.generation == generation)
+        return it->second.items;
+
+    if (it == _luaCodeProviders.end()) {
+        // build into a local vector, since CanProvideCodeFunc may invalidate the index
+        std::vector<LuaItem*> providers;
+        for (auto& item : _luaItems) {
+            if (item.canProvideCode(code))
+                providers.push_back(&item);
+        }
+        return _luaCodeProviders.insert_or_assign(code, LuaCodeProviders{std::move(providers), generation})
+                .first->second.items;
+    }
+
+    // only ask items whose CanProvideCode changed since the entry was brought up to date
+    std::vector<std::pair<LuaItem*, bool>> changed;
+    for (const auto& [item, changedAt]: _changedLuaProviders) {
+        if (changedAt > it->second.generation)
+            changed.emplace_back(item, false);
+    }
+    for (auto& pair: changed)
+        pair.second = pair.first->canProvideCode(code);
+    it = _luaCodeProviders.find(code); // CanProvideCodeFunc may have cleared the index
+    if (it == _luaCodeProviders.end())
+        return getLuaCodeProviders(code);
+
+    auto& providers = it->second.items;
+    bool added = false;
+    for (const auto& [item, provides]: changed) {
+        const auto pos = std::find(providers.begin(), providers.end(), item);
+        if (pos != providers.end() && !provides) {
+            providers.erase(pos);
+        } else if (pos == providers.end() && provides) {
+            providers.push_back(item);
+            added = true;
+        }
+    }
+    if (added) {
+        // restore creation order, since the first provider wins in lookups
+        std::vector<LuaItem*> sorted;
+        sorted.reserve(providers.size());
+        for (auto& item : _luaItems) {
+            if (std::find(providers.begin(), providers.end(), &item) != providers.end())
+                sorted.push_back(&item);
+        }
+        providers = std::move(sorted);
+    }
+    it->second.generation = generation;
+    return providers;
+}
+
 LuaItem * Tracker::CreateLuaItem()
 {
     _luaItems.emplace_back();
     _objectCache.clear();
+    _luaCodeProviders.clear(); // the new item has to be asked for every code
+    _changedLuaProviders.clear();
+    _luaProvidersGeneration++; // lists handed out before are gone
     LuaItem& i = _luaItems.back();
     i.setID(++_lastItemID);
+    _itemsByID.emplace(i.getID(), &i);
     {
         lua_Debug ar;
         if (!lua_getstack(_L, 1, &ar)) {
@@ -1207,11 +1319,16 @@ LuaItem * Tracker::CreateLuaItem()
             i.setSource(ar.source, ar.currentline);
         }
     }
+    i.onCanProvideCodeChanged += {this, [this](void* sender) {
+        auto* i = static_cast<LuaItem*>(sender);
+        _changedLuaProviders[i] = ++_luaProvidersGeneration;
+        _luaItemsToRecheck.insert(i->getID());
+    }};
     i.onChange += {this, [this](void* sender) {
-        const auto* i = static_cast<LuaItem*>(sender);
+        auto* i = static_cast<LuaItem*>(sender);
         if (!_updatingCache || !_itemChangesDuringCacheUpdate.count(i->getID())) {
-            _providerCountCache.clear();
-            _accessibilityStale = true;
+            // codes that were never counted for the item only matter if its CanProvideCode changed
+            invalidateAccessibility(*i, _luaItemsToRecheck.erase(i->getID()) > 0);
             _visibilityStale = true;
             if (_updatingCache)
                 _itemChangesDuringCacheUpdate.insert(i->getID());
@@ -1229,12 +1346,26 @@ LuaItem * Tracker::CreateLuaItem()
 
 void Tracker::cacheAccessibility()
 {
-    if (!_accessibilityStale)
+    if (!_accessibilityStale) {
+        updateAccessibility();
         return;
+    }
     _updatingCache = true;
     _accessibilityCache.clear();
     _accessibilityStale = false;
 
+    // dependencies are recorded from scratch while resolving
+    _accessibilityNodes.clear();
+    _codeDependents.clear();
+    _nodeDependents.clear();
+    _luaDependents.clear();
+    _invalidAccessibility.clear();
+    for (const auto& location: _locations) {
+        _accessibilityNodes.emplace(location.getID(), std::make_pair(&location, nullptr));
+        for (const auto& section: location.getSections())
+            _accessibilityNodes.emplace(location.getID() + "/" + section.getName(), std::make_pair(&location, &section));
+    }
+
     bool done = false;
     while (!done) {
         done = true;
@@ -1242,7 +1373,9 @@ void Tracker::cacheAccessibility()
             bool glitchedScoutableAsGlitched = location.getGlitchedScoutableAsGlitched();
             auto it = _accessibilityCache.find(location.getID());
             if (it == _accessibilityCache.end() || it->second != AccessibilityLevel::NORMAL) {
-                const auto res = resolveRules(location.getAccessRules(), false, glitchedScoutableAsGlitched);
+                _resolvingNode = &location.getID();
+                const auto res = resolveRules(location.getCompiledAccessRules(), false, glitchedScoutableAsGlitched);
+                _resolvingNode = nullptr;
                 if (it == _accessibilityCache.end()) {
                     _accessibilityCache[location.getID()] = res;
                     done = false;
@@ -1258,7 +1391,9 @@ void Tracker::cacheAccessibility()
                 it = _accessibilityCache.find(id);
                 if (it != _accessibilityCache.end() && it->second == AccessibilityLevel::NORMAL)
                     continue; // nothing to do
-                const auto res = resolveRules(section.getAccessRules(), false, glitchedScoutableAsGlitched);
+                _resolvingNode = &id;
+                const auto res = resolveRules(section.getCompiledAccessRules(), false, glitchedScoutableAsGlitched);
+                _resolvingNode = nullptr;
                 if (it == _accessibilityCache.end()) {
                     _accessibilityCache[id] = res;
                     done = false;
@@ -1272,6 +1407,171 @@ void Tracker::cacheAccessibility()
 
     _updatingCache = false;
     _itemChangesDuringCacheUpdate.clear();
+    onLocationsChanged.emit(this, nullptr);
+}
+
+/// Resolves invalidated locations and sections again, using the dependencies recorded while resolving.
+void Tracker::updateAccessibility()
+{
+    if (_invalidAccessibility.empty() || _resolvingNode)
+        return; // nothing to do or called from within resolveRules
+    _updatingCache = true;
+
+    // anything that (indirectly) references an invalid node through @ has to start from scratch as well,
+    // otherwise cyclic references could keep each other reachable
+    std::unordered_set<std::string> invalid = std::move(_invalidAccessibility);
+    _invalidAccessibility.clear();
+    std::deque<std::string> pending(invalid.begin(), invalid.end());
+    for (size_t i = 0; i < pending.size(); i++) {
+        const auto it = _nodeDependents.find(pending[i]);
+        if (it == _nodeDependents.end())
+            continue;
+        for (const auto& dependent: it->second) {
+            if (invalid.emplace(dependent).second)
+                pending.push_back(dependent);
+        }
+    }
+    std::unordered_map<std::string, AccessibilityLevel> previous; // results before this update, to report changes
+    std::unordered_set<std::string> resolved;
+    for (const auto& id: invalid) {
+        const auto it = _accessibilityCache.find(id);
+        if (it == _accessibilityCache.end())
+            continue;
+        previous.emplace(id, it->second);
+        _accessibilityCache.erase(it);
+    }
+
+    // worklist: resolve each node and revisit nodes referencing it when the result changed
+    std::unordered_set<std::string> queued = std::move(invalid);
+    while (!pending.empty()) {
+        const std::string id = std::move(pending.front());
+        pending.pop_front();
+        queued.erase(id);
+        const auto nodeIt = _accessibilityNodes.find(id);
+        if (nodeIt == _accessibilityNodes.end())
+            continue; // not a location or section
+        auto it = _accessibilityCache.find(id);
+        if (it != _accessibilityCache.end() && it->second == AccessibilityLevel::NORMAL)
+            continue; // nothing to do
+        if (it != _accessibilityCache.end())
+            previous.emplace(id, it->second);
+        resolved.emplace(id);
+        const auto& [location, section] = nodeIt->second;
+        _resolvingNode = &id;
+        const auto res = section
+                ? resolveRules(section->getCompiledAccessRules(), false, section->getGlitchedScoutableAsGlitched())
+                : resolveRules(location->getCompiledAccessRules(), false, location->getGlitchedScoutableAsGlitched());
+        _resolvingNode = nullptr;
+        it = _accessibilityCache.find(id);
+        if (it == _accessibilityCache.end())
+            it = _accessibilityCache.emplace(id, res).first;
+        else if (it->second != res)
+            it->second = res;
+        else
+            continue; // no change
+        const auto dependentsIt = _nodeDependents.find(id);
+        if (dependentsIt == _nodeDependents.end())
+            continue;
+        for (const auto& dependent: dependentsIt->second) {
+            if (queued.emplace(dependent).second)
+                pending.push_back(dependent);
+        }
+    }
+
+    _updatingCache = false;
+    _itemChangesDuringCacheUpdate.clear();
+
+    std::unordered_set<std::string> changed;
+    for (const auto& id: resolved) {
+        const auto prevIt = previous.find(id);
+        if (prevIt == previous.end() || prevIt->second != _accessibilityCache[id])
+            addChangedLocation(changed, id);
+    }
+    if (!changed.empty())
+        onLocationsChanged.emit(this, &changed);
+}
+
+/// Adds the location of node, and locations with sections referencing it, to changed.
+void Tracker::addChangedLocation(std::unordered_set<std::string>& changed, const std::string& node)
+{
+    const auto nodeIt = _accessibilityNodes.find(node);
+    if (nodeIt == _accessibilityNodes.end())
+        return;
+    const auto& [location, section] = nodeIt->second;
+    changed.emplace(location->getID());
+    if (section) {
+        for (const auto& [refLocation, _]: getReferencingSections(*section))
+            changed.emplace(refLocation.get().getID());
+    }
+}
+
+void Tracker::updateLogic()
+{
+    cacheAccessibility();
+    cacheVisibility();
+}
+
+void Tracker::recordAccessibilityDependency(const std::string& node)
+{
+    if (_resolvingNode)
+        _nodeDependents[node].emplace(*_resolvingNode);
+}
+
+/// Invalidates cached counts and accessibility that depend on codes of item.
+/// Without checkAllCodes, only codes the item was counted for are invalidated, which avoids asking Lua for every code.
+void Tracker::invalidateAccessibility(const BaseItem& item, bool checkAllCodes)
+{
+    // codes provided before the change are remembered, since CanProvideCode of a Lua item may have changed
+    const auto luaCodesIt = _luaItemCodes.find(item.getID());
+    const auto affects = [&](const std::string& code) {
+        if (!code.empty() && code[0] == '$')
+            return true;
+        if (_luaProvidedCodes.count(code) || _indirectlyConnectedLuaCodes.count(code))
+            return true; // Lua items may read the changed item through FindObjectForCode
+        if (luaCodesIt != _luaItemCodes.end() && luaCodesIt->second.count(code))
+            return true;
+        return checkAllCodes && item.canProvideCode(code);
+    };
+
+    for (auto it = _providerCountCache.begin(); it != _providerCountCache.end();) {
+        if (affects(it->first))
+            it = _providerCountCache.erase(it);
+        else
+            ++it;
+    }
+    if (_accessibilityStale)
+        return; // everything will be resolved again anyway
+    for (const auto& [code, nodes]: _codeDependents) {
+        if (affects(code))
+            _invalidAccessibility.insert(nodes.begin(), nodes.end());
+    }
+    _invalidAccessibility.insert(_luaDependents.begin(), _luaDependents.end());
+}
+
+/// Invalidates cached results of codes that run Lua ($-codes and codes of Lua items) and accessibility that
+/// depends on them.
+void Tracker::invalidateLuaDependents()
+{
+    const auto runsLua = [this](const std::string& code) {
+        return (!code.empty() && code[0] == '$') || _luaProvidedCodes.count(code)
+                || _indirectlyConnectedLuaCodes.count(code);
+    };
+    for (auto it = _providerCountCache.begin(); it != _providerCountCache.end();) {
+        if (runsLua(it->first))
+            it = _providerCountCache.erase(it);
+        else
+            ++it;
+    }
+    if (_accessibilityStale)
+        return; // everything will be resolved again anyway
+    _invalidAccessibility.insert(_luaDependents.begin(), _luaDependents.end());
+    for (const auto* codes: {&_luaProvidedCodes, &_indirectlyConnectedLuaCodes}) {
+        for (const auto& code: *codes) {
+            const auto it = _codeDependents.find(code);
+            if (it != _codeDependents.end())
+                _invalidAccessibility.insert(it->second.begin(), it->second.end());
+        }
+    }
 }
 
 void Tracker::cacheVisibility()
@@ -1279,6 +1579,7 @@ void Tracker::cacheVisibility()
     if (!_visibilityStale)
         return;
     _updatingCache = true;
+    const auto previous = std::move(_visibilityCache);
     _visibilityCache.clear();
     _visibilityStale = false;
 
@@ -1289,7 +1590,7 @@ void Tracker::cacheVisibility()
             if (!location.getVisibilityRules().empty()) { // no need to pre-cache empty
                 auto it = _visibilityCache.find(location.getID());
                 if (it == _visibilityCache.end() || !it->second) {
-                    bool res = resolveRules(location.getVisibilityRules(), true, false) != AccessibilityLevel::NONE;
+                    bool res = resolveRules(location.getCompiledVisibilityRules(), true, false) != AccessibilityLevel::NONE;
                     if (it == _visibilityCache.end()) {
                         _visibilityCache[location.getID()] = res;
                         done = false;
@@ -1307,7 +1608,7 @@ void Tracker::cacheVisibility()
                 auto it = _visibilityCache.find(id);
                 if (it != _visibilityCache.end() && it->second)
                     continue; // nothing to do
-                auto res = resolveRules(section.getVisibilityRules(), true, false) != AccessibilityLevel::NONE;
+                auto res = resolveRules(section.getCompiledVisibilityRules(), true, false) != AccessibilityLevel::NONE;
                 if (it == _visibilityCache.end()) {
                     _visibilityCache[id] = res;
                     done = false;
@@ -1321,6 +1622,21 @@ void Tracker::cacheVisibility()
 
     _updatingCache = false;
     _itemChangesDuringCacheUpdate.clear();
+
+    if (_accessibilityStale || _accessibilityNodes.empty())
+        return; // the next full accessibility update reports all locations
+    std::unordered_set<std::string> changed;
+    for (const auto& [id, visible]: _visibilityCache) {
+        const auto it = previous.find(id);
+        if (it == previous.end() || it->second != visible)
+            addChangedLocation(changed, id);
+    }
+    for (const auto& [id, _]: previous) {
+        if (_visibilityCache.find(id) == _visibilityCache.end())
+            addChangedLocation(changed, id);
+    }
+    if (!changed.empty())
+        onLocationsChanged.emit(this, &changed);
 }
 
 void Tracker::markAsIndirectlyConnected()
@@ -1386,6 +1702,27 @@ json Tracker::saveState() const
     return state;
 }
 
+/// Applies saved item states by stable ID, or by ID for old states. Items are indexed once instead of searched.
+template <class T>
+static void loadItems(std::list<T>& items, json& jItems, const json& jItemIDs)
+{
+    if (jItems.type() != json::value_t::object)
+        return;
+    std::unordered_multimap<std::string, T*> byStableID;
+    std::unordered_multimap<std::string, T*> byID;
+    for (auto& item: items) {
+        byStableID.emplace(item.getStableID(), &item);
+        byID.emplace(item.getID(), &item);
+    }
+    for (auto it = jItems.begin(); it != jItems.end(); ++it) {
+        const auto idIt = jItemIDs.is_object() ? jItemIDs.find(it.key()) : jItemIDs.end();
+        const bool hasStableID = idIt != jItemIDs.end() && idIt->is_string() && !idIt->empty();
+        const auto range = hasStableID ? byStableID.equal_range(idIt->get<std::string>()) : byID.equal_range(it.key());
+        for (auto itemIt = range.first; itemIt != range.second; ++itemIt)
+            itemIt->second->load(it.value());
+    }
+}
+
 bool Tracker::loadState(nlohmann::json& state)
 {
     _providerCountCache.clear();
@@ -1398,59 +1735,19 @@ bool Tracker::loadState(nlohmann::json& state)
     if (j["format_version"] != 1) return false; // incompatible state format
 
     _bulkUpdate = true;
-    auto& jJsonItems = j["json_items"];
-    auto& jJsonItemIDs = j["json_item_ids"];
-    if (jJsonItems.type() == json::value_t::object) {
-        for (auto it = jJsonItems.begin(); it != jJsonItems.end(); ++it) {
-            auto& jStableID = jJsonItemIDs[it.key()];
-            if (jStableID.is_string() && !jStableID.empty()) {
-                auto stableID = jStableID.get<std::string>();
-                for (auto& item: _jsonItems) {
-                    if (item.getStableID() != stableID)
-                        continue;
-                    item.load(it.value());
-                }
-            } else {
-                for (auto& item: _jsonItems) {
-                    if (item.getID() != it.key())
-                        continue;
-                    item.load(it.value());
-                }
-            }
-        }
-    }
-    auto& jLuaItems = j["lua_items"];
-    auto& jLuaItemIDs = j["lua_item_ids"];
-    if (jLuaItems.type() == json::value_t::object) {
-        for (auto it = jLuaItems.begin(); it != jLuaItems.end(); ++it) {
-            auto& jStableID = jLuaItemIDs[it.key()];
-            if (jStableID.is_string() && !jStableID.empty()) {
-                auto stableID = jStableID.get<std::string>();
-                for (auto& item: _luaItems) {
-                    if (item.getStableID() != stableID)
-                        continue;
-                    item.load(it.value());
-                }
-            } else {
-                for (auto& item: _luaItems) {
-                    if (item.getID() != it.key()) continue;
-                    item.load(it.value());
-                }
-            }
-        }
-    }
+    loadItems(_jsonItems, j["json_items"], j["json_item_ids"]);
+    loadItems(_luaItems, j["lua_items"], j["lua_item_ids"]);
     auto& jSections = j["sections"];
     if (jSections.type() == json::value_t::object) {
+        std::unordered_multimap<std::string, LocationSection*> sections;
+        for (auto& loc: _locations) {
+            for (auto& sec: loc.getSections())
+                sections.emplace(sec.getFullID(), &sec);
+        }
         for (auto it = jSections.begin(); it != jSections.end(); ++it) {
-            const std::string& key = it.key();
-            for (auto& loc: _locations) {
-                if (key.rfind(loc.getID(), 0) != 0) continue;
-                for (auto& sec: loc.getSections()) {
-                    if (key != sec.getFullID())
-                        continue;
-                    sec.load(it.value());
-                }
-            }
+            const auto range = sections.equal_range(it.key());
+            for (auto secIt = range.first; secIt != range.second; ++secIt)
+                secIt->second->load(it.value());
         }
     }
 
@@ -4,12 +4,16 @@
 #include <functional>
 #include <list>
 #include <set>
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <luaglue/luainterface.h>
 #include <luaglue/luatype.h>
 #include <nlohmann/json.hpp>
 #include "accessibilitylevel.h"
+#include "codetable.h"
+#include "compiledrules.h"
 #include "jsonitem.h"
 #include "layoutnode.h"
 #include "location.h"
@@ -20,10 +24,12 @@
 #include "signal.h"
 
 
+class PackPreloader;
 class Tracker;
     
 class Tracker final : public LuaInterface<Tracker> {
     friend class LuaInterface;
+    friend class RulesBench; // see bench/core/bench_rules.cpp
 
 public:
     static constexpr int DEFAULT_EXEC_LIMIT = 600000;
@@ -84,6 +90,9 @@ public:
     Signal<const std::string&> onDisplayChanged; // changed display of an item
     Signal<const std::string&, const std::string&> onUiHint;
     Signal<> onBulkUpdateDone;
+    /// IDs of locations whose accessibility or visibility, or that of their sections, changed while updating the
+    /// logic cache. nullptr if any location may have changed.
+    Signal<const std::unordered_set<std::string>*> onLocationsChanged;
 
     const LayoutNode& getLayout(const std::string& name) const;
     bool hasLayout(const std::string& name) const;
@@ -107,12 +116,18 @@ public:
     AccessibilityLevel isReachable(const LocationSection& section);
     bool isVisible(const Location& location);
     bool isVisible(const Location::MapLocation& mapLoc);
+    /// Brings cached accessibility and visibility up to date, see onLocationsChanged.
+    void updateLogic();
 
     bool isBulkUpdate() const;
+    /// Same as setting Tracker.BulkUpdate from Lua. Changes are signalled when setting it back to false.
+    void setBulkUpdate(bool value);
     bool allowDeferredLogicUpdate() const;
     void setAllowDeferredLogicUpdate(bool value);
 
     const Pack* getPack() const;
+    /// Takes pack files from preloader instead of reading and parsing them. Pass nullptr when done loading.
+    void setPreloader(PackPreloader* preloader);
 
     bool changeItemState(const std::string& id, BaseItem::Action action);
 
@@ -123,6 +138,7 @@ public:
 
 protected:
     Pack* _pack;
+    PackPreloader* _preloader = nullptr;
     lua_State *_L; // TODO: get rid of this by providing an interface to access lua globals
     // NOTE: Items and Locations can not be moved in memory when we share them with Lua
     uint64_t _lastItemID=0;
@@ -145,11 +161,30 @@ protected:
     bool _visibilityStale = false;
     bool _linksBlocked = false; // Set by user on declining any more links
     std::vector<std::string_view> _luaCodesStack; ///< stack of $-codes currently being evaluated
-    std::unordered_set<std::string> _indirectlyConnectedLuaCodes; ///< set of $-codes that can not be cached
+    std::unordered_set<std::string> _indirectlyConnectedLuaCodes; ///< set of codes running Lua that can not be cached
     bool _updatingCache = false; ///< true while cache*() is running
     std::set<std::string> _itemChangesDuringCacheUpdate;
     std::map<std::string, std::vector<std::string>> _missingBaseItemConnection;
 
+    // dependency tracking for incremental accessibility updates, see cacheAccessibility()
+    const std::string* _resolvingNode = nullptr; ///< location or section currently resolved by cacheAccessibility
+    std::unordered_map<std::string, std::pair<const Location*, const LocationSection*>> _accessibilityNodes;
+    std::unordered_map<std::string, std::unordered_set<std::string>> _codeDependents; ///< code -> nodes using it
+    std::unordered_map<std::string, std::unordered_set<std::string>> _nodeDependents; ///< node -> nodes using it via @
+    std::unordered_set<std::string> _luaDependents; ///< nodes that ran $-code, invalidated on every change
+    std::unordered_set<std::string> _invalidAccessibility; ///< nodes that have to be resolved again
+    std::unordered_map<std::string, std::unordered_set<std::string>> _luaItemCodes; ///< Lua item ID -> codes it provided
+    std::unordered_set<std::string> _luaProvidedCodes; ///< codes counted from Lua items, which may read any object
+    /// Lua items that can provide a code, see getLuaCodeProviders
+    struct LuaCodeProviders final {
+        std::vector<LuaItem*> items; ///< in creation order
+        uint64_t generation; ///< _luaProvidersGeneration when items was last brought up to date
+    };
+    std::unordered_map<std::string, LuaCodeProviders> _luaCodeProviders; ///< code -> Lua items
+    std::unordered_map<LuaItem*, uint64_t> _changedLuaProviders; ///< Lua item -> generation its CanProvideCode changed at
+    uint64_t _luaProvidersGeneration = 0;
+    std::unordered_set<std::string> _luaItemsToRecheck; ///< Lua item IDs whose CanProvideCode changed since their last onChange
+
     std::map<std::string, std::vector<std::string>> _sectionNameRefs;
     std::map<std::reference_wrapper<const LocationSection>,
              std::vector<std::pair<std::reference_wrapper<const Location>,
@@ -158,15 +193,52 @@ protected:
 
     std::map<std::string, int> _itemStableNameCounter;
 
+    // lookup indexes, maintained when items and locations are added; first added wins like the linear search did
+    CodeTable _itemCodes; ///< codes json items can provide, lower case with JSONITEM_CI_QUIRK
+    std::vector<std::vector<JsonItem*>> _codeProviders; ///< json items by ID in _itemCodes, in load order
+    std::unordered_map<std::string, BaseItem*> _itemsByID;
+    std::unordered_map<std::string, Location*> _locationsByID;
+    std::unordered_map<std::string, Location*> _locationsByName;
+    std::unordered_map<std::string, Location*> _locationsBySuffix; ///< partial IDs that contain a '/'
+    std::unordered_map<std::string, std::pair<Location*, LocationSection*>> _sectionsByID;
+
+    /// Target of an @-rule, resolved on first use since locations may be added after the rule
+    struct RuleReference final {
+        bool resolved = false;
+        Location* location = nullptr; ///< referenced location or parent of referenced section
+        LocationSection* section = nullptr; ///< referenced section or nullptr if referencing a location
+    };
+    CodeTable _ruleCodes; ///< codes used in compiled rules
+    CodeTable _ruleReferenceTargets; ///< location and section IDs used in compiled @-rules
+    std::vector<RuleReference> _ruleReferences; ///< indexed by ID in _ruleReferenceTargets
+
     static int _execLimit;
 
+    /// Reads and parses a pack file, or takes it from the preloader.
+    bool readJson(const std::string& file, nlohmann::json& j);
+    bool addItems(nlohmann::json& j);
+    bool addLocations(nlohmann::json& j);
+    void indexJsonItem(JsonItem& item);
+    void indexLocation(Location& location);
+    CodeTable::ID findItemCode(const std::string& code) const;
+    /// Returns Lua items that can provide code. Memoized per code; only Lua items whose CanProvideCode changed since
+    /// are asked again.
+    /// The list stays valid until _luaProvidersGeneration changes.
+    const std::vector<LuaItem*>& getLuaCodeProviders(const std::string& code);
+    void compileRules(Location& location);
+    /// Evaluates compiled access or visibility rules using the current state.
     AccessibilityLevel resolveRules(
-        const std::list< std::list<std::string> >& rules,
+        const CompiledRules& rules,
         bool visibilityRules,
         bool glitchedScoutableAsGlitched);
-
+    const RuleReference& resolveRuleReference(CodeTable::ID id);
     void rebuildSectionRefs();
     void cacheAccessibility();
+    void updateAccessibility();
+    void recordAccessibilityDependency(const std::string& node);
+    void invalidateAccessibility(const BaseItem& item, bool checkAllCodes);
+    void invalidateLuaDependents();
+    void addChangedLocation(std::unordered_set<std::string>& changed, const std::string& node);
     void cacheVisibility();
     void markAsIndirectlyConnected();
 
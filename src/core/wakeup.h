@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+
+
+/// Lets worker threads wake up the main loop when they have new data for it.
+class Wakeup final {
+public:
+    typedef void (*Callback)();
+
+    /// Set the function that wakes up the main loop. It has to be thread safe.
+    static void setCallback(Callback callback)
+    {
+        _callback = callback;
+    }
+
+    /// Wake up the main loop. Can be called from any thread.
+    static void notify()
+    {
+        if (const auto callback = _callback.load())
+            callback();
+    }
+
+private:
+    static inline std::atomic<Callback> _callback{nullptr};
+};
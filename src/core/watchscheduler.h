@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdint.h>
+#include <vector>
+#include "rangeset.h"
+
+
+/// Watched address ranges grouped by polling interval, with one deadline per group.
+/// Interval 0 stands for the default interval, which can be changed at any time.
+/// Newly added ranges are due right away, without making the rest of their group due.
+class WatchScheduler final {
+public:
+    using clock = std::chrono::steady_clock;
+    using Range = RangeSet::Range;
+
+    /// Adds [start, start+length) to the group of interval ms. Returns true if a byte got added to the group.
+    bool add(uint32_t start, uint32_t length, unsigned interval = 0)
+    {
+        if (!length)
+            return false;
+        if (!_groups[interval].ranges.add(start, length))
+            return false;
+        _fresh.push_back({start, length});
+        return true;
+    }
+
+    /// Removes [start, start+length) from the group of interval ms. Returns true if a byte got removed from the group.
+    bool remove(uint32_t start, uint32_t length, unsigned interval = 0)
+    {
+        auto it = _groups.find(interval);
+        if (it == _groups.end() || !it->second.ranges.remove(start, length))
+            return false;
+        if (it->second.ranges.empty())
+            _groups.erase(it);
+        auto fresh = std::find(_fresh.begin(), _fresh.end(), Range{start, length});
+        if (fresh != _fresh.end())
+            _fresh.erase(fresh);
+        return true;
+    }
+
+    /// Returns true if [start, start+length) is fully in one of the groups.
+    bool contains(uint32_t start, uint32_t length) const
+    {
+        for (const auto& pair: _groups) {
+            if (pair.second.ranges.contains(start, length))
+                return true;
+        }
+        return false;
+    }
+
+    /// Returns the disjoint ranges of all groups, sorted by address.
+    std::vector<Range> ranges() const
+    {
+        RangeSet all;
+        for (const auto& pair: _groups) {
+            for (const auto& range: pair.second.ranges.ranges())
+                all.add(range.start, range.length);
+        }
+        return all.ranges();
+    }
+
+    /// Returns the ranges that are due at now, coalesced like RangeSet::coalesce, and schedules their groups' next
+    /// deadlines. Groups that are not due, but are fully covered by the returned ranges, are scheduled as well, since
+    /// they are read anyway.
+    std::vector<Range> due(clock::time_point now, uint32_t maxGap, uint32_t maxLength)
+    {
+        RangeSet set;
+        std::vector<std::map<unsigned, Group>::iterator> scheduled;
+        for (auto it = _groups.begin(); it != _groups.end(); ++it) {
+            if (it->second.next > now)
+                continue;
+            for (const auto& range: it->second.ranges.ranges())
+                set.add(range.start, range.length);
+            scheduled.push_back(it);
+        }
+        for (const auto& range: _fresh)
+            set.add(range.start, range.length);
+        _fresh.clear();
+        auto plan = set.coalesce(maxGap, maxLength);
+        if (plan.empty())
+            return plan;
+        for (auto it = _groups.begin(); it != _groups.end(); ++it) {
+            if (it->second.next <= now)
+                continue; // due, scheduled above
+            const auto ranges = it->second.ranges.ranges();
+            if (std::all_of(ranges.begin(), ranges.end(), [&plan](const Range& range) {
+                        return covers(plan, range);
+                    }))
+                it->second.next = now + period(it->first);
+        }
+        for (auto it: scheduled)
+            reschedule(it->first, it->second, now);
+        return plan;
+    }
+
+    /// Returns the earliest deadline or clock::time_point::max() if nothing is watched.
+    clock::time_point nextDue() const
+    {
+        if (!_fresh.empty())
+            return clock::time_point::min();
+        auto res = clock::time_point::max();
+        for (const auto& pair: _groups)
+            res = std::min(res, pair.second.next);
+        return res;
+    }
+
+    void setDefaultInterval(unsigned interval)
+    {
+        _defaultInterval = interval;
+    }
+
+    unsigned getDefaultInterval() const
+    {
+        return _defaultInterval;
+    }
+
+    bool empty() const
+    {
+        return _groups.empty();
+    }
+
+    void clear()
+    {
+        _groups.clear();
+        _fresh.clear();
+    }
+
+private:
+    struct Group final {
+        RangeSet ranges;
+        clock::time_point next = clock::time_point::min();
+    };
+
+    /// interval -> ranges polled at that interval
+    std::map<unsigned, Group> _groups;
+    /// ranges added since the last call to due()
+    std::vector<Range> _fresh;
+    unsigned _defaultInterval = 0;
+
+    clock::duration period(unsigned interval) const
+    {
+        return std::chrono::milliseconds(interval ? interval : _defaultInterval);
+    }
+
+    void reschedule(unsigned interval, Group& group, clock::time_point now)
+    {
+        // keep the cadence unless we fell behind by more than one period
+        const auto p = period(interval);
+        group.next = (group.next != clock::time_point::min() && group.next + p > now) ? group.next + p : now + p;
+    }
+
+    /// Returns true if range is inside a single entry or adjacent entries of the sorted plan.
+    static bool covers(const std::vector<Range>& plan, Range range)
+    {
+        auto it = std::upper_bound(plan.begin(), plan.end(), range.start, [](uint32_t addr, const Range& entry) {
+            return addr < entry.start;
+        });
+        if (it == plan.begin())
+            return false;
+        --it;
+        while (it != plan.end() && it->start <= range.start) {
+            if (it->end() >= range.end())
+                return true;
+            if (it->end() <= range.start)
+                return false;
+            range.length = range.end() - it->end();
+            range.start = it->end();
+            ++it;
+        }
+        return false;
+    }
+};
@@ -9,9 +9,84 @@
 #endif
 #include <miniz.c>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "fs.h"
 
 
+/// Read-only memory mapping of a whole file, so entries can be read by multiple threads without seeking.
+class Zip::MappedFile final {
+public:
+    explicit MappedFile(const fs::path& filename)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= SIZE_MAX) {
+            if (HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)) {
+                _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (_data)
+                    _size = static_cast<size_t>(size.QuadPart);
+                CloseHandle(mapping); // the view keeps the mapping alive
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0 && (uint64_t)st.st_size <= SIZE_MAX) {
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                _data = static_cast<const uint8_t*>(p);
+                _size = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        if (!_data)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+#else
+        munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+    }
+
+    const uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+};
+
+static std::string toLower(std::string s)
+{
+    // same as miniz' case-insensitive compare
+    for (auto& c: s)
+        c = static_cast<char>(MZ_TOLOWER(c));
+    return s;
+}
+
+
 Zip::Zip(const fs::path& filename)
     : _zip()
     , _valid(false)
@@ -21,6 +96,10 @@ Zip::Zip(const fs::path& filename)
     if (!mz_zip_reader_init_file(&_zip, filename.u8string().c_str(), 0))
         return;
     _valid = true;
+    _map = std::make_unique<MappedFile>(filename);
+    if (!_map->data() || _map->size() != _zip.m_archive_size)
+        _map.reset(); // fall back to reading through miniz
+    buildIndex();
 }
 
 Zip::Zip(FILE* file)
@@ -32,6 +111,7 @@ Zip::Zip(FILE* file)
     if (!mz_zip_reader_init_cfile(&_zip, file, 0, 0))
         return;
     _valid = true;
+    buildIndex();
 }
 
 Zip::~Zip()
@@ -45,6 +125,109 @@ Zip::~Zip()
     mz_zip_zero_struct(&_zip);
 }
 
+void Zip::buildIndex()
+{
+    const mz_uint count = mz_zip_reader_get_num_files(&_zip);
+    _entries.resize(count);
+    _storedCrc = std::vector<std::atomic<uint8_t>>(count);
+    _index.reserve(count);
+    std::string name;
+    for (mz_uint i = 0; i < count; i++) {
+        auto& entry = _entries[i];
+        mz_zip_archive_file_stat st;
+        if (!mz_zip_reader_file_stat(&_zip, i, &st)) {
+            entry = {0, 0, 0, 0, false, false, false};
+            continue;
+        }
+        entry.offset = st.m_local_header_ofs;
+        entry.compSize = st.m_comp_size;
+        entry.size = st.m_uncomp_size;
+        entry.crc32 = st.m_crc32;
+        entry.isDir = st.m_is_directory;
+        entry.isStored = st.m_method == 0 && st.m_comp_size == st.m_uncomp_size;
+        entry.canInflate = st.m_is_supported && !st.m_is_encrypted && (entry.isStored || st.m_method == MZ_DEFLATED);
+        // m_filename may be truncated, so get the full name
+        const mz_uint len = mz_zip_reader_get_filename(&_zip, i, nullptr, 0);
+        if (len < 1)
+            continue;
+        name.resize(len);
+        mz_zip_reader_get_filename(&_zip, i, name.data(), len);
+        name.resize(len - 1);
+        _index.emplace(toLower(name), i); // first one wins for duplicates
+    }
+}
+
+int64_t Zip::locate(const std::string& name)
+{
+    std::string path;
+    {
+        std::lock_guard lock(_mutex);
+        path = _dir + name;
+        if (_slashes == Slashes::FORWARD) {
+            std::replace(path.begin(), path.end(), '\\', '/');
+        } else if (_slashes == Slashes::BACKWARD) {
+            std::replace(path.begin(), path.end(), '/', '\\');
+        }
+    }
+    const auto it = _index.find(toLower(path));
+    if (it == _index.end())
+        return -1;
+    return it->second;
+}
+
+const uint8_t* Zip::getData(const Entry& entry) const
+{
+    if (!_map)
+        return nullptr;
+    const uint8_t* data = _map->data();
+    const size_t size = _map->size();
+    if (entry.offset > size || size - entry.offset < MZ_ZIP_LOCAL_DIR_HEADER_SIZE)
+        return nullptr;
+    const uint8_t* header = data + entry.offset;
+    if (MZ_READ_LE32(header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+        return nullptr;
+    const uint64_t start = entry.offset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE
+            + MZ_READ_LE16(header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+    if (start > size || size - start < entry.compSize)
+        return nullptr;
+    return data + start;
+}
+
+bool Zip::readStoredFile(const std::string& name, std::string_view& out)
+{
+    if (!_valid || !_map)
+        return false;
+    const auto index = locate(name);
+    if (index < 0)
+        return false;
+    const auto& entry = _entries[index];
+    if (entry.isDir || !entry.isStored || !entry.canInflate || entry.size > std::numeric_limits<size_t>::max())
+        return false;
+    const uint8_t* data = getData(entry);
+    if (!data)
+        return false;
+    // verify once, like extracting through miniz would on every read
+    auto& crc = _storedCrc[index];
+    if (crc == CRC_UNCHECKED)
+        crc = (mz_crc32(MZ_CRC32_INIT, data, static_cast<size_t>(entry.size)) == entry.crc32) ? CRC_OK : CRC_BAD;
+    if (crc != CRC_OK)
+        return false;
+    out = {reinterpret_cast<const char*>(data), static_cast<size_t>(entry.size)};
+    return true;
+}
+
+void Zip::setCacheLimit(size_t bytes)
+{
+    std::lock_guard lock(_cacheMutex);
+    _cacheLimit = bytes;
+    while (_cacheSize > _cacheLimit) {
+        const auto it = _cache.find(_cacheOrder.front());
+        _cacheSize -= it->second.size();
+        _cache.erase(it);
+        _cacheOrder.pop_front();
+    }
+}
+
 void Zip::setDir(const std::string& dir)
 {
     std::lock_guard lock(_mutex);
@@ -141,21 +324,9 @@ std::vector< std::pair<Zip::EntryType,std::string> > Zip::list(const bool recurs
 
 bool Zip::hasFile(const std::string& name)
 {
-    std::lock_guard lock(_mutex);
     if (!_valid)
         return false;
-
-    std::string path = _dir + name;
-    if (_slashes == Slashes::FORWARD) {
-        std::replace(path.begin(), path.end(), '\\', '/');
-    } else if (_slashes == Slashes::BACKWARD) {
-        std::replace(path.begin(), path.end(), '/', '\\');
-    }
-
-    mz_uint32 index = 0;
-    if (mz_zip_reader_locate_file_v2(&_zip, path.c_str(), nullptr, 0, &index) < 1)
-        return false; // no such file
-    return true;
+    return locate(name) >= 0;
 }
 
 bool Zip::readFile(const std::string& name, std::string& out, const size_t limit)
@@ -166,7 +337,6 @@ bool Zip::readFile(const std::string& name, std::string& out, const size_t limit
 
 bool Zip::readFile(const std::string& name, std::string& out, std::string& err, const size_t limit)
 {
-    std::lock_guard lock(_mutex);
     out.clear();
     err.clear();
     if (!_valid) {
@@ -174,41 +344,60 @@ bool Zip::readFile(const std::string& name, std::string& out, std::string& err,
         return false;
     }
 
-    std::string path = _dir + name;
-    if (_slashes == Slashes::FORWARD) {
-        std::replace(path.begin(), path.end(), '\\', '/');
-    } else if (_slashes == Slashes::BACKWARD) {
-        std::replace(path.begin(), path.end(), '/', '\\');
-    }
-
-    mz_uint32 index = 0;
-    if (mz_zip_reader_locate_file_v2(&_zip, path.c_str(), nullptr, 0, &index)<1) {
+    const auto index = locate(name);
+    if (index < 0) {
         err = "No such file in zip";
         return false; // no such file
     }
 
-    mz_zip_archive_file_stat st;
-    if (!mz_zip_reader_file_stat(&_zip, index, &st)) {
-        err = "Could not stat file in zip";
-        return false;
-    }
-
-    if (mz_zip_reader_is_file_a_directory(&_zip, index)) {
+    const auto& entry = _entries[index];
+    if (entry.isDir) {
         err = "Is directory";
         return false;
     }
-
-    if (st.m_uncomp_size > std::numeric_limits<size_t>::max()) {
+    if (entry.size > std::numeric_limits<size_t>::max()) {
         err = "File too big";
         return false;
     }
-    const auto sz = static_cast<size_t>(st.m_uncomp_size);
+    const auto sz = static_cast<size_t>(entry.size);
     if (sz == 0)
         return true; // done. out is cleared above
 
     const size_t toRead = limit && limit < sz ? limit : sz;
+    {
+        std::lock_guard lock(_cacheMutex);
+        const auto it = _cache.find(static_cast<mz_uint32>(index));
+        if (it != _cache.end()) {
+            out.assign(it->second, 0, toRead);
+            return true;
+        }
+    }
+
+    bool res = entry.canInflate && getData(entry)
+            ? readMapped(static_cast<mz_uint32>(index), out, err, toRead)
+            : readLocked(static_cast<mz_uint32>(index), out, err, toRead);
+
+    if (res && toRead == sz && !entry.isStored) {
+        std::lock_guard lock(_cacheMutex);
+        if (sz <= _cacheLimit / 8 && _cache.emplace(static_cast<mz_uint32>(index), out).second) {
+            _cacheOrder.push_back(static_cast<mz_uint32>(index));
+            _cacheSize += sz;
+            while (_cacheSize > _cacheLimit) {
+                const auto it = _cache.find(_cacheOrder.front());
+                _cacheSize -= it->second.size();
+                _cache.erase(it);
+                _cacheOrder.pop_front();
+            }
+        }
+    }
+    return res;
+}
+
+static bool resizeOutput(std::string& out, std::string& err, size_t size)
+{
     try {
-        out.resize(toRead);
+        out.resize(size);
+        return true;
     } catch (const std::bad_alloc&) {
         // NOTE: sadly we can not test this with libFuzzer + ASAN:
         //       ASAN_OPTIONS=allocator_may_return_null=1:soft_rss_limit_mb=1024
@@ -217,7 +406,50 @@ bool Zip::readFile(const std::string& name, std::string& out, std::string& err,
         err = "Out of memory";
         return false;
     }
-    if (toRead == sz) {
+}
+
+bool Zip::readMapped(const mz_uint32 index, std::string& out, std::string& err, const size_t toRead)
+{
+    // runs without lock; only touches immutable members and the mapping
+    const auto& entry = _entries[index];
+    const uint8_t* data = getData(entry);
+    if (entry.isStored) {
+        out.assign(reinterpret_cast<const char*>(data), toRead);
+        if (toRead == entry.size && mz_crc32(MZ_CRC32_INIT, data, toRead) != entry.crc32) {
+            out.clear();
+            err = "CRC-32 check failed";
+            return false;
+        }
+        return true;
+    }
+
+    if (!resizeOutput(out, err, toRead))
+        return false;
+    auto inflator = std::make_unique<tinfl_decompressor>(); // too big for small stacks
+    tinfl_init(inflator.get());
+    size_t inSize = static_cast<size_t>(entry.compSize);
+    size_t outSize = toRead;
+    auto* dst = reinterpret_cast<mz_uint8*>(out.data());
+    const tinfl_status status = tinfl_decompress(inflator.get(), data, &inSize, dst, dst, &outSize,
+            TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    if (toRead == entry.size) {
+        if (status == TINFL_STATUS_DONE && outSize == toRead
+                && mz_crc32(MZ_CRC32_INIT, dst, outSize) == entry.crc32)
+            return true;
+    } else if ((status == TINFL_STATUS_DONE || status == TINFL_STATUS_HAS_MORE_OUTPUT) && outSize == toRead) {
+        return true;
+    }
+    out.clear();
+    err = status == TINFL_STATUS_DONE ? "CRC-32 check failed" : "Decompression failed";
+    return false;
+}
+
+bool Zip::readLocked(const mz_uint32 index, std::string& out, std::string& err, const size_t toRead)
+{
+    std::lock_guard lock(_mutex);
+    if (!resizeOutput(out, err, toRead))
+        return false;
+    if (toRead == _entries[index].size) {
         if (mz_zip_reader_extract_to_mem(&_zip, index, out.data(), toRead, 0))
             return true;
     } else {
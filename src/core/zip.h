@@ -2,8 +2,13 @@
 
 #define MINIZ_NO_ZLIB_APIS
 #include <miniz.h>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -26,6 +31,12 @@ public:
     bool hasFile(const std::string& name);
     bool readFile(const std::string& name, std::string& out, size_t limit=0);
     bool readFile(const std::string& name, std::string& out, std::string& err, size_t limit=0);
+    /// Returns a view into the memory-mapped archive if the file is stored uncompressed. Valid as long as the Zip.
+    /// The CRC is verified on first access. NOTE: if the archive is truncated while open, reading the view raises
+    /// SIGBUS (or an access violation on Windows) rather than failing like readFile.
+    bool readStoredFile(const std::string& name, std::string_view& out);
+    /// Enables caching of decompressed files up to a total of bytes. Files bigger than 1/8 of that are not cached.
+    void setCacheLimit(size_t bytes);
 
     bool isValid() const
     {
@@ -42,11 +53,50 @@ private:
     friend Zip::Slashes  operator| (Zip::Slashes,  Zip::Slashes);
     friend Zip::Slashes& operator|=(Zip::Slashes&, Zip::Slashes);
 
+    /// Central directory info needed to read a file without touching _zip.
+    struct Entry final {
+        uint64_t offset; // of local header
+        uint64_t compSize;
+        uint64_t size;
+        uint32_t crc32;
+        bool isDir;
+        bool isStored;
+        bool canInflate; // stored or deflated and not encrypted
+    };
+
+    class MappedFile;
+
+    void buildIndex();
+    /// Returns index of the file or -1. Applies setDir and slashes.
+    int64_t locate(const std::string& name);
+    /// Returns pointer to the data of the entry inside the mapping or nullptr.
+    const uint8_t* getData(const Entry& entry) const;
+    bool readMapped(mz_uint32 index, std::string& out, std::string& err, size_t limit);
+    bool readLocked(mz_uint32 index, std::string& out, std::string& err, size_t limit);
+
     mz_zip_archive _zip;
     std::mutex _mutex; // zip operations set m_last_error, so we need a lock everywhere
     bool _valid;
     Slashes _slashes;
     std::string _dir;
+
+    // immutable after construction, so they can be used without lock
+    std::unique_ptr<MappedFile> _map;
+    std::vector<Entry> _entries;
+    std::unordered_map<std::string, mz_uint32> _index; // lower-case name -> index, like miniz' lookup
+
+    enum CrcState : uint8_t {
+        CRC_UNCHECKED = 0,
+        CRC_OK,
+        CRC_BAD,
+    };
+    std::vector<std::atomic<uint8_t>> _storedCrc; // CrcState of the mapped data by index, see readStoredFile
+
+    std::mutex _cacheMutex;
+    size_t _cacheLimit = 0;
+    size_t _cacheSize = 0;
+    std::unordered_map<mz_uint32, std::string> _cache;
+    std::deque<mz_uint32> _cacheOrder; // oldest first
 };
 
 inline Zip::Slashes operator|(Zip::Slashes a, Zip::Slashes b)
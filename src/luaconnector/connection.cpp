@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "message.h"
 #include "tsqueue.h"
+#include "../core/wakeup.h"
 
 #include <stdio.h>
 
@@ -255,6 +256,7 @@ void Connection::AddToIncomingMessageQueue()
 {
     // Add complete message to server's incoming message queue
     _qMessagesIn.push_back(_msgTemporaryIn);
+    Wakeup::notify();
 
     // register next async task
     ReadHeaderAsync();
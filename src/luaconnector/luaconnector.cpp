@@ -18,6 +18,7 @@ LuaConnector::LuaConnector(const std::string& name, optional<std::string> defaul
     printf("LuaConnector(%s)\n", sanitize_print(name).c_str());
     _appname = name;
     _defaultDomain = std::move(defaultDomain);
+    _watches.setDefaultInterval((unsigned)_watchRefreshMilliseconds);
 }
 
 LuaConnector::~LuaConnector()
@@ -73,21 +74,14 @@ bool LuaConnector::update()
         // Process incoming messages, send keepalive
         data_changed |= _server->Update();
 
-        // Update watched memory
-        if (_server->ClientIsConnected()
-            && _lastWatchCheck + std::chrono::milliseconds(_watchRefreshMilliseconds) < std::chrono::system_clock::now()) {
-
-            if (_recalculateWatches) {
-                recalculate_watches();
-                _recalculateWatches = false;
-            }
-
-            for (auto& w : _watches) // use _combinedWatches in prod
+        // Update watched memory that is due
+        const auto now = WatchScheduler::clock::now();
+        if (_server->ClientIsConnected() && _watches.nextDue() <= now) {
+            // watches closer than WATCH_COMBINE_DISTANCE are read in one go
+            for (auto& w : _watches.due(now, WATCH_COMBINE_DISTANCE, MAX_READ_BLOCK_SIZE))
             {
-                _server->ReadBlockBufferedAsync(w.first, w.second, _defaultDomain);
+                _server->ReadBlockBufferedAsync(w.start, w.length, _defaultDomain);
             }
-
-            _lastWatchCheck = std::chrono::system_clock::now();
         }
 
         if( data_changed )
@@ -119,30 +113,33 @@ void LuaConnector::clearCache()
     _data.clear();
 }
 
-void LuaConnector::addWatch(uint32_t address, unsigned int length)
+bool LuaConnector::takeDirtyRanges(std::vector<RangeSet::Range>& out)
 {
-    //printf("addWatch\n");
-    address = mapAddress(address);
-
-    for (auto& w : _watches) {
-        if (w.first == address && w.second == length)
-            return;
+    if (!_server) {
+        out.clear();
+        return true;
     }
+    _server->TakeDirtyRanges(out);
+    return true;
+}
 
-    _watches.push_back(std::make_pair(address, length));
-    _recalculateWatches = true;
+void LuaConnector::addWatch(uint32_t address, unsigned int length, unsigned interval)
+{
+    //printf("addWatch\n");
+    address = mapAddress(address);
+    _watches.add(address, length, interval);
 }
 
-void LuaConnector::removeWatch(uint32_t address, unsigned int length)
+void LuaConnector::removeWatch(uint32_t address, unsigned int length, unsigned interval)
 {
     address = mapAddress(address);
-    _watches.erase(std::remove(_watches.begin(), _watches.end(), std::make_pair(address, length)));
-    _recalculateWatches = true;
+    _watches.remove(address, length, interval);
 }
 
 void LuaConnector::setWatchUpdateInterval(size_t interval)
 {
     _watchRefreshMilliseconds = interval;
+    _watches.setDefaultInterval((unsigned)interval);
 }
 
 void LuaConnector::setMapping([[maybe_unused]] const std::set<std::string>& flags)
@@ -234,70 +231,5 @@ uint16_t LuaConnector::readU16Live(uint32_t address, uint32_t offset)
 }
 #endif
 
-// returns watches combined
-std::vector<Watch> LuaConnector::combine_watches(std::vector<Watch> src, bool& bChanged)
-{
-    bChanged = false;
-    uint32_t match_distance = 0xFF;
-
-    Watchlist out;
-
-    // for each watch
-    for (auto& w : src) {
-        bool matched = false;
-
-        uint32_t w_begin = w.first;
-        uint32_t w_end = w.first + w.second;
-
-        // find a combined watch that's close to it
-        for (auto& c : out) {
-            uint32_t c_begin = c.first;
-            uint32_t c_end = c.first + c.second;
-
-            // we are near the end of combined watch
-            uint32_t gap = w_begin - c_end;
-            if (gap < match_distance) {
-                // extend end of combined watch to encompass us
-                c.second += gap + w.second;
-
-                matched = true;
-                bChanged = true;
-            }
-
-            // we are near the start of combined watch
-            gap = c_begin - w_end;
-            if (gap < match_distance) {
-                // extend beginning of combined watch to encompass us
-                c.first -= gap - w.second;
-                c.second += gap + w.second;
-
-                matched = true;
-                bChanged = true;
-            }
-        }
-
-        // did not match
-        if (!matched) {
-            out.push_back(w);
-        }
-    }
-
-    return out;
-}
-
-void LuaConnector::recalculate_watches()
-{
-    printf("Recalculating watches\n");
-
-    _combinedWatches.clear();
-    Watchlist w = _watches;
-
-    bool changed = true;
-    while (changed)
-        w = combine_watches(w, changed);
-
-    _combinedWatches = w;
-}
-
 } // namespace LuaConnector
 
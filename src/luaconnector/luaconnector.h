@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <string>
 #include "../core/tsbuffer.h"
+#include "../core/watchscheduler.h"
 #include <chrono>
 
 #if (defined __cplusplus && __cplusplus >= 201703L) || (defined __has_include && __has_include(<optional>))
@@ -18,9 +19,6 @@ namespace Net {
 class Server;
 }
 
-typedef std::pair<uint32_t, unsigned int> Watch;
-typedef std::vector<Watch> Watchlist;
-
 class LuaConnector : public IAutotrackProvider {
 public:
 #if defined __cpp_lib_optional
@@ -45,9 +43,10 @@ public:
     bool isConnected() override;
 
     void clearCache() override;
+    bool takeDirtyRanges(std::vector<RangeSet::Range>& out) override;
 
-    void addWatch(uint32_t address, unsigned int length) override;
-    void removeWatch(uint32_t address, unsigned int length) override;
+    void addWatch(uint32_t address, unsigned int length, unsigned interval = 0) override;
+    void removeWatch(uint32_t address, unsigned int length, unsigned interval = 0) override;
     void setWatchUpdateInterval(size_t interval) override;
 
     void setMapping(const std::set<std::string>& flags) override;
@@ -63,9 +62,6 @@ public:
 
 private:
 
-    std::vector<Watch> combine_watches(std::vector<Watch> src, bool& bChanged);
-    void recalculate_watches();
-
     Net::Server* _server = nullptr;
 
     std::string _appname;
@@ -73,13 +69,13 @@ private:
 
     tsbuffer<uint8_t> _data;
 
-    std::chrono::time_point<std::chrono::system_clock> _lastWatchCheck;
-    Watchlist _watches;
-    Watchlist _combinedWatches;
-    bool _recalculateWatches = true;
+    WatchScheduler _watches; ///< interval 0 uses _watchRefreshMilliseconds
     optional<std::string> _defaultDomain;
 
     uint64_t _watchRefreshMilliseconds = 1500;
+
+    static constexpr uint32_t WATCH_COMBINE_DISTANCE = 0xFF; ///< max gap between watches read in one block
+    static constexpr uint32_t MAX_READ_BLOCK_SIZE = 0x1000;
 };
 
 } // namespace LuaConnector
@@ -13,6 +13,18 @@ struct MessageHeader {
     uint32_t size = 0;
 };
 
+/// Binary message bodies start with a 0 byte instead of the '{' of json, followed by
+/// uint8 type, 2 reserved bytes, uint32 address and uint32 length in network byte order and the raw data.
+/// Only READ_BLOCK replies use it. Connectors announce support with "binary": true in a json message, after which
+/// the server requests them by adding "binary": true to the json request.
+struct BinaryHeader {
+    static constexpr size_t SIZE = 12;
+
+    uint8_t type = 0;
+    uint32_t address = 0;
+    uint32_t length = 0;
+};
+
 struct Message {
     using json = nlohmann::json;
 
@@ -67,6 +79,30 @@ struct Message {
         return j;
     }
 
+    bool IsBinary() const
+    {
+        return !body.empty() && body[0] == 0;
+    }
+
+    // Parses the header of a binary message. Returns false if the message is too short.
+    bool GetBinaryHeader(BinaryHeader& out) const
+    {
+        if (!IsBinary() || body.size() < BinaryHeader::SIZE)
+            return false;
+        uint32_t address, length;
+        std::memcpy(&address, body.data() + 4, sizeof(address));
+        std::memcpy(&length, body.data() + 8, sizeof(length));
+        out.type = body[1];
+        out.address = ntohl(address);
+        out.length = ntohl(length);
+        return body.size() - BinaryHeader::SIZE >= out.length;
+    }
+
+    const uint8_t* GetBinaryData() const
+    {
+        return body.data() + BinaryHeader::SIZE;
+    }
+
     std::size_t size() const
     {
         return sizeof(MessageHeader) + body.size();
@@ -9,6 +9,7 @@
 #include <chrono>
 #include "message.h"
 #include "connection.h"
+#include "../core/wakeup.h"
 
 #include <websocketpp/base64/base64.hpp>
 #include <stdio.h>
@@ -84,10 +85,24 @@ bool Server::Update()
     while (!_qMessagesIn.empty()) {
         auto msg = _qMessagesIn.pop_front();
 
+        if (msg.IsBinary()) {
+            data_changed |= updateBuffer(msg);
+            continue;
+        }
+
         json body = msg.GetJson();
 
         //printf("LuaConnector: Receiving message: %s\n", body.dump().c_str());
 
+        if (!_binaryBlocks && body.is_object()) {
+            // connectors announce binary block replies in any json message
+            const auto it = body.find("binary");
+            if (it != body.end() && it->is_boolean() && it->get<bool>()) {
+                _binaryBlocks = true;
+                printf("LuaConnector: Using binary block reads\n");
+            }
+        }
+
         data_changed |= updateBuffer(body);
     }
 
@@ -101,6 +116,12 @@ bool Server::Update()
     return data_changed;
 }
 
+void Server::TakeDirtyRanges(std::vector<RangeSet::Range>& out)
+{
+    out.swap(_dirtyRanges);
+    _dirtyRanges.clear();
+}
+
 #ifdef LUACONNECTOR_NOASYNC
 bool Server::ReadByteBuffered(uint32_t address, optional<std::string> domain)
 {
@@ -188,6 +209,8 @@ void Server::ReadBlockBufferedAsync(uint32_t address, uint32_t length, optional<
     body["type"] = READ_BLOCK;
     body["address"] = address;
     body["value"] = length;
+    if (_binaryBlocks)
+        body["binary"] = true; // reply without json and base64
     if (domain.has_value())
         body["domain"] = domain.value();
 
@@ -238,6 +261,7 @@ void Server::waitForClientConnectionAsync()
                         _connection->ConnectToClient(_idCounter++);
 
                         onClientConnect();
+                        Wakeup::notify();
                     }
                     catch (const std::exception& e) {
                         printf("LuaConnector: Exception: %s\n", e.what());
@@ -311,6 +335,7 @@ void Server::messageClientAsync(const Message& msg)
 
 void Server::onClientConnect()
 {
+    _binaryBlocks = false; // until the new connector announces it
     //print_message("Connected to PopTracker"); // say hello
 }
 
@@ -332,12 +357,28 @@ bool Server::updateBuffer(const json& response)
 
         //printf("LuaConnector: Update cache at %x: %s\n", address, buffer.c_str());
 
-        return _data.write(address, length, buffer.c_str());
+        if (buffer.size() < length)
+            length = buffer.size();
+        return _data.write(address, length, buffer.c_str(), &_dirtyRanges);
     }
 
     return false;
 }
 
+bool Server::updateBuffer(const Message& msg)
+{
+    BinaryHeader header;
+    if (!msg.GetBinaryHeader(header)) {
+        printf("LuaConnector: Invalid binary message\n");
+        return false;
+    }
+
+    if (header.type == READ_BLOCK)
+        return _data.write(header.address, header.length, (const char*)msg.GetBinaryData(), &_dirtyRanges);
+
+    return false;
+}
+
 } // namespace Net
 
 } // namespace LuaConnector
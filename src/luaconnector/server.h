@@ -1,6 +1,8 @@
 #pragma once
 
+#include "../core/rangeset.h"
 #include "../core/tsbuffer.h"
+#include <atomic>
 #include <string>
 #include <stdint.h>
 #include <nlohmann/json.hpp>
@@ -8,6 +10,7 @@
 #include <thread>
 #include <memory>
 #include <chrono>
+#include <vector>
 #include "message.h"
 #include "connection.h"
 
@@ -73,6 +76,9 @@ public:
     // Returns true if we changed the buffer.
     bool Update();
 
+    // Moves the address ranges changed by Update since the last call into out.
+    void TakeDirtyRanges(std::vector<RangeSet::Range>& out);
+
     // Client commands
 
      // Do nothing, useful for keepalive
@@ -141,12 +147,17 @@ protected:
 
     // Returns true if data was changed.
     bool updateBuffer(const json&);
+    // Same for binary messages.
+    bool updateBuffer(const Message&);
 
     bool _isListening = false;
 
     uint16_t _CONNECTORLIB_PORT = 43884;
 
     tsbuffer<uint8_t>& _data;
+    std::vector<RangeSet::Range> _dirtyRanges;
+    // connected connector replied with "binary": true, so block reads request binary replies
+    std::atomic<bool> _binaryBlocks = false;
 
 #ifndef LUACONNECTOR_NOASYNC
     // Async message queue
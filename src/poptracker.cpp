@@ -12,6 +12,7 @@
 #include "core/jsonutil.h"
 #include "core/statemanager.h"
 #include "core/log.h"
+#include "core/packpreloader.h"
 #include "http/http.h"
 #include "ap/archipelago.h"
 #include <luaglue/luaenum.h>
@@ -19,6 +20,7 @@
 #include "uilib/imghelper.h"
 #include "ui/maptooltip.h"
 #include "core/fs.h"
+#include <algorithm>
 #ifdef _WIN32
 #include <windows.h>
 #include <shellapi.h>
@@ -217,6 +219,8 @@ PopTracker::PopTracker([[maybe_unused]] int argc, [[maybe_unused]] char** argv,
         _config["show_always_on_top_button"] = nullptr;
     if (_config["ignore_hidpi"].type() != json::value_t::boolean)
         _config["ignore_hidpi"] = false;
+    if (_config["binary_state"].type() != json::value_t::boolean)
+        _config["binary_state"] = false;
 
     if (!cli) {
         // enable logging
@@ -377,6 +381,7 @@ PopTracker::PopTracker([[maybe_unused]] int argc, [[maybe_unused]] char** argv,
         Pack::addOverrideSearchPath(appPath / "user-override"); // portable/system overrides
         Assets::addSearchPath(appPath / "assets"); // system assets
     }
+    Pack::setCatalogFile(getConfigPath(APPNAME, "pack-catalog.json", _isPortable));
 
     _asio = new asio::io_service();
     HTTP::certFile = asset("cacert.pem").u8string(); // https://curl.se/docs/caextract.html
@@ -413,6 +418,7 @@ PopTracker::PopTracker([[maybe_unused]] int argc, [[maybe_unused]] char** argv,
 #endif
 
     StateManager::setDir(getConfigPath(APPNAME, "saves", _isPortable));
+    StateManager::setBinary(_config["binary_state"]);
 }
 
 PopTracker::~PopTracker()
@@ -945,12 +951,36 @@ bool PopTracker::start()
     return (_win != nullptr);
 }
 
+unsigned PopTracker::getMaxIdleTime(std::chrono::steady_clock::time_point now)
+{
+    // returns how long the main loop can block before something other than input or a backend thread needs it
+    if (!_newPack.empty())
+        return 0;
+    if (_asioBusy)
+        return 0; // http requests are polled
+    unsigned res = MAX_IDLE_TIME;
+    if (_scriptHost) {
+        if (_scriptHost->needsFrames())
+            return 0;
+        auto at = _scriptHost->getAutoTracker();
+        if (at && at->needsPolling())
+            res = std::min(res, POLL_INTERVAL);
+    }
+    if (_tracker && AUTOSAVE_INTERVAL > 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _autosaveTimer).count();
+        auto remaining = (long long)AUTOSAVE_INTERVAL * 1000 - (long long)elapsed;
+        res = (remaining <= 0) ? 0 : (unsigned)std::min<long long>(res, remaining);
+    }
+    return res;
+}
+
 bool PopTracker::frame()
 {
     if (_asio) {
         _asio->poll();
         // when all tasks are done, poll() will stop(). Reset for next request.
-        if (_asio->stopped()) _asio->restart();
+        _asioBusy = !_asio->stopped();
+        if (!_asioBusy) _asio->restart();
     }
     if (_scriptHost) {
         _scriptHost->onFrame();
@@ -980,14 +1010,18 @@ bool PopTracker::frame()
     td = std::chrono::duration_cast<std::chrono::milliseconds>(now - _fpsTimer).count();
     if (td >= 5000) {
         unsigned f = _frames*1000; f/=td;
+        const uint64_t framesSkipped = _ui->getFramesSkipped();
         if (_debugFlags.count("fps") || _maxFrameTime > 1000)
-            printf("FPS:%4u (max %2dms)\n", f, _maxFrameTime);
+            printf("FPS:%4u (max %2dms, %u window frames skipped)\n", f, _maxFrameTime,
+                    (unsigned)(framesSkipped - _framesSkipped));
+        _framesSkipped = framesSkipped;
         _frames = 0;
         _fpsTimer = now;
         _maxFrameTime = 0;
     }
 #endif
     _frames++;
+    _ui->setMaxIdleTime(getMaxIdleTime(now));
     bool res = _ui->render();
     
     if (!res) {
@@ -1042,7 +1076,8 @@ bool PopTracker::frame()
         };
         if (!jWindow.is_null())
             extra["window"] = jWindow;
-        StateManager::saveState(_tracker, _scriptHost, _win->getHints(), extra, true);
+        if (_autosaver)
+            _autosaver->saveIfChanged(_win->getHints(), extra);
         _autosaveTimer = std::chrono::steady_clock::now();
     }
 
@@ -1151,8 +1186,10 @@ void PopTracker::unloadTracker()
         };
         if (!jWindow.is_null())
             extra["window"] = jWindow;
-        StateManager::saveState(_tracker, _scriptHost, _win->getHints(), extra, true);
+        if (_autosaver)
+            _autosaver->save(_win->getHints(), extra);
     }
+    _autosaver.reset(); // waits for the last write
 
     // remove references before deleting _tracker
     if (_win) _win->setTracker(nullptr);
@@ -1186,8 +1223,19 @@ void PopTracker::unloadTracker()
 
 bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, bool loadAutosave)
 {
+    const auto loadStart = std::chrono::steady_clock::now();
+    auto stageStart = loadStart;
+    // log time spent per stage, so pack authors can see where time goes
+    auto endStage = [&stageStart](const char* stage) {
+        const auto now = std::chrono::steady_clock::now();
+        printf("Timing: %s took %.1fms\n", stage,
+                std::chrono::duration<double, std::milli>(now - stageStart).count());
+        stageStart = now;
+    };
+
     printf("Cleaning up...\n");
     unloadTracker();
+    endStage("cleanup");
     
     printf("Loading Pack...\n");
     _pack = new Pack(pack);
@@ -1209,11 +1257,16 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
         _pack = nullptr;
         return false;
     }
+    endStage("opening pack");
+
+    // read and parse json and image headers in the background while Lua is running
+    auto preloader = std::make_unique<PackPreloader>(_pack);
     
     printf("Creating Lua State...\n");
     _L = luaL_newstate();
     if (!_L || !lua_checkstack(_L, 3)) {
         fprintf(stderr, "Error creating Lua State!\n");
+        preloader.reset();
         delete _pack;
         _pack = nullptr;
         return false;
@@ -1263,6 +1316,7 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
 
     printf("Loading Tracker...\n");
     _tracker = new Tracker(_pack, _L);
+    _tracker->setPreloader(preloader.get());
     // set tracker defaults from settings.json and TargetPopTrackerVersion
     const auto& settings = _pack->getSettings();
     auto itAllowDeferredLogicUpdate = settings.find("allow_deferred_logic_update");
@@ -1301,7 +1355,7 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
         auto ap = at->getAP();
         if (ap) {
             printf("Creating Archipelago Interface...\n");
-            _archipelago = new Archipelago(_L, ap);
+            _archipelago = new Archipelago(_L, ap, _tracker);
             printf("Registering in Lua...\n");
             Archipelago::Lua_Register(_L);
             _archipelago->Lua_Push(_L);
@@ -1382,6 +1436,7 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
         }
     }
     lua_setglobal(_L, "DEBUG");
+    endStage("setting up Lua");
 
     if (loadAutosave) {
         // restore window size before loading any layout
@@ -1431,11 +1486,16 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
         _tracker->AddMaps("maps.json");
     if (_pack->hasFile("locations.json"))
         _tracker->AddLocations("locations.json");
+    endStage("updating UI and loading legacy files");
 
     // run pack's init script
     printf("Running init...\n");
     bool res = _scriptHost->LoadScript("scripts/init.lua");
     _tracker->updateLuaStableIDs();
+    endStage("running init.lua");
+    _tracker->setPreloader(nullptr);
+    preloader.reset(); // drops unused files and image sizes that did not start yet
+    endStage("finishing preload");
     // save reset-state
     StateManager::saveState(_tracker, _scriptHost, _win->getHints(), json::value_t::null, false, "reset");
     if (loadAutosave) {
@@ -1448,7 +1508,11 @@ bool PopTracker::loadTracker(const fs::path& pack, const std::string& variant, b
                 _atSlot = extra["at_slot"];
         }
     }
+    endStage("restoring state");
+    printf("Timing: loading pack took %.1fms\n",
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count());
 
+    _autosaver.reset(new Autosaver(_tracker));
     _autosaveTimer = std::chrono::steady_clock::now();
 
     // check for updates
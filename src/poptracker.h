@@ -11,6 +11,7 @@
 #include "core/pack.h"
 #include "core/tracker.h"
 #include "core/scripthost.h"
+#include "core/autosaver.h"
 #include "core/imagereference.h"
 #include "core/version.h"
 #include "ap/archipelago.h"
@@ -18,6 +19,7 @@
 #include "packmanager/packmanager.h"
 #include "luasandbox/luapackio.h"
 #include <chrono>
+#include <memory>
 #include <nlohmann/json.hpp>
 
 class PopTracker final : public App {
@@ -42,6 +44,7 @@ private:
     bool _autoTrackerAllDisabled = false;
     std::map<std::string, bool> _autoTrackerDisabled;
     asio::io_service *_asio = nullptr;
+    bool _asioBusy = false; ///< _asio had pending work after the last poll
     std::list<std::string> _httpDefaultHeaders;
     PackManager *_packManager = nullptr;
 #ifndef WITHOUT_UPDATE_CHECK
@@ -57,6 +60,7 @@ private:
 
     unsigned _frames = 0;
     unsigned _maxFrameTime = 0;
+    uint64_t _framesSkipped = 0;
     std::chrono::steady_clock::time_point _fpsTimer;
     std::chrono::steady_clock::time_point _frameTimer;
     
@@ -64,6 +68,7 @@ private:
     std::string _newVariant;
     bool _newTrackerLoadAutosave = false;
     std::chrono::steady_clock::time_point _autosaveTimer;
+    std::unique_ptr<Autosaver> _autosaver;
 
     std::string _atUri, _atSlot, _atPassword;
     bool _apConnectPending = false;
@@ -98,10 +103,13 @@ public:
     static constexpr const char VERSION_STRING[] = APP_VERSION_STRING;
     static const Version VERSION;
     static constexpr int AUTOSAVE_INTERVAL = 60; // 1 minute
+    static constexpr unsigned POLL_INTERVAL = 20; // ms between frames while a main thread backend is active
+    static constexpr unsigned MAX_IDLE_TIME = 1000; // ms the main loop may sleep when there is nothing to do
 
 protected:
     virtual bool start();
     virtual bool frame();
+    unsigned getMaxIdleTime(std::chrono::steady_clock::time_point now);
 };
 
 #endif // _POPTRACKER_H
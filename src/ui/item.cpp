@@ -5,6 +5,7 @@
 #include "../uilib/colorhelper.h"
 #include "../uilib/imghelper.h"
 #include "../uilib/textutil.h"
+#include "../uilib/texturemanager.h"
 
 
 namespace Ui {
@@ -18,14 +19,21 @@ Item::Item(int x, int y, int w, int h, FONT font)
 Item::~Item()
 {
     clearImageOverride();
-    for (auto& texset : _texs) for (auto& tex : texset) if (tex) SDL_DestroyTexture(tex);
+    for (auto& texset : _texs) for (auto& tex : texset) destroyTexture(tex);
     for (auto& surfset : _surfs) for (auto& surf : surfset) if (surf) SDL_FreeSurface(surf);
 }
 
 void Item::setStage(int stage1, int stage2)
 {
-    if (stage1>=0) _stage1 = stage1;
-    if (stage2>=0) _stage2 = stage2;
+    if (stage1 < 0)
+        stage1 = _stage1;
+    if (stage2 < 0)
+        stage2 = _stage2;
+    if (stage1 == _stage1 && stage2 == _stage2)
+        return;
+    _stage1 = stage1;
+    _stage2 = stage2;
+    markDirty();
 }
 
 void Item::freeStage(int stage1, int stage2)
@@ -35,7 +43,7 @@ void Item::freeStage(int stage1, int stage2)
         _surfs[stage1][stage2] = nullptr;
     }
     if ((int)_texs.size() > stage1 && (int)_texs[stage1].size() > stage2) {
-        SDL_DestroyTexture(_texs[stage1][stage2]);
+        destroyTexture(_texs[stage1][stage2]);
         _texs[stage1][stage2] = nullptr;
     }
     if ((int)_names.size() > stage1 && (int)_names[stage1].size() > stage2) {
@@ -46,6 +54,28 @@ void Item::freeStage(int stage1, int stage2)
     }
     if (static_cast<int>(_futures.size()) > stage1 && static_cast<int>(_futures[stage1].size()) > stage2)
         _futures[stage1][stage2].reset();
+    if (stage1 == _stage1 && stage2 == _stage2)
+        markDirty();
+}
+
+void Item::destroyTexture(SDL_Texture* tex)
+{
+    if (!tex)
+        return;
+    if (!_texRenderer || !TextureManager::release(_texRenderer, tex))
+        SDL_DestroyTexture(tex);
+}
+
+std::string Item::getTextureKey(int stage1, int stage2) const
+{
+    // returns an empty string for stages that can not be shared
+    if (_imageScope.empty() || (int)_names.size() <= stage1 || (int)_names[stage1].size() <= stage2
+            || _names[stage1][stage2].empty())
+        return {};
+    static const std::list<ImageFilter> noFilters;
+    const auto& filters = ((int)_filters.size() > stage1 && (int)_filters[stage1].size() > stage2)
+            ? _filters[stage1][stage2] : noFilters;
+    return TextureManager::makeKey(_imageScope + "\x1f" + _names[stage1][stage2], filters, _quality);
 }
 
 static SDL_Surface* updateSurface(SDL_Surface* surf, const std::list<ImageFilter>& filters)
@@ -72,6 +102,21 @@ static SDL_Surface* updateSurface(SDL_Surface* surf, const std::list<ImageFilter
     return surf;
 }
 
+static SDL_Surface* processSurface(SDL_Surface* surf, const std::list<ImageFilter>& filters)
+{
+    surf = updateSurface(surf, filters);
+    for (const auto& filter: filters)
+        surf = filter.apply(surf);
+    return surf;
+}
+
+static ImageFuture::Processor makeProcessor(const std::list<ImageFilter>& filters)
+{
+    return [filters](SDL_Surface* surf) {
+        return processSurface(surf, filters);
+    };
+}
+
 void Item::updateSize(const Size size)
 {
     // store size
@@ -111,6 +156,8 @@ void Item::addStage(const int stage1, const int stage2, SDL_Surface* surf, const
     _surfs[stage1][stage2] = surf;
     _names[stage1][stage2] = name;
     _filters[stage1][stage2] = filters;
+    if (stage1 == _stage1 && stage2 == _stage2)
+        markDirty();
 }
 
 void Item::addStage(const int stage1, const int stage2, const char *path, const std::list<ImageFilter>& filters)
@@ -145,6 +192,11 @@ void Item::addStage(const int stage1, const int stage2, std::unique_ptr<ImageFut
     const Size size = future->getSize();
     if (size.width < 1 || size.height < 1)
         return; // bad image
+    if (!future->setProcessor(makeProcessor(filters))) {
+        // already decoded, so filters have to be applied here
+        addStage(stage1, stage2, future->getSurface(), name, filters);
+        return;
+    }
     updateSize(size);
     if (static_cast<int>(_futures.size()) <= stage1)
         _futures.resize(stage1 + 1);
@@ -161,6 +213,8 @@ void Item::addStage(const int stage1, const int stage2, std::unique_ptr<ImageFut
     _futures[stage1][stage2] = std::move(future);
     _filters[stage1][stage2] = std::move(filters);
     _names[stage1][stage2] = std::move(name);
+    if (stage1 == _stage1 && stage2 == _stage2)
+        markDirty();
 }
 
 bool Item::isStage(int stage1, int stage2, const std::string& name, std::list<ImageFilter> filters)
@@ -184,16 +238,32 @@ void Item::render(Renderer renderer, int offX, int offY)
         SDL_RenderFillRect(renderer, &r);
     }
     assert(_stage1 >= 0 && _stage2 >= 0);
+    // use the shared texture if another item already has the same image with the same filters
+    if (_stage1 >= (int)_texs.size() || _stage2 >= (int)_texs[_stage1].size() || !_texs[_stage1][_stage2]) {
+        const auto key = getTextureKey(_stage1, _stage2);
+        SDL_Texture* tex = key.empty() ? nullptr : TextureManager::get(renderer).acquire(key);
+        if (tex) {
+            _texRenderer = renderer;
+            if (static_cast<int>(_texs.size()) <= _stage1)
+                _texs.resize(_stage1 + 1);
+            if (static_cast<int>(_texs[_stage1].size()) <= _stage2)
+                _texs[_stage1].resize(_stage2 + 1);
+            _texs[_stage1][_stage2] = tex;
+            if (_stage1 < static_cast<int>(_futures.size()) && _stage2 < static_cast<int>(_futures[_stage1].size()))
+                _futures[_stage1][_stage2].reset(); // no need to decode it
+            if (_stage1 < static_cast<int>(_surfs.size()) && _stage2 < static_cast<int>(_surfs[_stage1].size())
+                    && _surfs[_stage1][_stage2]) {
+                SDL_FreeSurface(_surfs[_stage1][_stage2]);
+                _surfs[_stage1][_stage2] = nullptr;
+            }
+        }
+    }
     // resolve futures
     if (_stage1 < static_cast<int>(_futures.size()) && _stage2 < static_cast<int>(_futures[_stage1].size())) {
         if (auto& future = _futures[_stage1][_stage2]) {
-            // TODO: move filter resolution into the future
             if (isSmallImage(future->getSize()) || future->isSurfaceDone()) {
-                SDL_Surface* surf = future->getSurface();
+                SDL_Surface* surf = future->getSurface(); // filters were applied by the future
                 future.reset();
-                surf = updateSurface(surf, _filters[_stage1][_stage2]);
-                for (const auto& filter: _filters[_stage1][_stage2])
-                    surf = filter.apply(surf);
                 if (static_cast<int>(_surfs.size()) <= _stage1)
                     _surfs.resize(_stage1 + 1);
                 if (static_cast<int>(_surfs[_stage1].size()) <= _stage2)
@@ -201,16 +271,14 @@ void Item::render(Renderer renderer, int offX, int offY)
                 _surfs[_stage1][_stage2] = surf;
             } else {
                 future->prioritize();
+                markDirty(); // poll again next frame
             }
         }
     }
     if (_overrideFuture) {
         if (isSmallImage(_overrideFuture->getSize()) || _overrideFuture->isSurfaceDone()) {
-            SDL_Surface* surf = _overrideFuture->getSurface();
+            SDL_Surface* surf = _overrideFuture->getSurface(); // filters were applied by the future
             _overrideFuture.reset();
-            surf = updateSurface(surf, _overrideFilters);
-            for (auto& filter: _overrideFilters)
-                surf = filter.apply(surf);
             if (surf) {
                 if (_overrideSurf)
                     SDL_FreeSurface(_overrideSurf); // free the placeholder surface
@@ -221,6 +289,7 @@ void Item::render(Renderer renderer, int offX, int offY)
             }
         } else {
             _overrideFuture->prioritize();
+            markDirty(); // poll again next frame
         }
     }
     // get surface/texture
@@ -253,6 +322,10 @@ void Item::render(Renderer renderer, int offX, int offY)
                 _texs.resize(_stage1 + 1);
             if (static_cast<int>(_texs[_stage1].size()) <= _stage2)
                 _texs[_stage1].resize(_stage2 + 1);
+            const auto key = getTextureKey(_stage1, _stage2);
+            if (!key.empty())
+                tex = TextureManager::get(renderer).insert(key, tex);
+            _texRenderer = renderer;
             _texs[_stage1][_stage2] = tex;
         }
         if (_quality >= 0) {
@@ -381,6 +454,7 @@ void Item::setFont(Item::FONT font) {
     if (_overlayTex) SDL_DestroyTexture(_overlayTex);
     _overlayTex = nullptr;
     _font = font;
+    markDirty();
 }
 
 void Item::setOverlay(const std::string& s) {
@@ -388,6 +462,7 @@ void Item::setOverlay(const std::string& s) {
     if (_overlayTex) SDL_DestroyTexture(_overlayTex);
     _overlayTex = nullptr;
     _overlay = s;
+    markDirty();
 }
 
 void Item::setOverlayColor(Widget::Color c) {
@@ -395,6 +470,7 @@ void Item::setOverlayColor(Widget::Color c) {
     if (_overlayTex) SDL_DestroyTexture(_overlayTex);
     _overlayTex = nullptr;
     _overlayColor = c;
+    markDirty();
 }
 
 void Item::setOverlayBackgroundColor(Widget::Color c)
@@ -403,6 +479,7 @@ void Item::setOverlayBackgroundColor(Widget::Color c)
     if (_overlayTex) SDL_DestroyTexture(_overlayTex);
     _overlayTex = nullptr;
     _overlayBackgroundColor = c;
+    markDirty();
 }
 
 void Item::setOverlayAlignment(Label::HAlign halign)
@@ -411,6 +488,7 @@ void Item::setOverlayAlignment(Label::HAlign halign)
     if (_overlayTex) SDL_DestroyTexture(_overlayTex);
     _overlayTex = nullptr;
     _overlayAlign = halign;
+    markDirty();
 }
 
 void Item::setImageOverride(const void *data, const size_t len, const std::string& name,
@@ -428,9 +506,7 @@ void Item::setImageOverride(const void *data, const size_t len, const std::strin
         if (!surf) {
             fprintf(stderr, "Could not load image: %s\n", SDL_GetError());
         } else {
-            surf = updateSurface(surf, filters);
-            for (auto& filter: filters)
-                surf = filter.apply(surf);
+            surf = processSurface(surf, filters);
         }
     }
 
@@ -444,6 +520,7 @@ void Item::setImageOverride(const void *data, const size_t len, const std::strin
     _overrideName = name;
     _overrideFilters = filters;
     _overrideSurf = surf;
+    markDirty();
 }
 
 void Item::setImageOverride(const std::function<std::unique_ptr<ImageFuture>(void)>& generator, const std::string &name,
@@ -458,14 +535,27 @@ void Item::setImageOverride(const std::function<std::unique_ptr<ImageFuture>(voi
     _overrideName = name;
     _overrideFilters = filters;
     _overrideFuture = generator();
+    if (_overrideFuture && !_overrideFuture->setProcessor(makeProcessor(filters))) {
+        // already decoded, so filters have to be applied here
+        SDL_Surface* surf = processSurface(_overrideFuture->getSurface(), filters);
+        _overrideFuture.reset();
+        if (surf) {
+            _overrideSurf = surf;
+            markDirty();
+            return;
+        }
+    }
     // create placeholder override surface
     static constexpr uint32_t zero = 0;
     auto* zeroPtr = const_cast<void*>(static_cast<const void*>(&zero));
     _overrideSurf = SDL_CreateRGBSurfaceWithFormatFrom(zeroPtr, 1, 1, 32, 4, SDL_PIXELFORMAT_ARGB8888);
+    markDirty();
 }
 
 void Item::clearImageOverride()
 {
+    if (_overrideFuture || _overrideTex || _overrideSurf)
+        markDirty();
     if (_overrideFuture)
         _overrideFuture.reset();
     if (_overrideTex) {
@@ -23,6 +23,10 @@ public:
     int getQuality() const { return _quality; }
     // NOTE: this has to be set before the image is rendered for the first time
     virtual void setQuality(int q) { _quality = q; }
+    /// Items with the same scope share textures of stages with the same name, filters and quality.
+    /// The scope has to change when names could refer to different images. Empty disables sharing.
+    // NOTE: this has to be set before the image is rendered for the first time
+    void setImageScope(const std::string& scope) { _imageScope = scope; }
     
     virtual void setStage(int stage1, int stage2);
     virtual int getStage1() const { return _stage1; }
@@ -31,7 +35,7 @@ public:
     void addStage(int stage1, int stage2, const char *path, const std::list<ImageFilter>& filters={});
     void addStage(int stage1, int stage2, const void *data, size_t len, const std::string& name,
                           const std::list<ImageFilter>& filters={});
-    // TODO: have an image future that applies filters
+    /// Filters are applied by the future in the background.
     void addStage(int stage1, int stage2, std::unique_ptr<ImageFuture>&& future, std::string name,
         std::list<ImageFilter> filters={});
     virtual bool isStage(int stage1, int stage2, const std::string& name, std::list<ImageFilter> filters);
@@ -46,8 +50,10 @@ public:
     virtual int getMaxX() const override { return _renderPos.left + _renderSize.width - 1; }
     virtual int getMaxY() const override { return _renderPos.top + _renderSize.height - 1; }
     void setImageAlignment(Label::HAlign halign, Label::VAlign valign) {
+        if (halign == _halign && valign == _valign) return;
         _halign = halign;
         _valign = valign;
+        markDirty();
     }
     void setImageOverride(const void *data, size_t len, const std::string& name, const std::list<ImageFilter>& filters);
     void setImageOverride(const std::function<std::unique_ptr<ImageFuture>(void)> &generator, const std::string& name,
@@ -56,12 +62,13 @@ public:
 
 protected:
     std::vector< std::vector<SDL_Surface*> > _surfs; // TODO: put surf, name and filters in a struct
-    std::vector< std::vector<SDL_Texture*> > _texs; // TODO: use texture store to avoid storing duplicates
+    std::vector< std::vector<SDL_Texture*> > _texs; // named stages are shared through TextureManager
     std::vector< std::vector<std::string> > _names;
     std::vector< std::vector<std::list<ImageFilter>> > _filters;
     std::vector<std::vector<std::unique_ptr<ImageFuture>>> _futures;
     bool _fixedAspect=true;
     int _quality=-1;
+    std::string _imageScope;
     int _stage1=0;
     int _stage2=0;
     Size _renderSize;
@@ -79,8 +86,11 @@ protected:
     std::unique_ptr<ImageFuture> _overrideFuture;
     std::string _overrideName;
     std::list<ImageFilter> _overrideFilters;
+    SDL_Renderer* _texRenderer = nullptr; ///< renderer that stage textures were created for
 
     void updateSize(Size size);
+    void destroyTexture(SDL_Texture* tex);
+    std::string getTextureKey(int stage1, int stage2) const;
     void addStage(int stage1, int stage2, SDL_Surface* surf, const std::string& name,
                           const std::list<ImageFilter>& filters={});
     void freeStage(int stage1, int stage2);
@@ -151,6 +151,7 @@ void MapWidget::connectSignals()
                     }
                     _panX = newPanX;
                     _panY = newPanY;
+                    markDirty();
                 }
             }
             return; // Don't process hover while dragging
@@ -164,32 +165,33 @@ void MapWidget::connectSignals()
         const int x1 = x + _pos.left; // relative to parent to match dstRect
         const int y1 = y + _pos.top;
 
-        for (auto locIt = _locations.rbegin(); locIt != _locations.rend(); ++locIt) {
-            const auto& loc = locIt->second;
-            for (const auto& pos: loc.pos) {
-                if (pos.state == -1) continue; // hidden
-                if (pos.state == 0 && _hideClearedLocations) continue;
-                if (pos.state == 2 && _hideUnreachableLocations) continue;
-
-                int innerX, innerY, innerW, innerH, borderSize;
-                calculateLocationScreenRect(pos, srcRect, dstRect, baseScale,
-                    innerX, innerY, innerW, innerH, borderSize);
-                const int outerW = innerW + 2 * borderSize;
-                const int outerH = innerH + 2 * borderSize;
-
-                if (x1 >= innerX - borderSize && x1 < innerX - borderSize + outerW &&
-                    y1 >= innerY - borderSize && y1 < innerY - borderSize + outerH)
-                {
-                    // TODO: store iterator instead of string?
-                    if (locIt->first != _locationHover) {
-                        _locationHover = locIt->first;
-    #if 0
-                        printf("MapWidget: hover location %s\n", _locationHover->c_str());
-    #endif
-                        onLocationHover.emit(this, *_locationHover, absX, absY);
-                    }
-                    return;
+        // topmost pin first
+        const auto candidates = queryPins(srcRect, dstRect, baseScale, x1, y1, x1, y1);
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+            const auto& pin = _pins[*it];
+            const auto& pos = *pin.pos;
+            if (pos.state == -1) continue; // hidden
+            if (pos.state == 0 && _hideClearedLocations) continue;
+            if (pos.state == 2 && _hideUnreachableLocations) continue;
+
+            int innerX, innerY, innerW, innerH, borderSize;
+            calculateLocationScreenRect(pos, srcRect, dstRect, baseScale,
+                innerX, innerY, innerW, innerH, borderSize);
+            const int outerW = innerW + 2 * borderSize;
+            const int outerH = innerH + 2 * borderSize;
+
+            if (x1 >= innerX - borderSize && x1 < innerX - borderSize + outerW &&
+                y1 >= innerY - borderSize && y1 < innerY - borderSize + outerH)
+            {
+                // TODO: store iterator instead of string?
+                if (*pin.name != _locationHover) {
+                    _locationHover = *pin.name;
+#if 0
+                    printf("MapWidget: hover location %s\n", _locationHover->c_str());
+#endif
+                    onLocationHover.emit(this, *_locationHover, absX, absY);
                 }
+                return;
             }
         }
         // no match
@@ -207,6 +209,7 @@ void MapWidget::connectSignals()
             _zoom = 1.0f;
             _panX = 0.0f;
             _panY = 0.0f;
+            markDirty();
         }
     }};
 
@@ -281,6 +284,7 @@ void MapWidget::connectSignals()
                 _panY *= panScale;
             }
         }
+        markDirty();
     }};
 }
 
@@ -321,74 +325,80 @@ void MapWidget::render(Renderer renderer, const int offX, const int offY)
     calculateSrcAndDst(offX, offY, true, baseScale, srcRect, dstRect);
     SDL_RenderCopyF(renderer, tex, &srcRect, &dstRect);
 
-    // Render locations with zoom/pan adjustment
-    for (const auto pass: {0, 1}) {
-        for (const auto& pair : _locations) {
-            const auto& loc = pair.second;
-            for (const auto& pos : loc.pos) {
-                int state = (int)pos.state;
-                if (state == -1) continue; // hidden
-                if (state == 0 && _hideClearedLocations) continue;
-                if (state == 2 && _hideUnreachableLocations) continue;
-
-                int innerX, innerY, innerW, innerH, borderSize;
-                calculateLocationScreenRect(pos, srcRect, dstRect, baseScale, innerX, innerY, innerW, innerH, borderSize);
-
-                // Skip locations that are outside the widget area
-                const int outerW = innerW + 2 * borderSize;
-                const int outerH = innerH + 2 * borderSize;
-                if (innerX + outerW < widgetX || innerX > widgetX + widgetW ||
-                    innerY + outerH < widgetY || innerY > widgetY + widgetH) {
-                    continue;
-                }
+    // Render locations with zoom/pan adjustment. Glows and pins are collected into one batch each,
+    // so all glows end up below all pins, same as drawing them in two passes.
+    const auto visiblePins = queryPins(srcRect, dstRect, baseScale, widgetX, widgetY, widgetX + widgetW, widgetY + widgetH);
+    for (const auto index : visiblePins) {
+        const auto& pos = *_pins[index].pos;
+        int state = (int)pos.state;
+        if (state == -1) continue; // hidden
+        if (state == 0 && _hideClearedLocations) continue;
+        if (state == 2 && _hideUnreachableLocations) continue;
+
+        int innerX, innerY, innerW, innerH, borderSize;
+        calculateLocationScreenRect(pos, srcRect, dstRect, baseScale, innerX, innerY, innerW, innerH, borderSize);
+
+        // Skip locations that are outside the widget area
+        const int outerW = innerW + 2 * borderSize;
+        const int outerH = innerH + 2 * borderSize;
+        if (innerX + outerW < widgetX || innerX > widgetX + widgetW ||
+            innerY + outerH < widgetY || innerY > widgetY + widgetH) {
+            continue;
+        }
 
-                const Highlight highlight = pos.highlight;
-
-                if (pass == 0) {
-                    // glow
-                    if (highlight == Highlight::NONE)
-                        continue;
-                    const Color c = HighlightColors[highlight];
-                    if (pos.shape == Shape::DIAMOND)
-                        drawDiamondGlow(renderer, {innerX, innerY}, {innerW, innerH}, c);
-                    else if (pos.shape == Shape::TRAPEZOID)
-                        drawTrapezoidGlow(renderer, {innerX, innerY}, {innerW, innerH}, c);
-                    else
-                        drawRectGlow(renderer, {innerX, innerY}, {innerW, innerH}, c);
-                } else if (!SplitRects || state < 0 || state >= countOf(triangleValues)) {
-                    // uniform shape
-                    const Color& c = (state < 0 || state >= countOf(StateColors)) ?
-                            StateColors[countOf(StateColors) - 1] : StateColors[state];
-                    if (pos.shape == Shape::DIAMOND)
-                        drawDiamond(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                c, c, c, c);
-                    else if (pos.shape == Shape::TRAPEZOID)
-                        drawTrapezoid(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                c, c, c, c);
-                    else
-                        drawRect(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                c, c, c, c);
-                } else {
-                    // split shape
-                    const int* values = triangleValues[state];
-                    const Color& topC = StateColors[values[0]];
-                    const Color& leftC = StateColors[values[1]];
-                    const Color& botC = StateColors[values[2]];
-                    const Color& rightC = StateColors[values[3]];
-
-                    if (pos.shape == Shape::DIAMOND)
-                        drawDiamond(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                topC, leftC, botC, rightC);
-                    else if (pos.shape == Shape::TRAPEZOID)
-                        drawTrapezoid(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                topC, leftC, botC, rightC);
-                    else
-                        drawRect(renderer, {innerX, innerY}, {innerW, innerH}, borderSize,
-                                topC, leftC, botC, rightC);
-                }
-            }
+        const Highlight highlight = pos.highlight;
+
+        // glow
+        if (highlight != Highlight::NONE) {
+            const Color c = HighlightColors[highlight];
+            if (pos.shape == Shape::DIAMOND)
+                drawDiamondGlow(_glowBatch, {innerX, innerY}, {innerW, innerH}, c);
+            else if (pos.shape == Shape::TRAPEZOID)
+                drawTrapezoidGlow(_glowBatch, {innerX, innerY}, {innerW, innerH}, c);
+            else
+                drawRectGlow(_glowBatch, {innerX, innerY}, {innerW, innerH}, c);
         }
+
+        if (!SplitRects || state < 0 || state >= countOf(triangleValues)) {
+            // uniform shape
+            const Color& c = (state < 0 || state >= countOf(StateColors)) ?
+                    StateColors[countOf(StateColors) - 1] : StateColors[state];
+            if (pos.shape == Shape::DIAMOND)
+                drawDiamond(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        c, c, c, c);
+            else if (pos.shape == Shape::TRAPEZOID)
+                drawTrapezoid(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        c, c, c, c);
+            else
+                drawRect(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        c, c, c, c);
+        } else {
+            // split shape
+            const int* values = triangleValues[state];
+            const Color& topC = StateColors[values[0]];
+            const Color& leftC = StateColors[values[1]];
+            const Color& botC = StateColors[values[2]];
+            const Color& rightC = StateColors[values[3]];
+
+            if (pos.shape == Shape::DIAMOND)
+                drawDiamond(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        topC, leftC, botC, rightC);
+            else if (pos.shape == Shape::TRAPEZOID)
+                drawTrapezoid(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        topC, leftC, botC, rightC);
+            else
+                drawRect(_pinBatch, {innerX, innerY}, {innerW, innerH}, borderSize,
+                        topC, leftC, botC, rightC);
+        }
+    }
+
+    if (!_glowBatch.empty()) {
+        if (const auto glowTex = getGlowTexture(renderer))
+            _glowBatch.render(renderer, glowTex);
+        else
+            _glowBatch.clear();
     }
+    _pinBatch.render(renderer, nullptr);
 
     // Restore clipping
     SDL_RenderSetClipRect(renderer, nullptr);
@@ -498,21 +508,74 @@ void MapWidget::addLocation(const std::string& id, Point&& point)
     } else {
         _locations[id] = {{point}};
     }
+    _pinsDirty = true;
+    markDirty();
+}
+
+void MapWidget::updatePins()
+{
+    _pins.clear();
+    _pinGrid.clear();
+    _maxPinSize = 0;
+    _maxPinBorder = 0;
+    for (const auto& pair : _locations) {
+        for (const auto& pos : pair.second.pos) {
+            _pinGrid.insert(pos.x, pos.y, (uint32_t)_pins.size());
+            _pins.push_back({&pair.first, &pos});
+            _maxPinSize = std::max(_maxPinSize, pos.size);
+            _maxPinBorder = std::max(_maxPinBorder, pos.borderThickness);
+        }
+    }
+    _pinsDirty = false;
+}
+
+std::vector<uint32_t> MapWidget::queryPins(const SDL_Rect& srcRect, const SDL_FRect& dstRect, const float baseScale,
+    int x1, int y1, int x2, int y2)
+{
+    if (_pinsDirty)
+        updatePins();
+    std::vector<uint32_t> res;
+    if (_pins.empty() || dstRect.w <= 0 || dstRect.h <= 0)
+        return res;
+
+    // pins have a fixed size on screen, see calculateLocationScreenRect. +2 for rounding
+    const int extent = static_cast<int>(std::ceil(static_cast<float>(_maxPinSize) / baseScale / 2
+            + static_cast<float>(_maxPinBorder) / baseScale)) + 2;
+    x1 -= extent;
+    y1 -= extent;
+    x2 += extent;
+    y2 += extent;
+
+    // screen to image coordinates
+    const float imgPerScreenX = static_cast<float>(srcRect.w) / dstRect.w;
+    const float imgPerScreenY = static_cast<float>(srcRect.h) / dstRect.h;
+    const int left = static_cast<int>(std::floor((static_cast<float>(x1) - dstRect.x) * imgPerScreenX)) + srcRect.x - 1;
+    const int top = static_cast<int>(std::floor((static_cast<float>(y1) - dstRect.y) * imgPerScreenY)) + srcRect.y - 1;
+    const int right = static_cast<int>(std::ceil((static_cast<float>(x2) - dstRect.x) * imgPerScreenX)) + srcRect.x + 1;
+    const int bottom = static_cast<int>(std::ceil((static_cast<float>(y2) - dstRect.y) * imgPerScreenY)) + srcRect.y + 1;
+
+    _pinGrid.query(left, top, right, bottom, [&res](int, int, uint32_t index) {
+        res.push_back(index);
+    });
+    std::sort(res.begin(), res.end());
+    return res;
 }
 
 void MapWidget::setLocationState(const std::string& id, int state, size_t n)
 {
     auto it = _locations.find(id);
-    if (it != _locations.end() && it->second.pos.size() >= n) {
+    if (it != _locations.end() && n < it->second.pos.size() && it->second.pos[n].state != state) {
         it->second.pos[n].state = state;
+        markDirty();
     }
 }
 
 void MapWidget::setLocationHighlight(const std::string& id, Highlight highlight, size_t n)
 {
     auto it = _locations.find(id);
-    if (it != _locations.end() && it->second.pos.size() >= n) {
+    if (it != _locations.end() && n < it->second.pos.size() && it->second.pos[n].highlight != highlight) {
         it->second.pos[n].highlight = highlight;
+        markDirty();
     }
 }
 
@@ -528,6 +591,7 @@ void MapWidget::setPanCenter(const float x, const float y)
 {
     _panX = static_cast<float>(_autoSize.width) / 2 - x;
     _panY = static_cast<float>(_autoSize.height) / 2 - y;
+    markDirty();
 }
 
 } // namespace
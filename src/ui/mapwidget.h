@@ -6,6 +6,8 @@
 #include <vector>
 #include "../core/location.h"
 #include "../core/locationsection.h"
+#include "../core/spatialgrid.h"
+#include "../uilib/geometrybatch.h"
 #include "../uilib/image.h"
 
 namespace Ui {
@@ -44,13 +46,13 @@ public:
     int getAbsLeft() const { return _absX; } // FIXME: this is not really a good solution
     int getAbsTop() const { return _absY; }
 
-    void setHideClearedLocations(bool hide) { _hideClearedLocations = hide; }
-    void setHideUnreachableLocations(bool hide) { _hideUnreachableLocations = hide; }
+    void setHideClearedLocations(bool hide) { _hideClearedLocations = hide; markDirty(); }
+    void setHideUnreachableLocations(bool hide) { _hideUnreachableLocations = hide; markDirty(); }
 
     float getZoom() const { return _zoom; }
-    void setZoom(const float zoom) { _zoom = zoom; }
+    void setZoom(const float zoom) { _zoom = zoom; markDirty(); }
     std::tuple<float, float> getPan() const { return {_panX, _panY}; }
-    void setPan(const float x, const float y) { _panX = x; _panY = y; }
+    void setPan(const float x, const float y) { _panX = x; _panY = y; markDirty(); }
     std::tuple<float, float> getPanCenter() const;
     void setPanCenter(float x, float y);
 
@@ -64,6 +66,21 @@ protected:
     std::map<std::string, Location> _locations;
     std::optional<std::string> _locationHover; // TODO: store iterator instead of string?
 
+    /// Pins of all locations in draw order, rebuilt after addLocation
+    struct Pin {
+        const std::string* name;
+        const Point* pos;
+    };
+    std::vector<Pin> _pins;
+    SpatialGrid<uint32_t> _pinGrid; ///< index into _pins by position in the image
+    int _maxPinSize = 0;
+    int _maxPinBorder = 0;
+    bool _pinsDirty = false;
+
+    /// All glows and all pins are drawn with one SDL_RenderGeometry call each
+    GeometryBatch _glowBatch;
+    GeometryBatch _pinBatch;
+
     bool _hideClearedLocations = false;
     bool _hideUnreachableLocations = false;
 
@@ -91,6 +108,10 @@ private:
         SDL_FRect& dstRect) const;
     static void calculateLocationScreenRect(const Point& pos, const SDL_Rect& srcRect, const SDL_FRect& dstRect,
         float baseScale, int& innerX, int& innerY, int& innerW, int& innerH, int& borderSize);
+    void updatePins();
+    /// Returns indices into _pins, in draw order, of pins that may intersect the screen rect [x1, x2] x [y1, y2].
+    std::vector<uint32_t> queryPins(const SDL_Rect& srcRect, const SDL_FRect& dstRect, float baseScale,
+        int x1, int y1, int x2, int y2);
 };
 
 } // namespace Ui
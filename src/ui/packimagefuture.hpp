@@ -18,7 +18,7 @@ namespace Ui {
 // Teardown: unload Tracker -> destroy root view: cancel futures, destroy Pack
 
 class PackImageFuture final : public ImageFuture {
-    using TaskQueueType = pop::TaskQueue<SDL_Surface*>;
+    using TaskQueueType = ImageTaskQueue;
     using TaskQueue = pop::Singleton<TaskQueueType>;
     static constexpr size_t NO_TASK = TaskQueueType::NO_TASK;
 
@@ -34,7 +34,7 @@ class PackImageFuture final : public ImageFuture {
         if (_taskNumber != NO_TASK) {
             // try to cancel and process in foreground, otherwise wait for background result
             if (TaskQueue::get().cancel(_taskNumber)) {
-                _surface = _pack->getImage(_filename);
+                _surface = process(_pack->getImage(_filename));
             } else {
                 _surface = TaskQueue::get().get(_taskNumber);
             }
@@ -64,12 +64,10 @@ public:
             fprintf(stderr, "Created PackImageFuture for empty filename\n");
         _size = _pack->getImageSize(_filename);
         _taskNumber = TaskQueue::get().enqueue([this] {
-            return _pack->getImage(_filename);
+            return process(_pack->getImage(_filename));
         });
     }
 
-    PackImageFuture(PackImageFuture&&) = default;
-
     PackImageFuture(const PackImageFuture&) = delete;
 
     ~PackImageFuture() override
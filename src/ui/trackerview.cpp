@@ -1,5 +1,6 @@
 #include "trackerview.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <fmt/format.h>
 #include "defaults.h" // DEFAULT_FONT_*
@@ -17,6 +18,7 @@
 #include "../uilib/scrollvbox.h"
 #include "../uilib/simplecontainer.h"
 #include "../uilib/tabs.h"
+#include "../uilib/texturemanager.h"
 #include "../uilib/timer.h"
 #include "../uilib/tooltip.h"
 #include "../uilib/vbox.h"
@@ -122,6 +124,7 @@ Item* TrackerView::makeItem(int x, int y, int width, int height, const ::BaseIte
     auto *w = new Item(x,y,width,height,_fontStore->getFont(DEFAULT_FONT_NAME,
             FontStore::sizeFromData(DEFAULT_FONT_SIZE, item->getOverlayFontSize())));
     w->setQuality(_defaultItemQuality);
+    w->setImageScope(_imageScope);
     size_t stages = item->getStageCount();
     bool disabled = item->getAllowDisabled();
     bool stagedWithDisabled = item->getStageCount() && disabled;
@@ -252,6 +255,7 @@ Item* TrackerView::makeItem(int x, int y, int width, int height, const ::BaseIte
             _tooltipItem = id;
             _tooltipTimer = getTicks();
             _tooltipTriggered = false;
+            markDirty(); // render checks the tooltip timer
         }};
         w->onMouseLeave += {this, [this] (void*) {
             onItemHover.emit(this, "");
@@ -281,6 +285,8 @@ Item* TrackerView::makeItem(int x, int y, int width, int height, const ::BaseIte
 TrackerView::TrackerView(int x, int y, int w, int h, Tracker* tracker, const std::string& layoutRoot, FontStore *fontStore)
     : SimpleContainer(x,y,w,h), _tracker(tracker), _layoutRoot(layoutRoot), _fontStore(fontStore)
 {
+    static unsigned imageScopeCounter = 0;
+    _imageScope = "trackerview" + std::to_string(++imageScopeCounter);
     _font = _fontStore->getFont(DEFAULT_FONT_NAME, DEFAULT_FONT_SIZE);
     _smallFont = _fontStore->getFont(DEFAULT_FONT_NAME, DEFAULT_FONT_SIZE - 2);
     if (_font && !_smallFont) _smallFont = _font;
@@ -309,10 +315,19 @@ TrackerView::TrackerView(int x, int y, int w, int h, Tracker* tracker, const std
             updateMapTooltip(); // TODO: move this into updateLocation(s) and detect if the location is hovered
         }
     }};
-    _tracker->onLocationSectionChanged += {this, [this](void*, [[maybe_unused]] const LocationSection& sec) {
+    _tracker->onLocationsChanged += {this, [this](void*, const std::unordered_set<std::string>* locations) {
+        if (!locations)
+            _allLocationsChanged = true;
+        else
+            _changedLocations.insert(locations->begin(), locations->end());
+    }};
+    _tracker->onLocationSectionChanged += {this, [this](void*, const LocationSection& sec) {
+        // cleared state and highlight are not part of the logic cache
+        _changedLocations.insert(sec.getParentID());
+        for (const auto& [location, _]: _tracker->getReferencingSections(sec))
+            _changedLocations.insert(location.get().getID());
         if (_tracker->isBulkUpdate() && _tracker->allowDeferredLogicUpdate())
             return; // will update on bulk update done
-        // TODO: partial update if sec's AvailableChestCount is not involved in logic
         updateLocations();
         updateMapTooltip(); // TODO: move this into updateLocation(s) and detect if the location is hovered
     }};
@@ -327,6 +342,7 @@ TrackerView::~TrackerView()
     _tracker->onDisplayChanged -= this;
     _tracker->onBulkUpdateDone -= this;
     _tracker->onLocationSectionChanged -= this;
+    _tracker->onLocationsChanged -= this;
     _tracker->onUiHint -= this;
     _tracker = nullptr;
     
@@ -335,6 +351,9 @@ TrackerView::~TrackerView()
             w->onDestroy -= this;
         }
     }
+    // items release their textures when destroyed, after that nothing can request this scope again
+    clearChildren();
+    TextureManager::purgeAll(_imageScope + "\x1f");
 }
 
 void TrackerView::relayout()
@@ -355,6 +374,8 @@ void TrackerView::render(Renderer renderer, int offX, int offY)
     if (!_tooltipTriggered && !_tooltipItem.empty() && elapsed(_tooltipTimer, Tooltip::delay)) {
         _tooltipTriggered = true;
         onItemTooltip.emit(this, _tooltipItem);
+    } else if (!_tooltipTriggered && !_tooltipItem.empty()) {
+        markDirty(); // check the tooltip timer again next frame
     }
     if (_relayoutRequired) {
         auto oldSize = _size;
@@ -458,11 +479,13 @@ void TrackerView::updateLayout(const std::string& layout)
     _mapTooltipOwner = nullptr;
     _items.clear();
     _maps.clear();
+    _mapLocations.clear();
     _mapsDirty = false;
     _tabs.clear();
     _layoutRefs.clear();
     clearChildren();
     _relayoutRequired = true;
+    markDirty();
     
     // record "missed" hints during update to replay them later
     _tracker->onUiHint += { this, [this] (void*, const std::string& name, const std::string& value) {
@@ -474,6 +497,7 @@ void TrackerView::updateLocations()
 {
     if (_tracker->allowDeferredLogicUpdate()) {
         _mapsDirty = true; // will be updated on next frame render
+        markDirty();
     } else {
         updateLocationsNow();
     }
@@ -481,26 +505,14 @@ void TrackerView::updateLocations()
 
 void TrackerView::updateLocationsNow()
 {
-    for (auto& mappair: _maps) {
-        for (auto& w: mappair.second) {
-            std::string lastLocation;
-            size_t n = 0; // nth map location of the same location on the same map
-            for (const auto& pair : _tracker->getMapLocations(mappair.first)) {
-                if (lastLocation != pair.first) {
-                    lastLocation = pair.first;
-                    n = 0;
-                }
-                int state = CalculateLocationState(_tracker, pair.first, pair.second);
-                Highlight highlight = CalculateLocationHighlight(_tracker, pair.first, pair.second);
-                if (_maps.empty()) {
-                    printf("TrackerView: UI changed during updateLocations()\n");
-                    return;
-                }
-                w->setLocationState(pair.first, state, n);
-                w->setLocationHighlight(pair.first, highlight, n); // TODO: separate update handler?
-                n++;
-            }
-        }
+    _tracker->updateLogic(); // reports changed locations through onLocationsChanged
+    const auto changed = std::move(_changedLocations);
+    _changedLocations.clear();
+    const bool all = _allLocationsChanged;
+    _allLocationsChanged = false;
+    if (!pushLocationStates(all ? nullptr : &changed)) {
+        _allLocationsChanged = true;
+        return;
     }
     _mapsDirty = false;
 }
@@ -509,6 +521,7 @@ void TrackerView::updateLocation(const std::string& location)
 {
     if (_tracker->allowDeferredLogicUpdate()) {
         _mapsDirty = true; // will be updated on next frame render
+        markDirty();
     } else {
         updateLocationNow(location);
     }
@@ -516,25 +529,53 @@ void TrackerView::updateLocation(const std::string& location)
 
 void TrackerView::updateLocationNow(const std::string& location)
 {
-    for (auto& mappair: _maps) {
-        for (auto& w: mappair.second) {
-            std::string lastLocation;
-            size_t n = 0; // nth map location of the same location on the same map
-            for (const auto& pair : _tracker->getMapLocations(mappair.first)) {
-                if (pair.first != location)
-                    continue;
-                int state = CalculateLocationState(_tracker, pair.first, pair.second);
-                Highlight highlight = CalculateLocationHighlight(_tracker, pair.first, pair.second);
-                if (_maps.empty()) {
+    if (!location.empty()) {
+        const std::unordered_set<std::string> locations = {location};
+        pushLocationStates(&locations);
+    }
+}
+
+bool TrackerView::pushLocationStates(const std::unordered_set<std::string>* locations)
+{
+    // Updates map locations in locations, or all if nullptr, plus those that have to be rechecked every time.
+    // Returns false if the UI changed while updating.
+    // A location's state does not depend on the map, so it is calculated once for all its map locations,
+    // and widgets only get updated if state or highlight differ from what was pushed last time.
+    std::unordered_map<std::string, std::pair<int, Highlight>> results;
+    for (auto& [mapname, refs]: _mapLocations) {
+        const auto& widgets = _maps[mapname];
+        for (auto& ref: refs) {
+            if (locations && ref.pushed && !ref.recheck && !locations->count(ref.location))
+                continue;
+            auto resIt = results.find(ref.location);
+            if (resIt == results.end()) {
+                int state = CalculateLocationState(_tracker, ref.location);
+                Highlight highlight = CalculateLocationHighlight(_tracker, ref.location);
+                if (_mapLocations.empty()) {
                     printf("TrackerView: UI changed during updateLocations()\n");
-                    return;
+                    return false;
                 }
-                w->setLocationState(pair.first, state, n);
-                w->setLocationHighlight(pair.first, highlight, n); // TODO: separate update handler?
-                n++;
+                resIt = results.emplace(ref.location, std::make_pair(state, highlight)).first;
+            }
+            const bool visible = _tracker->isVisible(ref.mapLocation);
+            if (_mapLocations.empty()) {
+                printf("TrackerView: UI changed during updateLocations()\n");
+                return false;
+            }
+            const int state = visible ? resIt->second.first : -1;
+            const Highlight highlight = visible ? resIt->second.second : Highlight::NONE;
+            if (ref.pushed && ref.state == state && ref.highlight == highlight)
+                continue;
+            ref.pushed = true;
+            ref.state = state;
+            ref.highlight = highlight;
+            for (auto& w: widgets) {
+                w->setLocationState(ref.location, state, ref.n);
+                w->setLocationHighlight(ref.location, highlight, ref.n); // TODO: separate update handler?
             }
         }
     }
+    return true;
 }
 
 void TrackerView::updateMapTooltip()
@@ -544,6 +585,7 @@ void TrackerView::updateMapTooltip()
     }
     if (_tracker->allowDeferredLogicUpdate()) {
         _mapTooltipDirty = true; // will be updated on next frame render
+        markDirty();
     } else {
         updateMapTooltipNow();
     }
@@ -919,13 +961,36 @@ bool TrackerView::addLayoutNode(Container* container, const LayoutNode& node, si
             if (!node.getBackground().empty()) w->setBackground(node.getBackground());
             w->setGrow(1,1);
             w->setMinSize({200,200});
-            for (const auto& pair : _tracker->getMapLocations(mapname)) {
+            auto& refs = _mapLocations[mapname];
+            if (refs.empty()) {
+                std::string lastLocation;
+                size_t n = 0;
+                for (auto& pair : _tracker->getMapLocations(mapname)) {
+                    if (lastLocation != pair.first) {
+                        lastLocation = pair.first;
+                        n = 0;
+                    }
+                    refs.push_back({std::move(pair.first), std::move(pair.second), n++});
+                    auto& ref = refs.back();
+                    ref.recheck = !ref.mapLocation.getVisibilityRules().empty()
+                            || !ref.mapLocation.getInvisibilityRules().empty();
+                    for (const auto& sec: _tracker->getLocation(ref.location).getSections()) {
+                        const auto& realSec = sec.getRef().empty() ? sec : _tracker->getLocationSection(sec.getRef());
+                        if (!realSec.getHostedItems().empty())
+                            ref.recheck = true; // hosted items' state is not part of the logic cache
+                    }
+                }
+            } else {
+                for (auto& ref: refs)
+                    ref.pushed = false; // new widget needs all states
+            }
+            for (const auto& ref : refs) {
                 // NOTE: state and highlight are set later
-                w->addLocation(pair.first, {
-                    pair.second.getX(), pair.second.getY(),
-                    pair.second.getSize(map.getLocationSize()),
-                    pair.second.getBorderThickness(map.getLocationBorderThickness()),
-                    pair.second.getShape(map.getLocationShape()),
+                w->addLocation(ref.location, {
+                    ref.mapLocation.getX(), ref.mapLocation.getY(),
+                    ref.mapLocation.getSize(map.getLocationSize()),
+                    ref.mapLocation.getBorderThickness(map.getLocationBorderThickness()),
+                    ref.mapLocation.getShape(map.getLocationShape()),
                 });
             }
 #ifndef NDEBUG
@@ -12,6 +12,8 @@
 #include "../core/tracker.h"
 #include <list>
 #include <map>
+#include <unordered_set>
+#include <vector>
 
 namespace Ui {
 
@@ -65,6 +67,20 @@ protected:
     int _absY=0;
     std::map<std::string, std::list<Item*>> _items;
     std::map<std::string, std::list<MapWidget*>> _maps;
+
+    /// Map location of a map, built once per layout. Remembers what was last pushed to the map's widgets.
+    struct MapLocationRef final {
+        std::string location;
+        Location::MapLocation mapLocation;
+        size_t n; // nth map location of the same location on the same map
+        bool pushed = false;
+        int state = -1;
+        Highlight highlight = Highlight::NONE;
+        bool recheck = false; // hosts items or has visibility rules of its own, so it is checked on every update
+    };
+    std::map<std::string, std::vector<MapLocationRef>> _mapLocations;
+    std::unordered_set<std::string> _changedLocations; // locations to push on the next update
+    bool _allLocationsChanged = true;
     bool _mapsDirty = false;
     bool _mapTooltipDirty = false;
     std::list<Tabs*> _tabs;
@@ -75,6 +91,7 @@ protected:
     bool _hideUnreachableLocations = false;
 
     int _defaultItemQuality = -1;
+    std::string _imageScope; ///< unique per TrackerView, so textures are not shared across packs
     int _defaultMapQuality = 2; // default smooth
 
     void updateLayout(const std::string& layout);
@@ -84,6 +101,7 @@ protected:
     void updateLocationsNow();
     void updateLocation(const std::string& location);
     void updateLocationNow(const std::string& location);
+    bool pushLocationStates(const std::unordered_set<std::string>* locations);
     void updateMapTooltip();
     void updateMapTooltipNow();
     void updateItem(Item* w, const BaseItem& item);
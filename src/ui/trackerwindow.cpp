@@ -94,6 +94,7 @@ void TrackerWindow::setSize(Size size)
     // don't resize multiple times per frame -> schedule resize instead
     _resizeSize = size;
     _resizeScheduled = true;
+    markDirty();
 }
 
 void TrackerWindow::setHideClearedLocations(bool hide)
@@ -26,7 +26,7 @@ public:
     
     std::list< std::pair<std::string,std::string> > getHints() const;
 
-    virtual void setCenterPosition(const Position& pos) { _centerPos = pos; }
+    virtual void setCenterPosition(const Position& pos) { _centerPos = pos; markDirty(); }
 
     void setHideClearedLocations(bool hide);
     void unsetHideClearedLocations();
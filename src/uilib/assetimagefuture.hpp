@@ -14,7 +14,7 @@
 namespace Ui {
 
 class AssetImageFuture final : public ImageFuture {
-    using TaskQueueType = pop::TaskQueue<SDL_Surface*>;
+    using TaskQueueType = ImageTaskQueue;
     using TaskQueue = pop::Singleton<TaskQueueType>;
     static constexpr size_t NO_TASK = TaskQueueType::NO_TASK;
 
@@ -29,7 +29,7 @@ class AssetImageFuture final : public ImageFuture {
         if (_taskNumber != NO_TASK) {
             // try to cancel and process in foreground, otherwise wait for background result
             if (TaskQueue::get().cancel(_taskNumber)) {
-                _surface = LoadImage(_path);
+                _surface = process(LoadImage(_path));
             } else {
                 _surface = TaskQueue::get().get(_taskNumber);
             }
@@ -60,12 +60,10 @@ public:
         readFile(_path, data, getMaxImageHeaderLength());
         _size = getImageSize(data);
         _taskNumber = TaskQueue::get().enqueue([this] {
-            return LoadImage(_path);
+            return process(LoadImage(_path));
         });
     }
 
-    AssetImageFuture(AssetImageFuture&&) = default;
-
     AssetImageFuture(const AssetImageFuture&) = delete;
 
     ~AssetImageFuture() override
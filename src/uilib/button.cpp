@@ -48,6 +48,7 @@ void Button::setIcon(const void* data, size_t len)
         _autoSize.width += (ICON_SIZE + _padding);
         _minSize.width += (ICON_SIZE + _padding);
     }
+    markDirty();
 }
 
 void Button::render(Renderer renderer, int offX, int offY)
@@ -19,7 +19,7 @@ public:
     virtual void render(Renderer renderer, int offX, int offY);
     virtual void setText(const std::string& text);
     void setIcon(const void* data, size_t len);
-    void setState(State state) { _state = state; }
+    void setState(State state) { if (state != _state) { _state = state; markDirty(); } }
     bool getPressed() const { return _state == State::AUTO ? _autoState : (bool)_state; }
 
     static constexpr int ICON_SIZE = 17;
@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <SDL2/SDL.h>
+#include "colorkernels.h"
 #include "imghelper.h"
 
 
@@ -237,7 +238,8 @@ SDL_Surface *setSaturation(SDL_Surface *surf, const float saturation)
             SDL_UnlockSurface(surf);
     }
     else if (surf->format->BytesPerPixel > 0 && surf->format->BytesPerPixel < 5) {
-        _setSaturationRGB<mode, darken>(surf, saturation);
+        if (!ColorKernels::setSaturation(surf, mode, darken, saturation))
+            _setSaturationRGB<mode, darken>(surf, saturation);
         if (SDL_MUSTLOCK(surf))
             SDL_UnlockSurface(surf);
     }
@@ -291,7 +293,8 @@ SDL_Surface *setBrightness(SDL_Surface *surf, const float brightness)
             SDL_UnlockSurface(surf);
     }
     else if (surf->format->BytesPerPixel > 0 && surf->format->BytesPerPixel < 5) {
-        _setBrightnessRGB(surf, brightness);
+        if (!ColorKernels::setBrightness(surf, brightness))
+            _setBrightnessRGB(surf, brightness);
         if (SDL_MUSTLOCK(surf))
             SDL_UnlockSurface(surf);
     }
@@ -0,0 +1,425 @@
+#include "colorkernels.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "colorhelper.h"
+
+
+#if defined(__x86_64__) || defined(__SSE2__) || defined(__aarch64__) || defined(__ARM_NEON)
+#define COLORKERNELS_VECTOR128
+#endif
+#if (defined(__x86_64__) || defined(__i386__)) && defined(COLORKERNELS_VECTOR128)
+#define COLORKERNELS_AVX2
+#endif
+
+
+namespace Ui {
+
+namespace ColorKernels {
+
+// The kernels are written once as templates over the pixel type V, which is either uint32_t for the scalar tail
+// or a GCC/clang vector of uint32_t. Vectors of 4 lanes compile to SSE2/NEON, vectors of 8 lanes to AVX2 inside
+// functions that have the avx2 target attribute.
+
+#define KERNEL_INLINE inline __attribute__((always_inline))
+
+// functions taking 8 lane vectors are always inlined into runAVX2, so their calling convention does not matter
+#if defined(__clang__)
+#if __has_warning("-Wpsabi")
+#pragma clang diagnostic ignored "-Wpsabi"
+#endif
+#elif defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+typedef int32_t i32x4 __attribute__((vector_size(16)));
+typedef float f32x4 __attribute__((vector_size(16)));
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+typedef int32_t i32x8 __attribute__((vector_size(32)));
+typedef float f32x8 __attribute__((vector_size(32)));
+
+// values are always 0..255 when converting to float, so going through int is exact and fast
+
+static KERNEL_INLINE float toFloat(uint32_t v)
+{
+    return static_cast<float>(static_cast<int32_t>(v));
+}
+
+static KERNEL_INLINE f32x4 toFloat(u32x4 v)
+{
+    return __builtin_convertvector((i32x4)v, f32x4);
+}
+
+static KERNEL_INLINE f32x8 toFloat(u32x8 v)
+{
+    return __builtin_convertvector((i32x8)v, f32x8);
+}
+
+// truncates like the static_cast<uint8_t>(float) in colorhelper.h does
+
+static KERNEL_INLINE uint32_t toByte(float v)
+{
+    return static_cast<uint32_t>(static_cast<int32_t>(v)) & 0xff;
+}
+
+static KERNEL_INLINE u32x4 toByte(f32x4 v)
+{
+    return (u32x4)__builtin_convertvector(v, i32x4) & 0xff;
+}
+
+static KERNEL_INLINE u32x8 toByte(f32x8 v)
+{
+    return (u32x8)__builtin_convertvector(v, i32x8) & 0xff;
+}
+
+// same as std::min(limit, v)
+
+static KERNEL_INLINE float minLimit(float v, float limit)
+{
+    return std::min(limit, v);
+}
+
+template<class F>
+static KERNEL_INLINE F minLimit(F v, float limit)
+{
+    const F l = F{} + limit;
+    const auto mask = v < l;
+    return (F)(((decltype(mask))v & mask) | ((decltype(mask))l & ~mask));
+}
+
+/// Byte offsets of R, G and B in the pixel.
+struct Channels final {
+    unsigned r;
+    unsigned g;
+    unsigned b;
+    uint32_t rgbMask;
+
+    template<class V>
+    KERNEL_INLINE V pack(V r_, V g_, V b_) const
+    {
+        return (r_ << r) | (g_ << g) | (b_ << b);
+    }
+};
+
+/// Same as makeGreyscale<mode, darken>(r, g, b), with the divisions replaced by exact multiply and shift.
+template<BWMode mode, bool darken, class V>
+static KERNEL_INLINE V grey(V r, V g, V b)
+{
+    static_assert(mode == BWMode::Luminosity || mode == BWMode::Average, "unsupported mode");
+    if constexpr (mode == BWMode::Luminosity) {
+        V v = r * 21u + g * 72u + b * 7u;
+        if constexpr (darken)
+            v = ((v * 2u + 1u) * 43691u) >> 17; // x/3 for x < 98304
+        return ((v + 50u) * 5243u) >> 19; // x/100 for x < 43699
+    } else {
+        V v = r + g + b;
+        if constexpr (darken)
+            v = ((v * 2u + 1u) * 43691u) >> 17; // x/3
+        return ((v * 2u + 3u) * 43691u) >> 18; // x/6 for x < 196608
+    }
+}
+
+template<BWMode mode, bool darken>
+struct GreyscaleOp final {
+    Channels ch;
+
+    template<class V>
+    KERNEL_INLINE V operator()(V px) const
+    {
+        const V w = grey<mode, darken>((px >> ch.r) & 0xffu, (px >> ch.g) & 0xffu, (px >> ch.b) & 0xffu);
+        return (px & ~ch.rgbMask) | ch.pack(w, w, w);
+    }
+};
+
+template<BWMode mode, bool darken>
+struct SaturationOp final {
+    Channels ch;
+    float saturation;
+    float inverse;
+
+    template<class V>
+    KERNEL_INLINE V operator()(V px) const
+    {
+        const V r = (px >> ch.r) & 0xffu;
+        const V g = (px >> ch.g) & 0xffu;
+        const V b = (px >> ch.b) & 0xffu;
+        const auto fw = toFloat(grey<mode, darken>(r, g, b));
+        return (px & ~ch.rgbMask) | ch.pack(
+                toByte(toFloat(r) * saturation + fw * inverse),
+                toByte(toFloat(g) * saturation + fw * inverse),
+                toByte(toFloat(b) * saturation + fw * inverse));
+    }
+};
+
+struct BrightnessOp final {
+    Channels ch;
+    float brightness;
+
+    template<class V>
+    KERNEL_INLINE V operator()(V px) const
+    {
+        const V r = (px >> ch.r) & 0xffu;
+        const V g = (px >> ch.g) & 0xffu;
+        const V b = (px >> ch.b) & 0xffu;
+        return (px & ~ch.rgbMask) | ch.pack(
+                toByte(minLimit(toFloat(r) * brightness, 255.f)),
+                toByte(minLimit(toFloat(g) * brightness, 255.f)),
+                toByte(minLimit(toFloat(b) * brightness, 255.f)));
+    }
+};
+
+struct BlendOp final {
+    template<class V>
+    static KERNEL_INLINE V div255(V x)
+    {
+        // rounded x/255 for x <= 255*255
+        x += 128u;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    template<class V>
+    KERNEL_INLINE V operator()(V src, V dst) const
+    {
+        const V sa = src >> 24;
+        const V ia = 255u - sa;
+        V res = (sa + div255((dst >> 24) * ia)) << 24;
+        for (unsigned shift = 0; shift < 24; shift += 8) {
+            const V s = (src >> shift) & 0xffu;
+            const V d = (dst >> shift) & 0xffu;
+            res |= div255(s * sa + d * ia) << shift;
+        }
+        return res;
+    }
+};
+
+/// Runs op on every pixel of the surface, N at a time where possible.
+template<class V, class Op>
+static KERNEL_INLINE void forEachPixel(SDL_Surface* surf, const Op& op)
+{
+    constexpr int n = sizeof(V) / sizeof(uint32_t);
+    auto* data = static_cast<uint8_t*>(surf->pixels);
+    for (int y = 0; y < surf->h; y++) {
+        auto* row = reinterpret_cast<uint32_t*>(data + y * surf->pitch);
+        int x = 0;
+        if constexpr (n > 1) {
+            for (; x + n <= surf->w; x += n) {
+                V v;
+                memcpy(&v, row + x, sizeof(v));
+                v = op(v);
+                memcpy(row + x, &v, sizeof(v));
+            }
+        }
+        for (; x < surf->w; x++)
+            row[x] = op(row[x]);
+    }
+}
+
+/// Runs op on every pair of pixels of the overlapping area, N at a time where possible.
+template<class V, class Op>
+static KERNEL_INLINE void forEachPixel(const SDL_Surface* src, SDL_Surface* dst, const Op& op)
+{
+    constexpr int n = sizeof(V) / sizeof(uint32_t);
+    const int w = std::min(src->w, dst->w);
+    const int h = std::min(src->h, dst->h);
+    const auto* srcData = static_cast<const uint8_t*>(src->pixels);
+    auto* dstData = static_cast<uint8_t*>(dst->pixels);
+    for (int y = 0; y < h; y++) {
+        const auto* srcRow = reinterpret_cast<const uint32_t*>(srcData + y * src->pitch);
+        auto* dstRow = reinterpret_cast<uint32_t*>(dstData + y * dst->pitch);
+        int x = 0;
+        if constexpr (n > 1) {
+            for (; x + n <= w; x += n) {
+                V s, d;
+                memcpy(&s, srcRow + x, sizeof(s));
+                memcpy(&d, dstRow + x, sizeof(d));
+                d = op(s, d);
+                memcpy(dstRow + x, &d, sizeof(d));
+            }
+        }
+        for (; x < w; x++)
+            dstRow[x] = op(srcRow[x], dstRow[x]);
+    }
+}
+
+template<class... Args>
+static void runScalar(Args&&... args)
+{
+    forEachPixel<uint32_t>(args...);
+}
+
+#ifdef COLORKERNELS_VECTOR128
+template<class... Args>
+static void runVector128(Args&&... args)
+{
+    forEachPixel<u32x4>(args...);
+}
+#endif
+
+#ifdef COLORKERNELS_AVX2
+template<class... Args>
+__attribute__((target("avx2")))
+static void runAVX2(Args&&... args)
+{
+    forEachPixel<u32x8>(args...);
+}
+#endif
+
+static Level detectLevel()
+{
+#ifdef COLORKERNELS_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return Level::AVX2;
+#endif
+#ifdef COLORKERNELS_VECTOR128
+    return Level::Vector128;
+#else
+    return Level::Scalar;
+#endif
+}
+
+static std::atomic<Level>& currentLevel()
+{
+    static std::atomic<Level> level{getSupportedLevel()};
+    return level;
+}
+
+template<class... Args>
+static void run(Args&&... args)
+{
+    switch (getLevel()) {
+#ifdef COLORKERNELS_AVX2
+        case Level::AVX2:
+            runAVX2(args...);
+            return;
+#endif
+#ifdef COLORKERNELS_VECTOR128
+        case Level::Vector128:
+            runVector128(args...);
+            return;
+#endif
+        default:
+            runScalar(args...);
+    }
+}
+
+Level getSupportedLevel()
+{
+    static const Level level = detectLevel();
+    return level;
+}
+
+Level getLevel()
+{
+    return currentLevel().load(std::memory_order_relaxed);
+}
+
+void setLevel(Level level)
+{
+    currentLevel() = std::min(level, getSupportedLevel());
+}
+
+const char* getLevelName(const Level level)
+{
+    switch (level) {
+        case Level::AVX2:
+            return "AVX2";
+        case Level::Vector128:
+#if defined(__aarch64__) || defined(__ARM_NEON)
+            return "NEON";
+#else
+            return "SSE2";
+#endif
+        default:
+            return "Scalar";
+    }
+}
+
+bool isSupported(const SDL_PixelFormat* fmt)
+{
+    if (!fmt || fmt->BytesPerPixel != 4 || fmt->palette || fmt->Rloss || fmt->Gloss || fmt->Bloss)
+        return false;
+    // R, G and B have to be in different bytes of the lower 24 bits
+    if (fmt->Rshift > 16 || fmt->Gshift > 16 || fmt->Bshift > 16
+            || fmt->Rshift % 8 || fmt->Gshift % 8 || fmt->Bshift % 8)
+        return false;
+    return fmt->Rshift != fmt->Gshift && fmt->Rshift != fmt->Bshift && fmt->Gshift != fmt->Bshift;
+}
+
+static Channels getChannels(const SDL_PixelFormat* fmt)
+{
+    return {fmt->Rshift, fmt->Gshift, fmt->Bshift, fmt->Rmask | fmt->Gmask | fmt->Bmask};
+}
+
+template<BWMode mode, bool darken>
+static void setSaturation(SDL_Surface* surf, const Channels& ch, const float saturation)
+{
+    if (saturation == 0.f)
+        run(surf, GreyscaleOp<mode, darken>{ch});
+    else
+        run(surf, SaturationOp<mode, darken>{ch, saturation, 1.f - saturation});
+}
+
+bool setSaturation(SDL_Surface* surf, const BWMode mode, const bool darken, const float saturation)
+{
+    if (!surf || !isSupported(surf->format))
+        return false;
+    const auto ch = getChannels(surf->format);
+    if (mode == BWMode::Luminosity) {
+        if (darken)
+            setSaturation<BWMode::Luminosity, true>(surf, ch, saturation);
+        else
+            setSaturation<BWMode::Luminosity, false>(surf, ch, saturation);
+        return true;
+    }
+    if (mode == BWMode::Average) {
+        if (darken)
+            setSaturation<BWMode::Average, true>(surf, ch, saturation);
+        else
+            setSaturation<BWMode::Average, false>(surf, ch, saturation);
+        return true;
+    }
+    return false;
+}
+
+bool setBrightness(SDL_Surface* surf, const float brightness)
+{
+    if (!surf || !isSupported(surf->format))
+        return false;
+    run(surf, BrightnessOp{getChannels(surf->format), brightness});
+    return true;
+}
+
+bool blend(SDL_Surface* src, SDL_Surface* dst)
+{
+    if (!src || !dst || !isSupported(src->format) || !isSupported(dst->format))
+        return false;
+    if (src->format->format != dst->format->format || src->format->Amask != 0xff000000u
+            || dst->format->Amask != 0xff000000u)
+        return false;
+    SDL_BlendMode blendMode;
+    Uint8 alphaMod, r, g, b;
+    if (SDL_GetSurfaceBlendMode(src, &blendMode) != 0 || blendMode != SDL_BLENDMODE_BLEND)
+        return false;
+    if (SDL_HasColorKey(src) || SDL_GetSurfaceAlphaMod(src, &alphaMod) != 0 || alphaMod != 0xff)
+        return false;
+    if (SDL_GetSurfaceColorMod(src, &r, &g, &b) != 0 || r != 0xff || g != 0xff || b != 0xff)
+        return false;
+    if (SDL_MUSTLOCK(src) && SDL_LockSurface(src) != 0)
+        return false;
+    if (SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) != 0) {
+        if (SDL_MUSTLOCK(src))
+            SDL_UnlockSurface(src);
+        return false;
+    }
+    run(static_cast<const SDL_Surface*>(src), dst, BlendOp{});
+    if (SDL_MUSTLOCK(dst))
+        SDL_UnlockSurface(dst);
+    if (SDL_MUSTLOCK(src))
+        SDL_UnlockSurface(src);
+    return true;
+}
+
+} // namespace ColorKernels
+
+} // namespace Ui
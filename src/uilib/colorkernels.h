@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+
+namespace Ui {
+
+enum class BWMode;
+
+/// Vectorized filters for surfaces with 32bit pixels and 8bit color channels (ARGB8888, ABGR8888, ...).
+/// The instruction set is selected at runtime. Results are identical to the per-pixel code in colorhelper.h,
+/// which falls back to it for other formats.
+namespace ColorKernels {
+
+enum class Level {
+    Scalar,
+    Vector128, // SSE2 on x86, NEON on ARM
+    AVX2,
+};
+
+/// Returns the best level supported by the CPU.
+Level getSupportedLevel();
+/// Returns the level currently used by the kernels.
+Level getLevel();
+/// Overrides the level for tests and benchmarks. Levels not supported by the CPU are lowered.
+void setLevel(Level level);
+const char* getLevelName(Level level);
+
+/// Returns true if the kernels can process surfaces of this format.
+bool isSupported(const SDL_PixelFormat* fmt);
+
+// Functions return false if the surface is not supported.
+
+/// Same as _setSaturationRGB; the surface has to be locked. BWMode::Lightness is not supported.
+bool setSaturation(SDL_Surface* surf, BWMode mode, bool darken, float saturation);
+/// Same as _setBrightnessRGB; the surface has to be locked.
+bool setBrightness(SDL_Surface* surf, float brightness);
+/// Alpha-blends src onto dst at 0,0 like SDL_BlitSurface with SDL_BLENDMODE_BLEND, rounding may differ by 1.
+/// Only supports src and dst of the same format with alpha, and src without color key or color/alpha mod.
+bool blend(SDL_Surface* src, SDL_Surface* dst);
+
+} // namespace ColorKernels
+
+} // namespace Ui
@@ -22,6 +22,7 @@ public:
     virtual void addChild(Widget* child) {
         if (!child) return;
         _children.push_back(child);
+        adoptChild(child);
         if (child->getHGrow()>_hGrow) _hGrow = child->getHGrow();
         if (child->getVGrow()>_vGrow) _vGrow = child->getVGrow();
     }
@@ -37,6 +38,7 @@ public:
             child->onMouseCancel.emit(child);
         }
         _children.erase(std::remove(_children.begin(), _children.end(), child), _children.end());
+        releaseChild(child);
         if ((_hGrow>0 && child->getHGrow()>=_hGrow) || (_vGrow>0 && child->getVGrow()>=_vGrow)) {
             int oldHGrow = _hGrow; int oldVGrow = _vGrow;
             _hGrow = 0; _vGrow = 0;
@@ -63,9 +65,13 @@ public:
             _pressedChild = nullptr;
         }
         for (const auto child : _children) {
+            child->_parent = nullptr;
             delete child;
         }
-        _children.clear();
+        if (!_children.empty()) {
+            _children.clear();
+            markDirty();
+        }
     }
 
     virtual void raiseChild(Widget* child) {
@@ -74,6 +80,7 @@ public:
             if (*it == child) {
                 _children.erase(it);
                 _children.push_back(child);
+                markDirty();
                 return;
             }
         }
@@ -142,6 +149,22 @@ public:
 
 protected:
     std::deque<Widget*> _children;
+
+    /// Link a child that was added to _children, so it can mark this container dirty.
+    void adoptChild(Widget* child)
+    {
+        child->_parent = this;
+        markDirty();
+    }
+
+    /// Unlink a child that was removed from _children.
+    void releaseChild(Widget* child)
+    {
+        if (child->_parent == this)
+            child->_parent = nullptr;
+        markDirty();
+    }
+
     Widget* _hoverChild = nullptr;
     Widget* _pressedChild = nullptr;
 
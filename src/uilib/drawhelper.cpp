@@ -1,38 +1,28 @@
 #include "drawhelper.h"
+#include "geometrybatch.h"
 #include "imghelper.h"
 #include "texturemanager.h"
 #include "../core/assets.h"
 
 namespace Ui {
 
-static SDL_Texture* getGlowTexture(Renderer renderer)
+SDL_Texture* getGlowTexture(Renderer renderer)
 {
     static fs::path glowAsset = asset("glow64.png");
     SDL_Texture* tex = TextureManager::get(renderer, glowAsset);
     return tex;
 }
 
-void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
+void drawRect(GeometryBatch& batch, Position pos, Size size, int borderWidth,
         Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC)
 {
-    SDL_Rect inner = {
-        pos.left, pos.top, size.width, size.height
-    };
-    SDL_Rect outer = {
-        pos.left-borderWidth, pos.top-borderWidth, size.width + 2*borderWidth, size.height + 2*borderWidth
-    };
-    SDL_Rect outerTop = {
-        outer.x, outer.y, outer.w, borderWidth
+    SDL_FRect inner = {
+        (float)pos.left, (float)pos.top, (float)size.width, (float)size.height
     };
-    SDL_Rect outerBot = {
-        outer.x, outer.y + outer.h - borderWidth, outer.w, borderWidth
-    };
-    SDL_Rect outerLeft = {
-        outer.x, outer.y, borderWidth, outer.h
-    };
-    SDL_Rect outerRight = {
-        outer.x + outer.w - borderWidth, outer.y, borderWidth, outer.h
+    SDL_FRect outer = {
+        inner.x - borderWidth, inner.y - borderWidth, inner.w + 2*borderWidth, inner.h + 2*borderWidth
     };
+    const SDL_Color borderColor = {0, 0, 0, 255};
 
     bool hasAlpha = topC.a != 0xff || leftC.a != 0xff || botC.a != 0xff || rightC.a != 0xff;
 
@@ -43,20 +33,17 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
 
     if (hasAlpha) {
         // we have to draw 4 individual lines for border
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderFillRect(renderer, &outerTop);
-        SDL_RenderFillRect(renderer, &outerBot);
-        SDL_RenderFillRect(renderer, &outerLeft);
-        SDL_RenderFillRect(renderer, &outerRight);
+        batch.addRect(outer.x, outer.y, outer.w, borderWidth, borderColor); // top
+        batch.addRect(outer.x, outer.y + outer.h - borderWidth, outer.w, borderWidth, borderColor); // bottom
+        batch.addRect(outer.x, outer.y, borderWidth, outer.h, borderColor); // left
+        batch.addRect(outer.x + outer.w - borderWidth, outer.y, borderWidth, outer.h, borderColor); // right
     } else {
         // border as bigger background rect
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderFillRect(renderer, &outer);
+        batch.addRect(outer.x, outer.y, outer.w, outer.h, borderColor);
     }
 
     if (!hasAlpha || (topC == leftC && leftC == botC && botC == rightC)) {
-        SDL_SetRenderDrawColor(renderer, botC.r, botC.g, botC.b, botC.a);
-        SDL_RenderFillRect(renderer, &inner);
+        batch.addRect(inner.x, inner.y, inner.w, inner.h, {botC.r, botC.g, botC.b, botC.a});
     } else if (botC == rightC) {
         SDL_Color botRightColor = {botC.r, botC.g, botC.b, botC.a};
         SDL_Vertex botRightVerts[] = {
@@ -64,7 +51,7 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx, fy + fh}, botRightColor, {0, 0}},
             {{fx + fw, fy + fh}, botRightColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, botRightVerts, 3, nullptr, 0);
+        batch.add(botRightVerts, 3);
     } else {
         SDL_Color botColor = {botC.r, botC.g, botC.b, botC.a};
         SDL_Vertex botVerts[] = {
@@ -72,7 +59,7 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx + fw, fy + fw}, botColor, {0, 0}},
             {{fx + fw/2, fy + fh/2}, botColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, botVerts, 3, nullptr, 0);
+        batch.add(botVerts, 3);
     }
 
     if (botC != rightC) {
@@ -82,7 +69,7 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx + fw/2, fy + fh/2}, rightColor, {0, 0}},
             {{fx + fw, fy + fh}, rightColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, rightVerts, 3, nullptr, 0);
+        batch.add(rightVerts, 3);
     }
 
     if (topC == leftC && topC != botC) {
@@ -92,7 +79,7 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx, fy + fh}, topLeftColor, {0, 0}},
             {{fx + fw, fy}, topLeftColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, topLeftVerts, 3, nullptr, 0);
+        batch.add(topLeftVerts, 3);
     }
 
     if (topC != leftC && topC != botC) {
@@ -102,7 +89,7 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx + fw/2, fy + fh/2}, topColor, {0, 0}},
             {{fx + fw, fy}, topColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, topVerts, 3, nullptr, 0);
+        batch.add(topVerts, 3);
     }
 
     if (leftC != topC && leftC != botC) {
@@ -112,11 +99,11 @@ void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
             {{fx, fy + fh}, leftColor, {0, 0}},
             {{fx + fw/2, fy + fh/2}, leftColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, leftVerts, 3, nullptr, 0);
+        batch.add(leftVerts, 3);
     }
 }
 
-void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
+void drawDiamond(GeometryBatch& batch, Position pos, Size size, int borderWidth,
         Widget::Color tlC, Widget::Color blC, Widget::Color brC, Widget::Color trC)
 {
     bool hasAlpha = tlC.a != 0xff || blC.a != 0xff || brC.a != 0xff || trC.a != 0xff;
@@ -133,7 +120,6 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
 
     if (hasAlpha) {
         // we have to draw 4 individual lines for border
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         float x1 = ol, x2 = ol + borderWidth, x3 = ol + ow/2, x4 = ol + ow - borderWidth, x5 = ol + ow;
         float y1 = ot, y2 = ot + borderWidth, y3 = ot + oh/2, y4 = ot + oh - borderWidth, y5 = ot + oh;
         SDL_Color borderColor = {0, 0, 0, 255};
@@ -157,7 +143,7 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
             1, 7, 6,
             7, 1, 0,
         };
-        SDL_RenderGeometry(renderer, nullptr, verts, 8, indices, 24);
+        batch.add(verts, 8, indices, 24);
     } else {
         // border as bigger background rect
         float x1 = ol, x2 = ol + ow/2, x3 = ol + ow;
@@ -173,7 +159,7 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
             0, 1, 2,
             2, 1, 3
         };
-        SDL_RenderGeometry(renderer, nullptr, verts, 4, indices, 6);
+        batch.add(verts, 4, indices, 6);
     }
 
     {
@@ -186,7 +172,7 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
                 {{x2, y3}, leftColor, {0, 0}},
                 {{x2, y1}, leftColor, {0, 0}},
             };
-            SDL_RenderGeometry(renderer, nullptr, verts, 3, nullptr, 0);
+            batch.add(verts, 3);
         } else {
             SDL_Color tlColor = {tlC.r, tlC.g, tlC.b, tlC.a};
             SDL_Color blColor = {blC.r, blC.g, blC.b, blC.a};
@@ -198,7 +184,7 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
                 {{x2, y3}, blColor, {0, 0}},
                 {{x2, y2}, blColor, {0, 0}},
             };
-            SDL_RenderGeometry(renderer, nullptr, verts, 6, nullptr, 0);
+            batch.add(verts, 6);
         }
 
         if (brC == trC) {
@@ -208,7 +194,7 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
                 {{x2, y3}, rightColor, {0, 0}},
                 {{x3, y2}, rightColor, {0, 0}},
             };
-            SDL_RenderGeometry(renderer, nullptr, verts, 3, nullptr, 0);
+            batch.add(verts, 3);
         } else {
             SDL_Color trColor = {trC.r, trC.g, trC.b, trC.a};
             SDL_Color brColor = {brC.r, brC.g, brC.b, brC.a};
@@ -220,12 +206,12 @@ void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
                 {{x2, y2}, brColor, {0, 0}},
                 {{x2, y3}, brColor, {0, 0}},
             };
-            SDL_RenderGeometry(renderer, nullptr, verts, 6, nullptr, 0);
+            batch.add(verts, 6);
         }
     }
 }
 
-void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
+void drawTrapezoid(GeometryBatch& batch, Position pos, Size size, int borderWidth,
         Widget::Color tC, Widget::Color lC, Widget::Color bC, Widget::Color rC)
 {
     bool hasAlpha = tC.a != 0xff || lC.a != 0xff || bC.a != 0xff || rC.a != 0xff;
@@ -266,7 +252,7 @@ void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
             7, 1, 6,
             7, 0, 1,
         };
-        SDL_RenderGeometry(renderer, nullptr, verts, 8, indices, 24);
+        batch.add(verts, 8, indices, 24);
     } else {
         // border as bigger background shape
         float x1 = ol, x3 = ol + ow/4, x6 = ol + 3*ow/4, x8 = ol + ow;
@@ -281,7 +267,7 @@ void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
             0, 3, 1,
             1, 3, 2
         };
-        SDL_RenderGeometry(renderer, nullptr, verts, 4, indices, 6);
+        batch.add(verts, 4, indices, 6);
     }
 
     {
@@ -306,11 +292,11 @@ void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
             {{x4, y1}, rColor, {0, 0}},
             {{x3, y2}, rColor, {0, 0}},
         };
-        SDL_RenderGeometry(renderer, nullptr, verts, 12, nullptr, 0);
+        batch.add(verts, 12);
     }
 }
 
-void drawRectGlow(Renderer renderer, const Position pos, const Size size, const Widget::Color color)
+void drawRectGlow(GeometryBatch& batch, const Position pos, const Size size, const Widget::Color color)
 {
     constexpr int glowSize = 10;
     const auto x1 = static_cast<float>(pos.left - glowSize);
@@ -371,13 +357,10 @@ void drawRectGlow(Renderer renderer, const Position pos, const Size size, const
         3, 12, 14,
     };
 
-    const auto tex = getGlowTexture(renderer);
-    if (!tex)
-        return;
-    SDL_RenderGeometry(renderer, tex, verts, std::size(verts), indices, std::size(indices));
+    batch.add(verts, (int)std::size(verts), indices, (int)std::size(indices));
 }
 
-void drawDiamondGlow(Renderer renderer, const Position pos, const Size size, const Widget::Color color)
+void drawDiamondGlow(GeometryBatch& batch, const Position pos, const Size size, const Widget::Color color)
 {
     constexpr float sqrtOf2 = 1.41421356237;
     constexpr int glowSize = 10;
@@ -450,13 +433,10 @@ void drawDiamondGlow(Renderer renderer, const Position pos, const Size size, con
         3, 12, 14,
     };
 
-    const auto tex = getGlowTexture(renderer);
-    if (!tex)
-        return;
-    SDL_RenderGeometry(renderer, tex, verts, std::size(verts), indices, std::size(indices));
+    batch.add(verts, (int)std::size(verts), indices, (int)std::size(indices));
 }
 
-void drawTrapezoidGlow(Renderer renderer, const Position pos, const Size size, const Widget::Color color)
+void drawTrapezoidGlow(GeometryBatch& batch, const Position pos, const Size size, const Widget::Color color)
 {
     constexpr int glowSize = 10;
     const float left2 = static_cast<float>(pos.left) + static_cast<float>(size.width) / 4;
@@ -530,10 +510,61 @@ void drawTrapezoidGlow(Renderer renderer, const Position pos, const Size size, c
         3, 12, 14,
     };
 
+    batch.add(verts, (int)std::size(verts), indices, (int)std::size(indices));
+}
+
+void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC)
+{
+    GeometryBatch batch;
+    drawRect(batch, pos, size, borderWidth, topC, leftC, botC, rightC);
+    batch.render(renderer, nullptr);
+}
+
+void drawRectGlow(Renderer renderer, Position pos, Size size, Widget::Color color)
+{
+    const auto tex = getGlowTexture(renderer);
+    if (!tex)
+        return;
+    GeometryBatch batch;
+    drawRectGlow(batch, pos, size, color);
+    batch.render(renderer, tex);
+}
+
+void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC)
+{
+    GeometryBatch batch;
+    drawDiamond(batch, pos, size, borderWidth, topC, leftC, botC, rightC);
+    batch.render(renderer, nullptr);
+}
+
+void drawDiamondGlow(Renderer renderer, Position pos, Size size, Widget::Color color)
+{
+    const auto tex = getGlowTexture(renderer);
+    if (!tex)
+        return;
+    GeometryBatch batch;
+    drawDiamondGlow(batch, pos, size, color);
+    batch.render(renderer, tex);
+}
+
+void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC)
+{
+    GeometryBatch batch;
+    drawTrapezoid(batch, pos, size, borderWidth, topC, leftC, botC, rightC);
+    batch.render(renderer, nullptr);
+}
+
+void drawTrapezoidGlow(Renderer renderer, Position pos, Size size, Widget::Color color)
+{
     const auto tex = getGlowTexture(renderer);
     if (!tex)
         return;
-    SDL_RenderGeometry(renderer, tex, verts, std::size(verts), indices, std::size(indices));
+    GeometryBatch batch;
+    drawTrapezoidGlow(batch, pos, size, color);
+    batch.render(renderer, tex);
 }
 
 } // namespace Ui
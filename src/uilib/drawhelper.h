@@ -4,19 +4,35 @@
 
 namespace Ui {
 
+class GeometryBatch;
+
+// The Renderer overloads draw right away, the GeometryBatch overloads only add triangles to the batch.
+// Glow has to be rendered with the texture returned by getGlowTexture.
+
+SDL_Texture* getGlowTexture(Renderer renderer);
+
 void drawRect(Renderer renderer, Position pos, Size size, int borderWidth,
         Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
+void drawRect(GeometryBatch& batch, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
 
 void drawRectGlow(Renderer renderer, Position pos, Size size, Widget::Color color);
+void drawRectGlow(GeometryBatch& batch, Position pos, Size size, Widget::Color color);
 
 void drawDiamond(Renderer renderer, Position pos, Size size, int borderWidth,
         Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
+void drawDiamond(GeometryBatch& batch, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
 
 void drawDiamondGlow(Renderer renderer, Position pos, Size size, Widget::Color color);
+void drawDiamondGlow(GeometryBatch& batch, Position pos, Size size, Widget::Color color);
 
 void drawTrapezoid(Renderer renderer, Position pos, Size size, int borderWidth,
         Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
+void drawTrapezoid(GeometryBatch& batch, Position pos, Size size, int borderWidth,
+        Widget::Color topC, Widget::Color leftC, Widget::Color botC, Widget::Color rightC);
 
 void drawTrapezoidGlow(Renderer renderer, Position pos, Size size, Widget::Color color);
+void drawTrapezoidGlow(GeometryBatch& batch, Position pos, Size size, Widget::Color color);
 
 } // namespace Ui
@@ -0,0 +1,48 @@
+#include "geometrybatch.h"
+#include <stdio.h>
+
+namespace Ui {
+
+void GeometryBatch::add(const SDL_Vertex* vertices, int numVertices, const int* indices, int numIndices)
+{
+    const int base = (int)_vertices.size();
+    _vertices.insert(_vertices.end(), vertices, vertices + numVertices);
+    if (indices) {
+        for (int i = 0; i < numIndices; i++)
+            _indices.push_back(base + indices[i]);
+    } else {
+        for (int i = 0; i < numVertices; i++)
+            _indices.push_back(base + i);
+    }
+}
+
+void GeometryBatch::addRect(float x, float y, float w, float h, SDL_Color color)
+{
+    const SDL_Vertex verts[] = {
+        {{x, y}, color, {0, 0}},
+        {{x + w, y}, color, {0, 0}},
+        {{x, y + h}, color, {0, 0}},
+        {{x + w, y + h}, color, {0, 0}},
+    };
+    const int indices[] = {
+        0, 2, 1,
+        1, 2, 3,
+    };
+    add(verts, 4, indices, 6);
+}
+
+int GeometryBatch::render(Renderer renderer, SDL_Texture* texture)
+{
+    if (_indices.empty()) {
+        clear();
+        return 0;
+    }
+    if (SDL_RenderGeometry(renderer, texture, _vertices.data(), (int)_vertices.size(),
+            _indices.data(), (int)_indices.size()) != 0) {
+        fprintf(stderr, "GeometryBatch: could not render: %s\n", SDL_GetError());
+    }
+    clear();
+    return 1;
+}
+
+} // namespace Ui
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include "widget.h"
+
+namespace Ui {
+
+/// Collects triangles to draw them with a single SDL_RenderGeometry call.
+/// Triangles are drawn in the order they were added.
+class GeometryBatch final {
+public:
+    /// Adds vertices and indices relative to them. Without indices, every 3 vertices form a triangle.
+    void add(const SDL_Vertex* vertices, int numVertices, const int* indices = nullptr, int numIndices = 0);
+    /// Adds a solid rect as 2 triangles.
+    void addRect(float x, float y, float w, float h, SDL_Color color);
+
+    /// Draws and clears the batch. Returns the number of SDL draw calls.
+    int render(Renderer renderer, SDL_Texture* texture);
+
+    void clear()
+    {
+        _vertices.clear();
+        _indices.clear();
+    }
+
+    bool empty() const
+    {
+        return _indices.empty();
+    }
+
+    size_t getTriangleCount() const
+    {
+        return _indices.size() / 3;
+    }
+
+private:
+    std::vector<SDL_Vertex> _vertices;
+    std::vector<int> _indices;
+};
+
+} // namespace Ui
@@ -119,6 +119,7 @@ void Image::clearImage()
     _surf = nullptr;
     _autoSize = {0, 0};
     _path.clear();
+    markDirty();
 }
 
 void Image::ensureTexture(Renderer renderer, const bool lazy)
@@ -128,6 +129,7 @@ void Image::ensureTexture(Renderer renderer, const bool lazy)
         _future.reset();
     } else if (_future) {
         _future->prioritize();
+        markDirty(); // poll again next frame
     }
     if (!_tex && _surf) {
         if (_quality >= 0) {
@@ -209,6 +211,7 @@ void Image::setDarkenGreyscale(const bool value)
         SDL_DestroyTexture(_texBw);
     _tex = nullptr;
     _texBw = nullptr;
+    markDirty();
 }
 
 } // namespace
@@ -94,7 +94,16 @@ SDL_Surface* ImageFilter::apply(SDL_Surface *surf) const
                     overlay = ImageFilter(arg).apply(overlay);
                 }
             }
-            SDL_BlitSurface(overlay, nullptr, surf, nullptr);
+            if (overlay->format->format != surf->format->format && overlay->format->Amask
+                    && ColorKernels::isSupported(surf->format) && surf->format->Amask) {
+                // converting first is cheaper than blitting between formats and allows the vectorized blend
+                if (SDL_Surface* converted = SDL_ConvertSurface(overlay, surf->format, 0)) {
+                    SDL_FreeSurface(overlay);
+                    overlay = converted;
+                }
+            }
+            if (!ColorKernels::blend(overlay, surf))
+                SDL_BlitSurface(overlay, nullptr, surf, nullptr);
             SDL_FreeSurface(overlay);
         }
         else {
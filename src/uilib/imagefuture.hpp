@@ -1,17 +1,39 @@
 #pragma once
 
+#include <functional>
+#include <mutex>
 #include <SDL2/SDL_surface.h>
 #include "size.h"
+#include "../core/taskqueue.hpp"
 
 namespace Ui {
 
+/// Background queue shared by all image futures, one worker per core.
+class ImageTaskQueue final : public pop::TaskQueue<SDL_Surface*> {
+public:
+    ImageTaskQueue()
+        : TaskQueue(getHardwareConcurrency())
+    {
+    }
+};
+
 class ImageFuture {
 protected:
     ImageFuture() = default;
 
+    /// To be called by implementations on the decoded surface, runs the processor if one was set.
+    SDL_Surface* process(SDL_Surface* surf)
+    {
+        std::lock_guard lock(_processorMutex);
+        _processed = true;
+        return _processor ? _processor(surf) : surf;
+    }
+
 public:
+    using Processor = std::function<SDL_Surface*(SDL_Surface*)>;
+
     ImageFuture(const ImageFuture&) = delete;
-    ImageFuture(ImageFuture&&) = default;
+    ImageFuture(ImageFuture&&) = delete; // tasks refer to this
     virtual ~ImageFuture() = default;
 
     /// Reads necessary data to calculate the size and returns it, blocks if not available yet.
@@ -26,6 +48,22 @@ public:
     virtual void prioritize() = 0;
     /// Cancel any ongoing processing, may block. Important: cancel in the destructor.
     virtual void cancel() = 0;
+
+    /// Sets a function that post-processes the surface on the decoding thread.
+    /// Returns false if the surface was already decoded, in which case the caller has to process it.
+    bool setProcessor(Processor processor)
+    {
+        std::lock_guard lock(_processorMutex);
+        if (_processed)
+            return false;
+        _processor = std::move(processor);
+        return true;
+    }
+
+private:
+    std::mutex _processorMutex;
+    Processor _processor;
+    bool _processed = false;
 };
 
 } // namespace Ui
@@ -96,6 +96,7 @@ void Label::setText(const std::string& text)
     _minSize = _autoSize; // until we support stretching or ellipsis
     if (_tex) SDL_DestroyTexture(_tex);
     _tex = nullptr;
+    markDirty();
 }
 
 void Label::setTextColor(Widget::Color c)
@@ -104,6 +105,7 @@ void Label::setTextColor(Widget::Color c)
     _textColor = c;
     if (_tex) SDL_DestroyTexture(_tex);
     _tex = nullptr;
+    markDirty();
 }
 
 
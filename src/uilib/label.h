@@ -36,7 +36,7 @@ protected:
     
 public:
     virtual void setText(const std::string& text);
-    virtual void setTextAlignment(HAlign halign, VAlign valign) { _halign = halign; _valign = valign; }
+    virtual void setTextAlignment(HAlign halign, VAlign valign) { _halign = halign; _valign = valign; markDirty(); }
     virtual void setTextColor(Widget::Color c);
     const std::string& getText() const { return _text; }
     const Widget::Color getTextColor() const { return _textColor; }
@@ -71,6 +71,7 @@ void ProgressBar::render(Renderer renderer, const int offX, const int offY)
         r.w = x3 - x2;
         SDL_SetRenderDrawColor(renderer, c2.r, c2.g, c2.b, 63);
         SDL_RenderFillRect(renderer, &r);
+        markDirty(); // animated
     }
 }
 
@@ -79,6 +80,7 @@ void ProgressBar::setMax(const int max)
     if (_max == max)
         return;
     _max = max;
+    markDirty();
 }
 
 void ProgressBar::setProgress(const int progress)
@@ -86,6 +88,7 @@ void ProgressBar::setProgress(const int progress)
     if (_progress == progress)
         return;
     _progress = progress;
+    markDirty();
 }
 
 } // namespace
@@ -38,6 +38,7 @@ void Tabs::addChild(Widget* w)
 {
     w->setVisible(false);
     _children.push_back(w);
+    adoptChild(w);
     if (w->getHGrow() > _hGrow)
         _hGrow = w->getHGrow();
     auto* btn = new Button(0,0,0,0,_font,"Tab");
@@ -88,6 +89,7 @@ void Tabs::removeChild(Widget *w)
         for (; childIt!=_children.end(); ++childIt, ++buttonIt) {
             if (*childIt == w) {
                 _children.erase(childIt);
+                releaseChild(w);
                 if (buttonIt != _buttons.end()) {
                     _buttonbox->removeChild(*buttonIt);
                     delete (*buttonIt);
@@ -218,6 +220,7 @@ void Tabs::setSize(Size size)
     if (size.height < _minSize.height)
         size.height = _minSize.height;
     _size = size;
+    markDirty();
     relayout();
 }
 
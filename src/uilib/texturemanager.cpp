@@ -26,6 +26,21 @@ void TextureManager::remove(const Renderer renderer)
     getInstances().erase(renderer);
 }
 
+bool TextureManager::release(const Renderer renderer, SDL_Texture* tex)
+{
+    auto& instances = getInstances();
+    const auto it = instances.find(renderer);
+    if (it == instances.end())
+        return false;
+    return it->second.release(tex);
+}
+
+void TextureManager::purgeAll(const std::string& prefix)
+{
+    for (auto& pair: getInstances())
+        pair.second.purge(prefix);
+}
+
 TextureManager::TextureManager(Renderer renderer)
     : _renderer(renderer)
 {
@@ -51,4 +66,95 @@ SDL_Texture *TextureManager::get(const fs::path &path)
     return tex;
 }
 
+SDL_Texture* TextureManager::acquire(const std::string& key)
+{
+    const auto it = _shared.find(key);
+    if (it == _shared.end())
+        return nullptr;
+    auto& shared = it->second;
+    if (shared.refs++ == 0) {
+        _unused.erase(shared.unused);
+        _unusedBytes -= shared.bytes;
+    }
+    return shared.tex.get();
+}
+
+SDL_Texture* TextureManager::insert(const std::string& key, SDL_Texture* tex)
+{
+    if (!tex)
+        return nullptr;
+    if (_shared.find(key) != _shared.end()) {
+        SDL_DestroyTexture(tex);
+        return acquire(key);
+    }
+    int w = 0, h = 0;
+    SDL_QueryTexture(tex, nullptr, nullptr, &w, &h);
+    auto& shared = _shared[key];
+    shared.tex.reset(tex);
+    shared.bytes = (size_t)w * (size_t)h * 4;
+    shared.refs = 1;
+    _sharedKeys[tex] = key;
+    return tex;
+}
+
+bool TextureManager::release(SDL_Texture* tex)
+{
+    const auto keyIt = _sharedKeys.find(tex);
+    if (keyIt == _sharedKeys.end())
+        return false;
+    auto& shared = _shared[keyIt->second];
+    if (shared.refs > 0 && --shared.refs == 0) {
+        _unused.push_front(keyIt->second);
+        shared.unused = _unused.begin();
+        _unusedBytes += shared.bytes;
+        evict();
+    }
+    return true;
+}
+
+void TextureManager::purge(const std::string& prefix)
+{
+    for (auto it = _unused.begin(); it != _unused.end();) {
+        if (it->compare(0, prefix.length(), prefix) != 0) {
+            ++it;
+            continue;
+        }
+        const auto sharedIt = _shared.find(*it);
+        _unusedBytes -= sharedIt->second.bytes;
+        _sharedKeys.erase(sharedIt->second.tex.get());
+        _shared.erase(sharedIt);
+        it = _unused.erase(it);
+    }
+}
+
+void TextureManager::setBudget(size_t bytes)
+{
+    _budget = bytes;
+    evict();
+}
+
+void TextureManager::evict()
+{
+    while (_unusedBytes > _budget && !_unused.empty()) {
+        const auto it = _shared.find(_unused.back());
+        _unused.pop_back();
+        _unusedBytes -= it->second.bytes;
+        _sharedKeys.erase(it->second.tex.get());
+        _shared.erase(it);
+    }
+}
+
+std::string TextureManager::makeKey(const std::string& name, const std::list<ImageFilter>& filters, int quality)
+{
+    // \x1f does not appear in file names or filter arguments
+    std::string key = name;
+    for (const auto& filter: filters) {
+        key += "\x1f" + filter.name;
+        for (const auto& arg: filter.args)
+            key += "\x1e" + arg;
+    }
+    key += "\x1f" + std::to_string(quality);
+    return key;
+}
+
 } // namespace Ui
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <list>
 #include <map>
+#include <string>
+#include <unordered_map>
 #include <SDL2/SDL.h>
 
+#include "imagefilter.h"
 #include "widget.h"
 #include "../core/fs.h"
 
@@ -19,15 +23,53 @@ class TextureManager {
     Renderer _renderer;
     std::map<fs::path, std::unique_ptr<SDL_Texture, SDLTextureDeleter>> _textures;
 
+    /// Shared textures, see acquire and release
+    struct Shared {
+        std::unique_ptr<SDL_Texture, SDLTextureDeleter> tex;
+        size_t bytes = 0;
+        unsigned refs = 0;
+        std::list<std::string>::iterator unused; ///< position in _unused if refs == 0
+    };
+    std::unordered_map<std::string, Shared> _shared;
+    std::unordered_map<SDL_Texture*, std::string> _sharedKeys;
+    std::list<std::string> _unused; ///< unreferenced shared textures, most recently used first
+    size_t _unusedBytes = 0;
+    size_t _budget = DEFAULT_BUDGET;
+
+    void evict();
+
 public:
+    static constexpr size_t DEFAULT_BUDGET = 64 * 1024 * 1024; ///< bytes of unreferenced textures to keep around
+
     // TODO: move TextureManager instances inside Renderers
     static TextureManager& get(Renderer renderer);
     static SDL_Texture* get(Renderer renderer, const fs::path& path);
     static void remove(Renderer renderer);
+    /// Releases tex if it is a shared texture of renderer's TextureManager. Returns false if it is not.
+    static bool release(Renderer renderer, SDL_Texture* tex);
+    /// Destroys unreferenced shared textures with keys starting with prefix in all TextureManagers.
+    static void purgeAll(const std::string& prefix);
 
     explicit TextureManager(Renderer renderer);
 
     SDL_Texture* get(const fs::path& path);
+
+    /// Returns the shared texture for key and adds a reference to it, or nullptr if there is none.
+    SDL_Texture* acquire(const std::string& key);
+    /// Adds tex as shared texture for key with one reference and takes ownership.
+    /// If key already exists, tex is destroyed and the existing texture is acquired instead.
+    SDL_Texture* insert(const std::string& key, SDL_Texture* tex);
+    /// Drops a reference. Unreferenced textures are kept until the budget is exceeded, least recently used first.
+    bool release(SDL_Texture* tex);
+    /// Destroys unreferenced shared textures with keys starting with prefix, i.e. of a scope that went away.
+    void purge(const std::string& prefix);
+    /// Sets how many bytes of unreferenced shared textures are kept.
+    void setBudget(size_t bytes);
+    size_t getUnusedBytes() const { return _unusedBytes; }
+    size_t getSharedCount() const { return _shared.size(); }
+
+    /// Returns the key for a shared texture of image name with filters applied, created with scale quality.
+    static std::string makeKey(const std::string& name, const std::list<ImageFilter>& filters, int quality);
 };
 
 } // namespace Ui
@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <stdint.h>
 #include "../core/fileutil.h"
+#include "../core/wakeup.h"
 #include "droptype.h"
 #include "timer.h"
 
@@ -68,6 +69,15 @@ Ui::Ui(const char *name, bool fallbackRenderer)
     SDL_SetEventFilter(Ui::eventFilter, this);
 #endif
 
+    // worker threads wake up the event loop through a custom event
+    _wakeUpEventType = SDL_RegisterEvents(1);
+    if (_wakeUpEventType == (Uint32)-1) {
+        fprintf(stderr, "Ui: could not register wake up event: %s\n", SDL_GetError());
+        _wakeUpEventType = 0;
+    } else {
+        Wakeup::setCallback(&Ui::wakeUp);
+    }
+
     printf("Ui: Available renderers: ");
     int count = 0;
     for (int i=0; i<SDL_GetNumRenderDrivers(); i++) {
@@ -84,6 +94,7 @@ Ui::Ui(const char *name, bool fallbackRenderer)
 Ui::~Ui()
 {
     printf("Ui: Destroying UI...\n");
+    Wakeup::setCallback(nullptr);
     for (auto win: _windows)
         delete win.second;
     printf("Ui: Destroying SDL...\n");
@@ -129,6 +140,7 @@ int Ui::eventFilter(void* userdata, SDL_Event *ev)
             if (winit != ui->_windows.end()) {
                 // NOTE: calls below may push new events, looping is disabled using the try_lock above
                 winit->second->setSize({x,y});
+                winit->second->markDirty(); // framebuffer got resized
                 winit->second->render();
             }
             ui->_eventMutex.unlock();
@@ -137,10 +149,56 @@ int Ui::eventFilter(void* userdata, SDL_Event *ev)
     return 1; // add to queue
 }
 
+std::atomic<Uint32> Ui::_wakeUpEventType = 0;
+std::atomic_bool Ui::_wakeUpPending = false;
+
+void Ui::wakeUp()
+{
+    const Uint32 type = _wakeUpEventType;
+    if (!type || _wakeUpPending.exchange(true))
+        return; // not available or already in the queue
+    SDL_Event ev = {};
+    ev.type = type;
+    if (SDL_PushEvent(&ev) != 1)
+        _wakeUpPending = false;
+}
+
+void Ui::markDirty(const SDL_Event& ev)
+{
+    // Hover and scroll changes are marked by the widgets themselves.
+    // Everything that may change a lot at once or invalidates the framebuffer redraws the window.
+    Window::ID windowID = 0;
+    switch (ev.type) {
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            windowID = ev.button.windowID;
+            break;
+        case SDL_WINDOWEVENT:
+            windowID = ev.window.windowID;
+            break;
+        case SDL_DROPFILE:
+        case SDL_DROPTEXT:
+            windowID = ev.drop.windowID;
+            break;
+        case SDL_KEYDOWN: // hotkeys may change any window
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+            for (auto& pair: _windows)
+                pair.second->markDirty();
+            return;
+        default:
+            return;
+    }
+    auto winIt = _windows.find(windowID);
+    if (winIt != _windows.end())
+        winIt->second->markDirty();
+}
+
 bool Ui::render()
 {
     // FPS limiter:
-    // stay as long in the event loop as possible. sleep to switch tasks.
+    // stay as long in the event loop as possible. block in SDL while waiting for events.
+    // if no window needs to be redrawn, wait up to _maxIdleTime for input or a wake up instead.
     // if not using vsync redraw ASAP for destructive events
     // browser context/emscripten: similar to vsync, but waiting is bad
     
@@ -163,12 +221,30 @@ bool Ui::render()
     
     const uint32_t t0 = SDL_GetTicks(); // TODO: microseconds
     uint32_t t1;
+
+    bool idle = true;
+    for (const auto& pair: _windows) {
+        if (pair.second->isDirty()) {
+            idle = false;
+            break;
+        }
+    }
+    const uint32_t frameWait = (FRAME_TIME > _lastRenderDuration) ? FRAME_TIME - _lastRenderDuration : 0;
+    const uint32_t maxWait = (idle && _maxIdleTime > frameWait) ? _maxIdleTime : frameWait;
     
     do {
+        bool destructiveEvent = false;
+        bool gotEvent = false;
 #ifndef __EMSCRIPTEN__
-        SDL_Delay(1); // let the kernel switch tasks to fill the event queue
+        {
+            // block until there is an event or the frame/idle time is over
+            const uint32_t waited = SDL_GetTicks() - t0;
+            uint32_t timeout = (waited < maxWait) ? maxWait - waited : 0;
+            if (_globalMouseButtons && timeout > 1)
+                timeout = 1; // the work-around below polls the global mouse state
+            SDL_WaitEventTimeout(nullptr, (int)timeout);
+        }
 #endif
-        bool destructiveEvent = false;
         
         // Work around SDL eating mouse input when switching windows
         // read below at SDL_WINDOWEVENT_FOCUS_GAINED
@@ -203,6 +279,11 @@ bool Ui::render()
         
         SDL_Event ev;
         while (SDL_PollEvent(&ev)) {
+            gotEvent = true;
+            if (_wakeUpEventType && ev.type == _wakeUpEventType) {
+                _wakeUpPending = false;
+                continue;
+            }
             switch (ev.type) {
                 case SDL_QUIT: {
                     printf("Ui: Quit\n");
@@ -408,22 +489,27 @@ bool Ui::render()
                 #endif
             }
 
+            markDirty(ev);
             _lastEventType = ev.type;
         }
         t1 = SDL_GetTicks();
         #ifndef VSYNC
         if (destructiveEvent) break; // framebuffer destroyed -> redraw ASAP (unless VSYNC)
         #endif
+        if (idle && gotEvent) break; // input or wake up while idle -> let the application handle it
 #if defined __EMSCRIPTEN__
     } while (false); // waiting for events makes no sense in a browser context
 #else
-    } while (_fpsLimit && (FRAME_TIME>_lastRenderDuration && t1-t0+1 < FRAME_TIME-_lastRenderDuration)); // TODO: microseconds?
+    } while (_fpsLimit && t1-t0+1 < maxWait); // TODO: microseconds?
 #endif
     
     {
         EVENT_LOCK(this);
-        for (auto win: _windows)
+        for (auto win: _windows) {
+            if (!win.second->isDirty())
+                _framesSkipped++;
             win.second->render();
+        }
         EVENT_UNLOCK(this);
     }
 
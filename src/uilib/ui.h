@@ -7,6 +7,7 @@
 #include <string>
 #include <mutex>
 #include <list>
+#include <atomic>
 #include <stdint.h>
 
 
@@ -35,6 +36,14 @@ protected:
     unsigned _fpsLimit = 0;
     unsigned _hardwareFpsLimit = DEFAULT_FPS_LIMIT;
     unsigned _softwareFpsLimit = DEFAULT_SOFTWARE_FPS_LIMIT;
+    uint64_t _framesSkipped = 0; ///< window frames not drawn because nothing changed
+    unsigned _maxIdleTime = 0;
+
+    static std::atomic<Uint32> _wakeUpEventType;
+    static std::atomic_bool _wakeUpPending;
+    static void wakeUp();
+
+    void markDirty(const SDL_Event& ev);
 
     std::mutex _eventMutex;
     static int eventFilter(void *userdata, SDL_Event *event);
@@ -60,6 +69,16 @@ public:
         _softwareFpsLimit = sw_fps;
     }
 
+    /// Max time in ms render() blocks waiting for input or Wakeup::notify() while no window needs a redraw.
+    /// Set this to the time until the next timer of the application is due.
+    void setMaxIdleTime(unsigned ms)
+    {
+        _maxIdleTime = ms;
+    }
+
+    /// Number of times a window was not redrawn, because it was not dirty.
+    uint64_t getFramesSkipped() const { return _framesSkipped; }
+
     void addHotkey(const Hotkey&);
     void addHotkey(Hotkey&&);
 
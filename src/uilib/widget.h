@@ -26,7 +26,11 @@ enum MouseButton { // TODO: enum class
     BUTTON_FORWARD = SDL_BUTTON_X2,
 };
 
+class Container;
+
 class Widget {
+    friend class Container;
+
 public:
     struct Color { // TODO: move this out of Widget?
         uint8_t r;
@@ -137,6 +141,7 @@ protected:
     Spacing _margin = {0,0,0,0};
     bool _dropShadow = false;
     bool _mouseInteraction = true;
+    Widget* _parent = nullptr; ///< set by Container, used to propagate markDirty()
 
 public:
     virtual ~Widget()
@@ -156,7 +161,11 @@ public:
     
     virtual void render(Renderer renderer, int offX, int offY)=0;
     bool getEnabled() const { return _enabled; }
-    virtual void setEnabled(bool enabled) { _enabled = enabled; }
+    virtual void setEnabled(bool enabled) { if (enabled != _enabled) { _enabled = enabled; markDirty(); } }
+
+    /// Request a redraw of the window that contains this widget.
+    virtual void markDirty() { if (_parent) _parent->markDirty(); }
+    Widget* getParent() const { return _parent; }
     
     virtual const Position& getPosition() const { return _pos; }
     virtual int getLeft() const { return _pos.left; }
@@ -171,12 +180,12 @@ public:
     int getVGrow() const { return _vGrow; }
     void setLeft(int x) { setPosition({x,_pos.top}); }
     void setTop(int y) { setPosition({_pos.left,y}); }
-    virtual void setPosition(const Position& pos) { _pos = pos; }
+    virtual void setPosition(const Position& pos) { if (pos != _pos) { _pos = pos; markDirty(); } }
     void setWidth(int w) { setSize({w,_size.height}); }
     void setHeight(int h) { setSize({_size.width,h}); }
-    virtual void setSize(Size size) { _size = size; }
+    virtual void setSize(Size size) { if (size != _size) { _size = size; markDirty(); } }
     virtual void setGrow(int h, int v) { _hGrow=h; _vGrow=v; }
-    virtual void setBackground(Color color) { _backgroundColor = color; }
+    virtual void setBackground(Color color) { if (color != _backgroundColor) { _backgroundColor = color; markDirty(); } }
     virtual int getMinX() const { return _pos.left; }
     virtual int getMinY() const { return _pos.top; }
     virtual int getMaxX() const { return _pos.left + _size.width - 1; }
@@ -202,11 +211,11 @@ public:
     virtual void setMinSize(Size size) { _minSize = size; }
     virtual void setMaxSize(Size size) { _maxSize = size; }
     
-    void setVisible(bool visible) { _visible = visible; }
+    void setVisible(bool visible) { if (visible != _visible) { _visible = visible; markDirty(); } }
     bool getVisible() const { return _visible; }
     bool hasMouseInteraction() const { return _mouseInteraction; }
 
-    void setDropShaodw(bool dropShadow) { _dropShadow = dropShadow; }
+    void setDropShaodw(bool dropShadow) { if (dropShadow != _dropShadow) { _dropShadow = dropShadow; markDirty(); } }
     bool getDropShadow() const { return _dropShadow; }
 
     virtual bool isHover(Widget* w) const { return (w == this); }
@@ -232,7 +241,7 @@ public:
         if (isDisplayed) SDL_SetCursor(_cursor);
     }
 
-    void setMargin(const Spacing& margin) { _margin = margin; }
+    void setMargin(const Spacing& margin) { if (margin != _margin) { _margin = margin; markDirty(); } }
     const Spacing& getMargin() const { return _margin; }
 
     Signal<int, int, int> onMouseDown;
@@ -97,6 +97,9 @@ void Window::render(Renderer renderer, int offX, int offY)
 
 void Window::render()
 {
+    if (!_dirty)
+        return;
+    _dirty = false; // widgets may mark the window dirty again while rendering, i.e. while images are loading
     clear();
     render(_ren, 0, 0);
     present();
@@ -49,6 +49,7 @@ protected:
     Position _lastMousePos;
     Widget* _tooltip = nullptr;
     bool _isAlwaysOnTop = false;
+    bool _dirty = true; ///< something changed since the last frame was presented
 
     void clear();
     void present();
@@ -62,6 +63,8 @@ public:
     Window(const char *title, SDL_Surface* icon=nullptr, const Position& pos=WINDOW_DEFAULT_POSITION, const Size& size={0,0}, const WindowConfig& config={});
     virtual ~Window();
     virtual void render();
+    void markDirty() override { _dirty = true; }
+    bool isDirty() const { return _dirty; }
     ID getID();
     void setIcon(SDL_Surface* icon);
     virtual void resize(Size size);
@@ -8,6 +8,7 @@
 #include <thread>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "../core/wakeup.h"
 
 
 using json = nlohmann::json;
@@ -44,6 +45,12 @@ static const json jINFO = {
     { "Opcode", "Info" },
     { "Space", "SNES" }
 };
+// reads the first byte of WRAM twice; a server that only handles one address/length pair answers with 1 byte
+static const json jPROBEMULTIREAD = {
+    { "Opcode", "GetAddress" },
+    { "Space", "SNES" },
+    { "Operands", {"F50000", "1", "F50000", "1"} }
+};
 
 USB2SNES::USB2SNES(const std::string& name)
 {
@@ -159,12 +166,16 @@ USB2SNES::USB2SNES(const std::string& name)
                         read_holes_are_free = (backend == "SD2SNES") ? 512 : 128; // max hole size is a balance between wss delay and actual read cost, this is for qusb2snes 0.7.19
                         if (backend != "SD2SNES") optimum_read_block_size = 512; // clear any limits set previously if device is "virtual"
                         printf("Optimum read set to %u/%u\n", (unsigned)optimum_read_block_size, (unsigned)read_holes_are_free);
+                        // multi-address reads are probed per device, only for QUsb2Snes
+                        multi_read = false;
+                        multi_read_probed = qusb2snes_version.empty() || multi_read_probe_failed;
                     } else {
                         last_dev++; // try next device
                     }
                 } catch (...) {
                     last_dev++; // try next device
                 }
+                Wakeup::notify();
                 break;
             }
             case Op::PING:
@@ -172,6 +183,15 @@ USB2SNES::USB2SNES(const std::string& name)
                 // ignore message
                 break;
             }
+            case Op::PROBE_MULTI_READ:
+            {
+                rxbuf += msg->get_payload();
+                multi_read = rxbuf.size() == 2;
+                multi_read_probed = true;
+                printf("Multi-address reads %s\n", multi_read ? "supported" : "not supported");
+                rxbuf.clear();
+                break;
+            }
             case Op::READ:
             {
                 std::lock_guard<std::mutex> datalock(datamutex);
@@ -195,12 +215,18 @@ USB2SNES::USB2SNES(const std::string& name)
                     printf("Read $%06x expected %u bytes but got %u bytes answer\n", (unsigned)last_addr, last_len, (unsigned)(rxbuf.size()+msg->get_payload().size()));
                 }
                 if (last_len<read_len) read_len = last_len;
-                for (unsigned i=0; i<read_len; i++) {
-                    if (data[last_addr+i] != (uint8_t)rxbuf[i])
+                // multi-address reads are answered in one concatenated block
+                size_t pos = 0;
+                for (const auto& range: last_reads) {
+                    if (pos >= read_len) break;
+                    size_t n = std::min<size_t>(range.length, read_len - pos);
+                    if (data.write(range.start, n, rxbuf.data() + pos, &dirty_ranges))
                         data_changed = true;
-                    data[last_addr+i] = (uint8_t)rxbuf[i];
+                    pos += n;
                 }
                 rxbuf.clear(); 
+                if (data_changed)
+                    Wakeup::notify();
                 break;
             }
             default:
@@ -219,12 +245,28 @@ USB2SNES::USB2SNES(const std::string& name)
             // rescan
             last_op = Op::SCAN;
             client.send(hdl,jSCAN.dump(),websocketpp::frame::opcode::text);
+        } else if (!multi_read_probed) {
+            last_op = Op::PROBE_MULTI_READ;
+            client.send(hdl,jPROBEMULTIREAD.dump(),websocketpp::frame::opcode::text);
         } else {
             std::unique_lock<std::mutex> watchlock(watchmutex);
             const auto it = features.find("NO_ROM_READ");
             bool no_rom_read = (it == features.end()) ? false : it->second;
-            auto& actwatchlist = no_rom_read ? no_rom_watchlist : watchlist;
-            if (actwatchlist.empty()) {
+            if (last_watch >= read_plan.size()) {
+                // pass done, collect watches that are due now
+                updateReadPlan(no_rom_read);
+                if (read_plan.empty() && !watches.empty()) {
+                    // wait for the next deadline or until watches change, ping if nothing is due within 1sec
+                    const auto now = WatchScheduler::clock::now();
+                    const WatchScheduler::clock::time_point deadline = std::max(
+                            std::min<WatchScheduler::clock::time_point>(watches.nextDue(), now + std::chrono::seconds(1)),
+                            now + std::chrono::milliseconds(1));
+                    watches_changed = false;
+                    watchcv.wait_until(watchlock, deadline, [this]() { return watches_changed; });
+                    updateReadPlan(no_rom_read); // watches may have changed while waiting
+                }
+            }
+            if (read_plan.empty()) {
                 watchlock.unlock();
                 // limit to 10 times a second
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -234,53 +276,39 @@ USB2SNES::USB2SNES(const std::string& name)
             } else {
                 // read data from watches
                 last_op = Op::READ;
-                if (last_watch >= actwatchlist.size()) {
-                    last_watch = 0;
-                    if (update_interval>0) { // limit updates per second
-                        unsigned long t = (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - last_update).count();
-                        {
-                            watchlock.unlock();
-                            // FIXME: do multiple partial sleeps and break when destruction is requested or update_interval changed
-                            // WORK-AROUND: limit sleep time to 1sec
-                            unsigned long sleept = (t+1000<update_interval) ? 1000 : (t<update_interval) ? (update_interval-t) : 1;
-                            std::this_thread::sleep_for(std::chrono::milliseconds(sleept));
-                        }
-                        watchlock.lock();
-                    }
-                }
                 if (last_watch == 0) {
                     update_count++;
-                    last_update = std::chrono::system_clock::now();
                     std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - last_ups_display;
                     if (elapsed.count() >= 5 && update_count>0) {
                         double ups = (double)update_count / elapsed.count();
                         last_ups_display = std::chrono::system_clock::now();
                         update_count = 0;
+                        updates_per_second = (float)ups;
                         printf("UPS: %7.3f\n", (float)ups);
                     }
                 }
-                last_addr = actwatchlist[last_watch];
-                last_len  = 1;
-                uint32_t tmp = last_addr;
-                // read consecutive watches in one go
-                while (last_watch+1<actwatchlist.size()) {
-                    unsigned next = actwatchlist[last_watch+1];
-                    if (next<=tmp) break; // we should never reach this
-                    if (next-tmp>read_holes_are_free) break;
-                    if (last_len+(next-tmp)>optimum_read_block_size) break;
-                    last_len+=(next-tmp);
-                    tmp=next;
+                // read one or more coalesced ranges in one go
+                json operands = json::array();
+                last_reads.clear();
+                last_len = 0;
+                const size_t max_pairs = multi_read ? MAX_READ_PAIRS : 1;
+                while (last_watch < read_plan.size() && last_reads.size() < max_pairs) {
+                    const auto& range = read_plan[last_watch];
+                    char saddr[9]; snprintf(saddr, sizeof(saddr), "%06X", (unsigned)range.start);
+                    char slen[9];  snprintf(slen,  sizeof(slen),  "%X",   (unsigned)range.length);
+                    operands.push_back(saddr);
+                    operands.push_back(slen);
+                    last_reads.push_back(range);
+                    last_len += range.length;
                     last_watch++;
                 }
-                char saddr[9]; snprintf(saddr, sizeof(saddr), "%06X", (unsigned)last_addr);
-                char slen[9];  snprintf(slen,  sizeof(slen),  "%X",   (unsigned)last_len);
+                last_addr = last_reads.front().start;
                 json jREAD = {
                     {"Opcode", "GetAddress"},
                     {"Space", "SNES"},
-                    {"Operands", {saddr,slen}}
+                    {"Operands", operands}
                 };
                 client.send(hdl,jREAD.dump(),websocketpp::frame::opcode::text);
-                last_watch++;
             }
         }
     });
@@ -300,6 +328,7 @@ USB2SNES::USB2SNES(const std::string& name)
             snes_connected = false;
             state_changed = true;
         }
+        Wakeup::notify();
         printf("* connection to %s opened *\n", uri.c_str());
                 
         static const json jNAME = {
@@ -326,6 +355,7 @@ USB2SNES::USB2SNES(const std::string& name)
             snes_connected = false;
             state_changed = true;
         }
+        Wakeup::notify();
         last_op = Op::NONE;
     });
     
@@ -338,6 +368,10 @@ USB2SNES::USB2SNES(const std::string& name)
         usb2snes_version.clear();
         qusb2snes_version.clear();
         optimum_read_block_size = 512;
+        if (last_op == Op::PROBE_MULTI_READ)
+            multi_read_probe_failed = true; // don't probe again after the server dropped the connection
+        multi_read = false;
+        multi_read_probed = false;
         backend.clear();
         backend_version.clear();
         {
@@ -346,6 +380,7 @@ USB2SNES::USB2SNES(const std::string& name)
             ws_connected = false;
             snes_connected = false;
         }
+        Wakeup::notify();
         last_op = Op::NONE;
         printf("* connection to %s closed *\n", uri.c_str());
     });
@@ -355,9 +390,12 @@ USB2SNES::~USB2SNES()
 {
     {
         std::lock_guard<std::mutex> watchlock(watchmutex);
-        watchlist.clear();
-        no_rom_watchlist.clear();
+        watches.clear();
+        read_plan.clear();
+        last_watch = 0;
+        watches_changed = true;
     }
+    watchcv.notify_all(); // stop waiting for the next deadline
     disconnect();
 #ifdef DETACH_THREAD_ON_EXIT
     {
@@ -609,103 +647,65 @@ USB2SNES::Mapping USB2SNES::getMapping() const
     return mapping;
 }
 
-void USB2SNES::addWatch(uint32_t addr, const unsigned len)
+void USB2SNES::addWatch(uint32_t addr, const unsigned len, const unsigned interval)
 {
     addr = mapaddr(addr);
     {
-        // TODO: only lock if we know that we will modify the watchlist
         std::lock_guard<std::mutex> watch_lock(watchmutex);
-        bool modified = false;
-        size_t old_size = watchlist.size();
-        for (size_t i=0; i<len; i++) {
-            if (std::find(watchlist.begin(), watchlist.end(), addr + i) == watchlist.end()) {
-                watchlist.push_back(addr + i);
-                modified = true;
-            }
-        }
-        if (!modified)
-            return;
-
-        // NOTE: sorting is required to read adjacent bytes in one go, but it may break the last_watch variable
-        //       so we have to find out what it's pointing to and update it
-        const auto feature = features.find("NO_ROM_READ");
-        const bool no_rom_read = (feature == features.end()) ? false : feature->second;
-        if (no_rom_read) {
-            sort(watchlist.begin(), watchlist.end());
-        } else if (last_watch < old_size) {
-            const auto last_watch_addr = watchlist[last_watch];
-            sort(watchlist.begin(), watchlist.end());
-            const auto it = std::find(watchlist.begin(), watchlist.end(), last_watch_addr);
-            last_watch = it - watchlist.begin();
-            assert(last_watch <= watchlist.size());
-        } else {
-            sort(watchlist.begin(), watchlist.end());
-            last_watch = watchlist.size(); // will start again at 0
-        }
-
-        modified = false;
-        old_size = no_rom_watchlist.size();
-        for (size_t i=0; i<len; i++) {
-            if (is_rom(addr + i)) continue;
-            if (std::find(no_rom_watchlist.begin(), no_rom_watchlist.end(), addr + i)
-                    == no_rom_watchlist.end()) {
-                no_rom_watchlist.push_back(addr + i);
-                modified = true;
-            }
-        }
-        if (!modified)
-            return;
-
-        if (!no_rom_read) {
-            sort(no_rom_watchlist.begin(), no_rom_watchlist.end());
-        } else if (last_watch < old_size) {
-            const auto last_watch_addr = no_rom_watchlist[last_watch];
-            sort(no_rom_watchlist.begin(), no_rom_watchlist.end());
-            const auto it = std::find(no_rom_watchlist.begin(), no_rom_watchlist.end(), last_watch_addr);
-            last_watch = it - no_rom_watchlist.begin();
-            assert(last_watch <= watchlist.size());
-        } else {
-            sort(no_rom_watchlist.begin(), no_rom_watchlist.end());
-            last_watch = watchlist.size(); // will start again at 0
-        }
+        watches.add(addr, len, interval);
+        watches_changed = true;
     }
+    watchcv.notify_all(); // the new watch may be due before the worker would wake up
 }
 
-void USB2SNES::removeWatch(uint32_t addr, const unsigned len)
+void USB2SNES::removeWatch(uint32_t addr, const unsigned len, const unsigned interval)
 {
     addr = mapaddr(addr);
+    std::lock_guard<std::mutex> watch_lock(watchmutex);
+    watches.remove(addr, len, interval);
+}
+
+void USB2SNES::setUpdateInterval(size_t interval)
+{
     {
         std::lock_guard<std::mutex> watch_lock(watchmutex);
-        const auto feature = features.find("NO_ROM_READ");
-        const bool no_rom_read = (feature == features.end()) ? false : feature->second;
-        const bool has_last_watch_addr = no_rom_read ? (last_watch < no_rom_watchlist.size())
-            : (last_watch < watchlist.size());
-        const uint32_t last_watch_addr = !has_last_watch_addr ? 0
-            : no_rom_read ? no_rom_watchlist[last_watch]
-            : watchlist[last_watch];
-
-        auto pred = [addr, len](const uint32_t a) {
-            return a >= addr && a < addr + len;
-        };
-        watchlist.erase(std::remove_if(watchlist.begin(), watchlist.end(), pred), watchlist.end());
-        no_rom_watchlist.erase(std::remove_if(no_rom_watchlist.begin(), no_rom_watchlist.end(), pred),
-            no_rom_watchlist.end());
-
-        // update the last_watch to point at the same address again
-        if (has_last_watch_addr) {
-            if (pred(last_watch_addr)) {
-                // if we can't, because it was just removed, start at the first one again
-                last_watch = watchlist.size();
-            } else if (no_rom_read) {
-                const auto it = std::find(no_rom_watchlist.begin(), no_rom_watchlist.end(), last_watch_addr);
-                last_watch = it - no_rom_watchlist.begin();
-            } else {
-                const auto it = std::find(watchlist.begin(), watchlist.end(), last_watch_addr);
-                last_watch = it - watchlist.begin();
+        watches.setDefaultInterval((unsigned)interval);
+        watches_changed = true;
+    }
+    watchcv.notify_all();
+}
+
+void USB2SNES::setMaxReadGap(int gap)
+{
+    std::lock_guard<std::mutex> watch_lock(watchmutex);
+    read_gap_override = gap;
+}
+
+float USB2SNES::getUpdatesPerSecond()
+{
+    std::lock_guard<std::mutex> watch_lock(watchmutex);
+    return updates_per_second;
+}
+
+void USB2SNES::updateReadPlan(bool no_rom_read)
+{
+    // NOTE: watchmutex has to be locked
+    const size_t gap = (read_gap_override >= 0) ? (size_t)read_gap_override : read_holes_are_free;
+    read_plan = watches.due(WatchScheduler::clock::now(), (uint32_t)gap, (uint32_t)optimum_read_block_size);
+    if (no_rom_read) {
+        auto out = read_plan.begin();
+        for (auto range: read_plan) {
+            if (is_rom(range.end() - 1))
+                continue;
+            if (is_rom(range.start)) {
+                range.length = range.end() - 0xe00000;
+                range.start = 0xe00000;
             }
-            assert(last_watch <= watchlist.size());
+            *out++ = range;
         }
+        read_plan.erase(out, read_plan.end());
     }
+    last_watch = 0;
 }
 
 uint8_t USB2SNES::read(uint32_t addr)
@@ -715,9 +715,11 @@ uint8_t USB2SNES::read(uint32_t addr)
     uint8_t val;
     {
         std::lock_guard<std::mutex> datalock(datamutex);
-        val = data[usb2snes_addr];
-        for (const auto& w: watchlist)
-            if (w >= usb2snes_addr) return val;
+        data.read(usb2snes_addr, 1, &val);
+    }
+    {
+        std::lock_guard<std::mutex> watchlock(watchmutex);
+        if (watches.contains(usb2snes_addr, 1)) return val;
     }
     // value is not being watched -> add watch
     addWatch(addr);
@@ -725,7 +727,9 @@ uint8_t USB2SNES::read(uint32_t addr)
 #else
     {
         std::lock_guard<std::mutex> datalock(datamutex);
-        return data[usb2snes_addr];
+        uint8_t val;
+        data.read(usb2snes_addr, 1, &val);
+        return val;
     }
 #endif
 }
@@ -738,22 +742,18 @@ bool USB2SNES::read(uint32_t addr, unsigned len, void* out)
     bool missing = true;
     {
         std::lock_guard<std::mutex> datalock(datamutex);
-        for (size_t i=0; i<len; i++) dst[i] = data[usb2snes_addr+i];
-        for (size_t i=0; i<watchlist.size(); i++) {
-            if (watchlist[i] == usb2snes_addr) {
-                if (watchlist.size()>=i+len && watchlist[i+len-1] == usb2snes_addr+len-1)
-                    missing = false;
-                break;
-            } else if (watchlist[i] > usb2snes_addr) {
-                break;
-            }
-        }
+        data.read(usb2snes_addr, len, dst);
+    }
+    {
+        std::lock_guard<std::mutex> watchlock(watchmutex);
+        missing = !watches.contains(usb2snes_addr, len);
     }
     if (missing) addWatch(addr, len);
+    return true;
 #else
     {
         std::lock_guard<std::mutex> datalock(datamutex);
-        for (size_t i=0; i<len; i++) dst[i] = data[usb2snes_addr+i];
+        data.read(usb2snes_addr, len, dst);
     }
     return true;
 #endif
@@ -771,6 +771,19 @@ void USB2SNES::clearCache()
 {
     std::lock_guard<std::mutex> lock(datamutex);
     data.clear();
+    dirty_ranges.clear();
+}
+
+bool USB2SNES::takeDirtyRanges(std::vector<RangeSet::Range>& out)
+{
+    std::lock_guard<std::mutex> lock(datamutex);
+    out.swap(dirty_ranges);
+    dirty_ranges.clear();
+    if (dirty_all) {
+        dirty_all = false;
+        return false;
+    }
+    return true;
 }
 
 std::string USB2SNES::getDeviceName()
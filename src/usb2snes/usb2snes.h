@@ -5,11 +5,15 @@
 #include <websocketpp/client.hpp>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <vector>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include "../core/pagedmemory.h"
+#include "../core/rangeset.h"
+#include "../core/watchscheduler.h"
 
 class USB2SNES {
     public:
@@ -39,16 +43,23 @@ class USB2SNES {
         bool snesConnected();
         void setMapping(Mapping mapping);
         Mapping getMapping() const;
-        void addWatch(uint32_t addr, unsigned len=1);
-        void removeWatch(uint32_t addr, unsigned len=1);
+        void addWatch(uint32_t addr, unsigned len=1, unsigned interval=0);
+        void removeWatch(uint32_t addr, unsigned len=1, unsigned interval=0);
         uint8_t read(uint32_t addr);
         bool read(uint32_t addr, unsigned len, void* out);
         template<typename T>
         T readInt(uint32_t addr);
         
         bool hasFeature(std::string feat);
-        void setUpdateInterval(size_t interval) { update_interval = interval; }
+        void setUpdateInterval(size_t interval);
+        void setMaxReadGap(int gap);
+        float getUpdatesPerSecond();
         void clearCache();
+        /// Moves the mapped address ranges that changed since the last call into out.
+        /// Returns false if unknown ranges changed, i.e. all data has to be considered dirty.
+        bool takeDirtyRanges(std::vector<RangeSet::Range>& out);
+        /// Maps a SNES address to the address space used by takeDirtyRanges.
+        uint32_t mapaddr(uint32_t addr);
         std::string getDeviceName();
         void nextDevice();
 
@@ -122,23 +133,32 @@ class USB2SNES {
             CONNECT,
             READ,
             PING,
+            PROBE_MULTI_READ,
         };
         Op last_op = Op::NONE;
         std::string last_dev_name;
         size_t last_dev = 0;
-        size_t last_watch = 0;
+        size_t last_watch = 0; // next entry in read_plan
         uint32_t last_addr = 0;
         unsigned last_len = 0;
+        std::vector<RangeSet::Range> last_reads; // ranges requested by the last GetAddress
         std::string rxbuf;
-        std::vector<uint32_t> watchlist;
-        std::vector<uint32_t> no_rom_watchlist;
-        std::map<uint32_t, uint8_t> data;
+        WatchScheduler watches; // interval 0 uses update interval
+        std::condition_variable watchcv; // wakes the worker when watches change
+        bool watches_changed = false; // guarded by watchmutex
+        std::vector<RangeSet::Range> read_plan; // coalesced due watches, rebuilt by updateReadPlan after each pass
+        int read_gap_override = -1; // max gap between watches read in one go, <0 means auto
+        bool multi_read = false; // GetAddress accepts multiple address/length pairs
+        bool multi_read_probed = false; // multi_read was detected for the connected device
+        bool multi_read_probe_failed = false; // connection closed during the probe
+        float updates_per_second = 0;
+        PagedMemory data;
         bool data_changed = true;
+        bool dirty_all = true; // until the first takeDirtyRanges
+        std::vector<RangeSet::Range> dirty_ranges; // changed since the last takeDirtyRanges, guarded by datamutex
         bool state_changed = true;
-        std::chrono::system_clock::time_point last_update;
         std::chrono::system_clock::time_point last_ups_display;
         unsigned long update_count = 0;
-        unsigned long update_interval = 0;
         std::map<std::string,bool> features;
         std::string usb2snes_version;
         Version qusb2snes_version;
@@ -150,7 +170,9 @@ class USB2SNES {
         size_t read_holes_are_free = true;//false;
         Mapping mapping = Mapping::UNKNOWN;
 
-        uint32_t mapaddr(uint32_t addr);
+        static constexpr size_t MAX_READ_PAIRS = 8;
+
+        void updateReadPlan(bool no_rom_read);
 };
 
 template<typename T>
@@ -160,10 +182,7 @@ T USB2SNES::readInt(uint32_t addr)
     addr = mapaddr(addr);
     {
         std::lock_guard<std::mutex> datalock(datamutex);
-        for (size_t n=0; n<sizeof(T); n++) {
-            res <<= 8;
-            res += data[addr+sizeof(T)-n-1];
-        }
+        data.readInt(addr, res);
     }
     return res;
 }
@@ -3,6 +3,8 @@
 #include <cassert>
 #include <gtest/gtest.h>
 #include "../../src/ap/archipelago.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/tracker.h"
 
 
 /// Base to test Archipelago Lua interface while uninitialized
@@ -45,3 +47,32 @@ protected:
     APTracker apTracker;
     Archipelago ap;
 };
+
+/// Base to test Archipelago Lua interface with a Tracker while disconnected. Archipelago and Tracker are globals.
+class ArchipelagoLuaTracker : public testing::Test {
+protected:
+    ArchipelagoLuaTracker()
+        : L(luaL_newstate()), pack("examples/async"), tracker(&pack, L), apTracker("PopTracker"),
+          ap(L, &apTracker, &tracker)
+    {
+        assert(L);
+        Archipelago::Lua_Register(L);
+        ap.Lua_Push(L);
+        lua_setglobal(L, "Archipelago");
+        Tracker::Lua_Register(L);
+        tracker.Lua_Push(L);
+        lua_setglobal(L, "Tracker");
+    }
+
+    ~ArchipelagoLuaTracker() override
+    {
+        // beware: close (or pop and gc) has to happen before ap goes out of scope
+        lua_close(L);
+    }
+
+    lua_State* L;
+    Pack pack;
+    Tracker tracker;
+    APTracker apTracker;
+    Archipelago ap;
+};
@@ -0,0 +1,90 @@
+// NOTE: we don't have a mock AP server yet, so this emits APTracker's batch events directly
+
+#include <cstring>
+#include <gtest/gtest.h>
+#include "lua_fixtures.hpp"
+#include "../../lib/lua/lua.h"
+#include "../../lib/lua/lauxlib.h"
+
+
+static void run(lua_State* L, const char* script)
+{
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), "test", "t"), LUA_OK) << lua_tostring(L, -1);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+}
+
+/// Test that Archipelago:AddItemsHandler gets all items of a packet as array of tables
+TEST_F(ArchipelagoLuaDisconnected, ItemsHandler) {
+    ap.Lua_Push(L);
+    lua_setglobal(L, "Archipelago");
+    run(L, R"(
+        calls = 0
+        Archipelago:AddItemsHandler("test", function(items)
+            calls = calls + 1
+            received = items
+        end)
+    )");
+    apTracker.onItems.emit(&apTracker, {{0, 42, "Sword", 1}, {1, 43, "Shield", 2}});
+
+    lua_getglobal(L, "calls");
+    EXPECT_EQ(lua_tointeger(L, -1), 1);
+    lua_getglobal(L, "received");
+    ASSERT_EQ(lua_type(L, -1), LUA_TTABLE);
+    ASSERT_EQ(luaL_len(L, -1), 2);
+    lua_rawgeti(L, -1, 2);
+    ASSERT_EQ(lua_type(L, -1), LUA_TTABLE);
+    lua_getfield(L, -1, "index");
+    EXPECT_EQ(lua_tointeger(L, -1), 1);
+    lua_getfield(L, -2, "item");
+    EXPECT_EQ(lua_tointeger(L, -1), 43);
+    lua_getfield(L, -3, "item_name");
+    EXPECT_STREQ(lua_tostring(L, -1), "Shield");
+    lua_getfield(L, -4, "player");
+    EXPECT_EQ(lua_tointeger(L, -1), 2);
+}
+
+/// Test that Archipelago:AddLocationsHandler gets all locations of a packet as array of tables
+TEST_F(ArchipelagoLuaDisconnected, LocationsHandler) {
+    ap.Lua_Push(L);
+    lua_setglobal(L, "Archipelago");
+    run(L, R"(
+        Archipelago:AddLocationsHandler("test", function(locations)
+            received = locations
+        end)
+    )");
+    apTracker.onLocationsChecked.emit(&apTracker, {{100, "Chest"}, {101, "Boss"}});
+
+    lua_getglobal(L, "received");
+    ASSERT_EQ(lua_type(L, -1), LUA_TTABLE);
+    ASSERT_EQ(luaL_len(L, -1), 2);
+    lua_rawgeti(L, -1, 1);
+    ASSERT_EQ(lua_type(L, -1), LUA_TTABLE);
+    lua_getfield(L, -1, "location");
+    EXPECT_EQ(lua_tointeger(L, -1), 100);
+    lua_getfield(L, -2, "location_name");
+    EXPECT_STREQ(lua_tostring(L, -1), "Chest");
+}
+
+/// Test that batch handlers run inside BulkUpdate and the previous value is restored
+TEST_F(ArchipelagoLuaTracker, BatchHandlersBulkUpdate) {
+    run(L, R"(
+        Archipelago:AddItemsHandler("test", function(items)
+            itemsBulk = Tracker.BulkUpdate
+        end)
+        Archipelago:AddLocationsHandler("test", function(locations)
+            locationsBulk = Tracker.BulkUpdate
+        end)
+    )");
+    for (const bool before: {false, true}) {
+        tracker.setBulkUpdate(before);
+        apTracker.onItems.emit(&apTracker, {{0, 42, "Sword", 1}});
+        apTracker.onLocationsChecked.emit(&apTracker, {{100, "Chest"}});
+        lua_getglobal(L, "itemsBulk");
+        EXPECT_TRUE(lua_toboolean(L, -1));
+        lua_getglobal(L, "locationsBulk");
+        EXPECT_TRUE(lua_toboolean(L, -1));
+        lua_pop(L, 2);
+        EXPECT_EQ(tracker.isBulkUpdate(), before) << "expected BulkUpdate to be restored";
+    }
+    tracker.setBulkUpdate(false);
+}
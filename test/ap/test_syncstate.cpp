@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "../../src/ap/apsyncstate.h"
+
+
+using ItemAction = APSyncState::ItemAction;
+using SyncAction = APSyncState::SyncAction;
+
+/// Connects to slot 1 of team 0 of seed "seed" and delivers count items.
+static void connectAndDeliver(APSyncState& state, int count)
+{
+    state.connected("seed", 0, 1);
+    for (int i = 0; i < count; i++) {
+        ASSERT_EQ(state.receiveItem(i), ItemAction::DELIVER);
+        state.itemDelivered();
+    }
+}
+
+TEST(APSyncStateTest, FirstConnectDoesNotResume)
+{
+    APSyncState state;
+    EXPECT_FALSE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.getItemIndex(), 0);
+}
+
+TEST(APSyncStateTest, ResumeSameSlot)
+{
+    APSyncState state;
+    connectAndDeliver(state, 3);
+    state.disconnected({1, 2});
+
+    EXPECT_TRUE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.getItemIndex(), 3);
+    EXPECT_EQ(state.receiveItem(2), ItemAction::SKIP);
+    EXPECT_EQ(state.receiveItem(3), ItemAction::DELIVER);
+}
+
+TEST(APSyncStateTest, ResumeAfterReset)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    state.reset({1});
+    EXPECT_EQ(state.getItemIndex(), 0);
+
+    EXPECT_TRUE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.getItemIndex(), 2);
+}
+
+TEST(APSyncStateTest, NoResumeForOtherSlot)
+{
+    {
+        APSyncState state;
+        connectAndDeliver(state, 2);
+        state.disconnected({});
+        EXPECT_FALSE(state.connected("other seed", 0, 1));
+        EXPECT_EQ(state.getItemIndex(), 0);
+    }
+    {
+        APSyncState state;
+        connectAndDeliver(state, 2);
+        state.disconnected({});
+        EXPECT_FALSE(state.connected("seed", 1, 1));
+        EXPECT_EQ(state.getItemIndex(), 0);
+    }
+    {
+        APSyncState state;
+        connectAndDeliver(state, 2);
+        state.disconnected({});
+        EXPECT_FALSE(state.connected("seed", 0, 2));
+        EXPECT_EQ(state.getItemIndex(), 0);
+    }
+}
+
+TEST(APSyncStateTest, NoResumeToPreviousSlotAfterSwitching)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    state.disconnected({});
+    EXPECT_FALSE(state.connected("seed", 0, 2));
+    state.disconnected({});
+    EXPECT_FALSE(state.connected("seed", 0, 1));
+}
+
+TEST(APSyncStateTest, SkipItemsByIndex)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    EXPECT_EQ(state.receiveItem(0), ItemAction::SKIP); // already delivered
+    EXPECT_EQ(state.receiveItem(5), ItemAction::SKIP); // out of order
+    EXPECT_EQ(state.getItemIndex(), 2);
+    EXPECT_EQ(state.receiveItem(2), ItemAction::DELIVER);
+}
+
+TEST(APSyncStateTest, SyncWithoutItemsReplaysClear)
+{
+    APSyncState state;
+    state.connected("seed", 0, 1);
+    EXPECT_EQ(state.sync(true), SyncAction::REPLAY_CLEAR);
+    EXPECT_FALSE(state.isSyncing());
+}
+
+TEST(APSyncStateTest, SyncRequestsItems)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    EXPECT_EQ(state.sync(true), SyncAction::REQUEST);
+    state.syncRequested(true);
+    EXPECT_TRUE(state.isSyncing());
+    EXPECT_EQ(state.getItemIndex(), 0);
+    EXPECT_EQ(state.sync(true), SyncAction::PENDING);
+
+    // first item after the sync replays onClear, the rest is delivered normally
+    EXPECT_EQ(state.receiveItem(0), ItemAction::REPLAY_AND_DELIVER);
+    state.itemDelivered();
+    EXPECT_FALSE(state.isSyncing());
+    EXPECT_EQ(state.receiveItem(1), ItemAction::DELIVER);
+}
+
+TEST(APSyncStateTest, SyncWhileDisconnectedForgetsResume)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    state.disconnected({1});
+    EXPECT_EQ(state.sync(false), SyncAction::FAIL);
+    EXPECT_FALSE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.getItemIndex(), 0);
+}
+
+TEST(APSyncStateTest, FailedSyncRequestForgetsResume)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    EXPECT_EQ(state.sync(true), SyncAction::REQUEST);
+    state.syncRequested(false);
+    EXPECT_FALSE(state.isSyncing());
+    state.disconnected({1});
+    EXPECT_FALSE(state.connected("seed", 0, 1));
+}
+
+TEST(APSyncStateTest, InterruptedSyncForgetsResume)
+{
+    APSyncState state;
+    connectAndDeliver(state, 2);
+    EXPECT_EQ(state.sync(true), SyncAction::REQUEST);
+    state.syncRequested(true);
+    state.disconnected({1});
+    EXPECT_FALSE(state.isSyncing());
+    EXPECT_FALSE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.getItemIndex(), 0);
+}
+
+TEST(APSyncStateTest, NewLocations)
+{
+    APSyncState state;
+    connectAndDeliver(state, 1);
+    EXPECT_EQ(state.newLocations({1, 2}), (std::vector<int64_t>{1, 2}));
+    state.disconnected({1, 3, 5});
+    ASSERT_TRUE(state.connected("seed", 0, 1));
+    EXPECT_EQ(state.newLocations({1, 2, 3, 4, 5, 6}), (std::vector<int64_t>{2, 4, 6}));
+    EXPECT_TRUE(state.newLocations({1, 3}).empty());
+}
@@ -0,0 +1,51 @@
+#include <lauxlib.h>
+#include <lua.h>
+#include <gtest/gtest.h>
+#include "../../src/core/autosaver.h"
+#include "../../src/core/fileutil.h"
+#include "../../src/core/jsonutil.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/statemanager.h"
+#include "../../src/core/tracker.h"
+#include "../util/tempdir.hpp"
+
+
+TEST(Autosaver, SkipsUnchanged) {
+    TempDir temp;
+    const fs::path dir = temp.tempPath();
+    StateManager::setDir(dir);
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([{"name": "A", "type": "toggle", "codes": "a"}])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    const fs::path file = StateManager::getStateFile(&pack, "autosave");
+    {
+        Autosaver autosaver(&tracker);
+        EXPECT_TRUE(autosaver.save({}, nullptr));
+    } // destructor writes what is queued
+    EXPECT_TRUE(fs::is_regular_file(file));
+    {
+        Autosaver autosaver(&tracker);
+        EXPECT_TRUE(autosaver.saveIfChanged({}, nullptr)); // first save
+        EXPECT_FALSE(autosaver.saveIfChanged({}, nullptr)); // nothing changed
+        EXPECT_TRUE(autosaver.save({}, nullptr)) << "expected explicit save to always snapshot";
+
+        tracker.changeItemState(tracker.getItemByCode("a").getID(), BaseItem::Action::Primary);
+        EXPECT_TRUE(autosaver.saveIfChanged({}, nullptr));
+        EXPECT_FALSE(autosaver.saveIfChanged({}, nullptr));
+        EXPECT_TRUE(autosaver.saveIfChanged({}, {{"at_slot", "x"}})); // extra changed
+    } // destructor writes what is queued
+
+    std::string s;
+    ASSERT_TRUE(readFile(file, s));
+    json j = parse_jsonc(s);
+    EXPECT_EQ(j["extra"]["at_slot"], "x");
+    EXPECT_FALSE(fs::exists(file.u8string() + ".tmp"));
+
+    tracker.changeItemState(tracker.getItemByCode("a").getID(), BaseItem::Action::Primary);
+    json extra;
+    EXPECT_TRUE(StateManager::loadState(&tracker, nullptr, extra, true));
+    EXPECT_EQ(tracker.ProviderCountForCode("a"), 1);
+    lua_close(L);
+}
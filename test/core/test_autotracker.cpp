@@ -47,3 +47,14 @@ TEST(AutoTracker, EmptyAccess) {
     at.setSnesAddresses({});
     EXPECT_FALSE(at.sync());
 }
+
+/// Test that buffered reads and range mapping fail without memory
+TEST(AutoTracker, EmptyReadInto) {
+    AutoTracker at("none", {});
+    for (int addr=0; addr<2; addr++) {
+        uint8_t buf;
+        EXPECT_FALSE(at.read(addr, 1, &buf));
+        RangeSet::Range range;
+        EXPECT_FALSE(at.mapRange(addr, 1, range));
+    }
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "../../src/core/codetable.h"
+#include "../../src/core/compiledrules.h"
+
+
+using OpType = CompiledRules::OpType;
+
+
+class CompiledRulesTest : public ::testing::Test {
+protected:
+    CodeTable codes;
+    CodeTable refs;
+
+    CompiledRules compile(const std::list<std::list<std::string>>& rules)
+    {
+        return CompiledRules::Compile(rules,
+            [this](const std::string& code) { return codes.intern(code); },
+            [this](const std::string& ref) { return refs.intern(ref); });
+    }
+};
+
+TEST_F(CompiledRulesTest, Empty) {
+    EXPECT_TRUE(compile({}).empty());
+    const auto rules = compile({{}});
+    ASSERT_EQ(rules.end() - rules.begin(), 1);
+    EXPECT_EQ(rules.begin()->type, OpType::END);
+}
+
+TEST_F(CompiledRulesTest, CodesAndCounts) {
+    const auto rules = compile({{"a", "b:3"}, {"[a]", "", "$f|x"}});
+    ASSERT_EQ(rules.end() - rules.begin(), 6);
+    const auto* op = rules.begin();
+    EXPECT_EQ(op[0].type, OpType::CODE);
+    EXPECT_EQ(codes.name(op[0].arg), "a");
+    EXPECT_EQ(op[0].count, 1);
+    EXPECT_EQ(op[1].type, OpType::CODE);
+    EXPECT_EQ(codes.name(op[1].arg), "b");
+    EXPECT_EQ(op[1].count, 3);
+    EXPECT_EQ(op[2].type, OpType::END);
+    EXPECT_EQ(op[3].type, OpType::CODE);
+    EXPECT_EQ(op[3].arg, op[0].arg); // interned
+    EXPECT_EQ(op[3].flags, CompiledRules::FLAG_OPTIONAL);
+    EXPECT_EQ(op[4].type, OpType::CODE);
+    EXPECT_EQ(codes.name(op[4].arg), "$f|x");
+    EXPECT_EQ(op[5].type, OpType::END);
+}
+
+TEST_F(CompiledRulesTest, ReferencesAndLevels) {
+    const auto rules = compile({{"@Some/Loc:ation", "^$level", "^invalid"}});
+    ASSERT_EQ(rules.end() - rules.begin(), 4);
+    const auto* op = rules.begin();
+    EXPECT_EQ(op[0].type, OpType::REFERENCE);
+    EXPECT_EQ(refs.name(op[0].arg), "Some/Loc:ation"); // no count for references
+    EXPECT_EQ(op[1].type, OpType::LEVEL);
+    EXPECT_EQ(codes.name(op[1].arg), "$level");
+    EXPECT_EQ(op[2].type, OpType::INVALID);
+}
+
+TEST_F(CompiledRulesTest, InspectOnly) {
+    const auto rules = compile({{"{a", "[b]}"}, {"{"}, {"^$f", "c}"}});
+    const auto* op = rules.begin();
+    ASSERT_EQ(rules.end() - rules.begin(), 9);
+    EXPECT_EQ(op[0].type, OpType::CODE);
+    EXPECT_EQ(op[0].flags, CompiledRules::FLAG_BRACE_OPEN);
+    EXPECT_EQ(codes.name(op[0].arg), "a");
+    EXPECT_EQ(op[1].type, OpType::CODE);
+    EXPECT_EQ(op[1].flags, CompiledRules::FLAG_OPTIONAL);
+    EXPECT_EQ(codes.name(op[1].arg), "b");
+    EXPECT_EQ(op[2].type, OpType::END);
+    EXPECT_EQ(op[3].type, OpType::SKIP);
+    EXPECT_EQ(op[3].flags, CompiledRules::FLAG_BRACE_OPEN);
+    EXPECT_EQ(op[4].type, OpType::END);
+    EXPECT_EQ(op[5].type, OpType::LEVEL);
+    // ^$ can make the rest inspect-only at runtime, so "c}" has an alternative
+    EXPECT_EQ(op[6].type, OpType::CODE);
+    EXPECT_EQ(op[6].flags, CompiledRules::FLAG_HAS_ALT);
+    EXPECT_EQ(codes.name(op[6].arg), "c}");
+    EXPECT_EQ(op[7].type, OpType::CODE);
+    EXPECT_EQ(codes.name(op[7].arg), "c");
+    EXPECT_EQ(op[8].type, OpType::END);
+}
+
+TEST_F(CompiledRulesTest, EmptyCodes) {
+    // like string rules: "[]" and ":2" test the empty code, "{}" only makes the set inspect-only
+    const auto rules = compile({{"[]"}, {"{}"}, {":2"}, {"[:2]"}});
+    ASSERT_EQ(rules.end() - rules.begin(), 8);
+    const auto* op = rules.begin();
+    EXPECT_EQ(op[0].type, OpType::CODE);
+    EXPECT_EQ(op[0].flags, CompiledRules::FLAG_OPTIONAL);
+    EXPECT_EQ(codes.name(op[0].arg), "");
+    EXPECT_EQ(op[0].count, 1);
+    EXPECT_EQ(op[1].type, OpType::END);
+    EXPECT_EQ(op[2].type, OpType::SKIP);
+    EXPECT_EQ(op[2].flags, CompiledRules::FLAG_BRACE_OPEN);
+    EXPECT_EQ(op[3].type, OpType::END);
+    EXPECT_EQ(op[4].type, OpType::CODE);
+    EXPECT_EQ(op[4].flags, 0);
+    EXPECT_EQ(codes.name(op[4].arg), "");
+    EXPECT_EQ(op[4].count, 2);
+    EXPECT_EQ(op[5].type, OpType::END);
+    EXPECT_EQ(op[6].type, OpType::CODE);
+    EXPECT_EQ(op[6].flags, CompiledRules::FLAG_OPTIONAL);
+    EXPECT_EQ(op[6].count, 2);
+    EXPECT_EQ(op[7].type, OpType::END);
+}
@@ -0,0 +1,40 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+#include "../../src/core/intervalindex.h"
+
+
+static std::vector<int> query(IntervalIndex<int>& index, uint32_t start, uint32_t length)
+{
+    std::vector<int> res;
+    index.query(start, length, [&res](int value) { res.push_back(value); });
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+TEST(IntervalIndexTest, Overlaps) {
+    IntervalIndex<int> index;
+    EXPECT_TRUE(query(index, 0, 100).empty());
+    index.add(0x10, 4, 1);
+    index.add(0x00, 0x100, 2); // long interval before short ones
+    index.add(0x12, 1, 3);
+    index.add(0x200, 2, 4);
+    index.add(0x300, 0, 5); // never matches
+    EXPECT_EQ(index.size(), 4u);
+
+    EXPECT_EQ(query(index, 0x10, 1), (std::vector<int>{1, 2}));
+    EXPECT_EQ(query(index, 0x12, 1), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(query(index, 0x14, 1), (std::vector<int>{2}));
+    EXPECT_EQ(query(index, 0x0f, 2), (std::vector<int>{1, 2}));
+    EXPECT_EQ(query(index, 0x100, 0x100), (std::vector<int>{}));
+    EXPECT_EQ(query(index, 0x1ff, 1), (std::vector<int>{}));
+    EXPECT_EQ(query(index, 0x1ff, 2), (std::vector<int>{4}));
+    EXPECT_EQ(query(index, 0, 0x1000), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(query(index, 0x12, 0), (std::vector<int>{}));
+
+    index.add(0xffffff00, 0x100, 6); // up to the end of the address space
+    EXPECT_EQ(query(index, 0xffffffff, 1), (std::vector<int>{6}));
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    EXPECT_TRUE(query(index, 0x10, 1).empty());
+}
@@ -116,3 +116,141 @@ TEST(LuaItemProvidesTest, PotentialCodes) {
 
     lua_close(L);
 }
+
+TEST(LuaItemProvidesTest, MemoizedCanProvideCode) {
+    Pack pack("examples/async"); // doesn't matter which one
+    lua_State* L = luaL_newstate();
+    ASSERT_TRUE(L);
+
+    Tracker tracker(&pack, L);
+    Tracker::Lua_Register(L);
+    tracker.Lua_Push(L);
+    lua_setglobal(L, "Tracker");
+    lua_pushstring(L, "Pack");
+    lua_pushlightuserdata(L, &pack);
+    lua_settable(L, LUA_REGISTRYINDEX);
+    ScriptHost scriptHost(&pack, L, &tracker);
+    ScriptHost::Lua_Register(L);
+    scriptHost.Lua_Push(L);
+    lua_setglobal(L, "ScriptHost");
+    LuaItem::Lua_Register(L);
+
+    const char* script = R"(
+        calls = 0
+        local item = ScriptHost:CreateLuaItem()
+        item.Name = "test"
+        local code = "A"
+        function item:CanProvideCodeFunc(c)
+            calls = calls + 1
+            return c == code
+        end
+        function item:ProvidesCodeFunc(c)
+            return (c == code) and 1 or 0
+        end
+        function item:OnLeftClickFunc()
+            code = "B"
+            self.Icon = "b"  -- trigger onChange
+        end
+    )";
+    const char* modName = "script";
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), modName, "t"), LUA_OK);
+    lua_pushstring(L, modName);
+    ASSERT_EQ(lua_pcall(L, 1, 1, 0), LUA_OK) << lua_tostring(L, -1);
+
+    auto getCalls = [L]() {
+        lua_getglobal(L, "calls");
+        const auto n = lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        return n;
+    };
+
+    EXPECT_EQ(tracker.ProviderCountForCode("A"), 1);
+    EXPECT_EQ(tracker.getItemByCode("A").getName(), "test");
+    EXPECT_TRUE(tracker.FindObjectForCode("A").type == Tracker::Object::RT::LuaItem);
+    EXPECT_EQ(getCalls(), 1) << "expected CanProvideCodeFunc to be called once per code";
+
+    auto& item = tracker.getItemById(tracker.getItemByCode("A").getID());
+    EXPECT_TRUE(item.changeState(BaseItem::Action::Primary));
+    EXPECT_EQ(tracker.ProviderCountForCode("A"), 0);
+    EXPECT_EQ(tracker.ProviderCountForCode("B"), 1);
+    EXPECT_EQ(tracker.getItemByCode("B").getName(), "test");
+    const auto calls = getCalls();
+    EXPECT_EQ(tracker.ProviderCountForCode("B"), 1);
+    EXPECT_EQ(getCalls(), calls) << "expected cached result after change";
+
+    lua_close(L);
+}
+
+TEST(LuaItemProvidesTest, CanProvideCodeInvalidatedPerItem) {
+    Pack pack("examples/async"); // doesn't matter which one
+    lua_State* L = luaL_newstate();
+    ASSERT_TRUE(L);
+
+    Tracker tracker(&pack, L);
+    Tracker::Lua_Register(L);
+    tracker.Lua_Push(L);
+    lua_setglobal(L, "Tracker");
+    lua_pushstring(L, "Pack");
+    lua_pushlightuserdata(L, &pack);
+    lua_settable(L, LUA_REGISTRYINDEX);
+    ScriptHost scriptHost(&pack, L, &tracker);
+    ScriptHost::Lua_Register(L);
+    scriptHost.Lua_Push(L);
+    lua_setglobal(L, "ScriptHost");
+    LuaItem::Lua_Register(L);
+
+    const char* script = R"(
+        calls = {a = 0, b = 0}
+        local function make(name, code)
+            local item = ScriptHost:CreateLuaItem()
+            item.Name = name
+            function item:CanProvideCodeFunc(c)
+                calls[name] = calls[name] + 1
+                return c == code
+            end
+            function item:ProvidesCodeFunc(c)
+                return (c == code) and 1 or 0
+            end
+            function item:OnLeftClickFunc()
+                self.Icon = "x"  -- state change only
+            end
+            function item:OnRightClickFunc()
+                code = code .. "2"
+                self:Set("code", code)  -- property change
+            end
+        end
+        make("a", "A")
+        make("b", "B")
+    )";
+    const char* modName = "script";
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), modName, "t"), LUA_OK);
+    lua_pushstring(L, modName);
+    ASSERT_EQ(lua_pcall(L, 1, 1, 0), LUA_OK) << lua_tostring(L, -1);
+
+    auto getCalls = [L](const char* name) {
+        lua_getglobal(L, "calls");
+        lua_getfield(L, -1, name);
+        const auto n = lua_tointeger(L, -1);
+        lua_pop(L, 2);
+        return n;
+    };
+
+    EXPECT_EQ(tracker.ProviderCountForCode("A"), 1);
+    EXPECT_EQ(tracker.ProviderCountForCode("B"), 1);
+    EXPECT_EQ(getCalls("a"), 2);
+    EXPECT_EQ(getCalls("b"), 2);
+
+    auto& a = tracker.getItemById(tracker.getItemByCode("A").getID());
+    EXPECT_TRUE(a.changeState(BaseItem::Action::Primary));
+    EXPECT_EQ(tracker.ProviderCountForCode("A"), 1);
+    EXPECT_EQ(tracker.ProviderCountForCode("B"), 1);
+    EXPECT_EQ(getCalls("a"), 2) << "expected state change to keep CanProvideCode results";
+
+    EXPECT_TRUE(a.changeState(BaseItem::Action::Secondary));
+    EXPECT_EQ(tracker.ProviderCountForCode("A"), 0);
+    EXPECT_EQ(tracker.ProviderCountForCode("B"), 1);
+    EXPECT_EQ(tracker.ProviderCountForCode("A2"), 1);
+    EXPECT_EQ(getCalls("b"), 3) << "expected only the new code to be asked from unchanged item";
+
+    lua_close(L);
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include "../../src/core/fileutil.h"
+#include "../../src/core/fs.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/packcatalog.h"
+#include "../util/tempdir.hpp"
+
+
+static std::vector<Pack::Info> listUncached(const fs::path& searchPath)
+{
+    std::vector<Pack::Info> res;
+    for (const auto& dirEntry: fs::directory_iterator{searchPath}) {
+        Pack pack(dirEntry.path());
+        if (pack.isValid())
+            res.push_back(pack.getInfo());
+    }
+    return res;
+}
+
+static void expectSameInfo(const std::vector<Pack::Info>& expected, const std::vector<Pack::Info>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].path, actual[i].path);
+        EXPECT_EQ(expected[i].uid, actual[i].uid);
+        EXPECT_EQ(expected[i].version, actual[i].version);
+        EXPECT_EQ(expected[i].packName, actual[i].packName);
+        EXPECT_EQ(expected[i].minPoptrackerVersion.to_string(), actual[i].minPoptrackerVersion.to_string());
+        ASSERT_EQ(expected[i].variants.size(), actual[i].variants.size());
+        for (size_t j = 0; j < expected[i].variants.size(); j++) {
+            EXPECT_EQ(expected[i].variants[j].variant, actual[i].variants[j].variant);
+            EXPECT_EQ(expected[i].variants[j].name, actual[i].variants[j].name);
+        }
+    }
+}
+
+TEST(PackCatalogTest, ListMatchesPack) {
+    const fs::path searchPath = "examples";
+    PackCatalog catalog;
+    const auto expected = listUncached(searchPath);
+    ASSERT_FALSE(expected.empty());
+    expectSameInfo(expected, catalog.list({searchPath}));
+    expectSameInfo(expected, catalog.list({searchPath})); // cached
+}
+
+TEST(PackCatalogTest, SaveLoad) {
+    TempDir temp;
+    const fs::path file = temp.tempPath();
+    const fs::path searchPath = "examples";
+    const auto expected = listUncached(searchPath);
+    {
+        PackCatalog catalog(file);
+        catalog.list({searchPath});
+        EXPECT_TRUE(catalog.save());
+    }
+    ASSERT_TRUE(fs::is_regular_file(file));
+    PackCatalog catalog(file);
+    EXPECT_GE(catalog.size(), expected.size());
+    expectSameInfo(expected, catalog.list({searchPath}));
+}
+
+TEST(PackCatalogTest, UpdateDetectsChange) {
+    TempDir temp;
+    const fs::path searchPath = temp.tempPath();
+    const fs::path packPath = searchPath / "pack";
+    fs::create_directories(packPath);
+    PackCatalog catalog;
+    EXPECT_TRUE(catalog.list({searchPath}).empty());
+    const fs::path manifest = packPath / "manifest.json";
+    ASSERT_TRUE(writeFile(manifest, R"({"package_uid": "test", "package_version": "1.0.0"})"));
+    // same size and within the same second
+    const auto second = std::chrono::floor<std::chrono::seconds>(fs::last_write_time(manifest));
+    fs::last_write_time(manifest, second + std::chrono::milliseconds(100));
+    auto packs = catalog.list({searchPath});
+    ASSERT_EQ(packs.size(), 1u);
+    EXPECT_EQ(packs[0].version, "1.0.0");
+    ASSERT_TRUE(writeFile(manifest, R"({"package_uid": "test", "package_version": "1.0.1"})"));
+    fs::last_write_time(manifest, second + std::chrono::milliseconds(600));
+    packs = catalog.list({searchPath});
+    ASSERT_EQ(packs.size(), 1u);
+    EXPECT_EQ(packs[0].version, "1.0.1");
+    fs::remove_all(packPath);
+    EXPECT_TRUE(catalog.list({searchPath}).empty());
+    EXPECT_EQ(catalog.size(), 0u);
+}
+
+TEST(PackCatalogTest, UpdateAsync) {
+    const fs::path searchPath = "examples";
+    PackCatalog catalog;
+    catalog.updateAsync({searchPath});
+    catalog.wait();
+    expectSameInfo(listUncached(searchPath), catalog.list({searchPath}));
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "../../src/core/jsonutil.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/packpreloader.h"
+
+
+static nlohmann::json readJson(const Pack& pack, const std::string& file)
+{
+    std::string s;
+    if (!pack.ReadFile(file, s))
+        return nlohmann::json(nlohmann::json::value_t::discarded);
+    return parse_jsonc(s);
+}
+
+TEST(PackPreloaderTest, TakeMatchesReadFile) {
+    Pack pack("examples/rules_test");
+    ASSERT_TRUE(pack.isValid());
+    pack.setVariant("var_at");
+    PackPreloader preloader(&pack);
+    nlohmann::json j;
+    ASSERT_TRUE(preloader.take("items/items.json", j));
+    EXPECT_EQ(j, readJson(pack, "items/items.json"));
+    ASSERT_TRUE(preloader.take("./locations/locations.jsonc", j));
+    EXPECT_EQ(j, readJson(pack, "locations/locations.jsonc")) << "expected variant file";
+}
+
+TEST(PackPreloaderTest, TakeOnce) {
+    Pack pack("examples/rules_test");
+    PackPreloader preloader(&pack);
+    nlohmann::json j;
+    EXPECT_TRUE(preloader.take("maps/maps.json", j));
+    EXPECT_FALSE(preloader.take("maps/maps.json", j));
+}
+
+TEST(PackPreloaderTest, Missing) {
+    Pack pack("examples/rules_test");
+    PackPreloader preloader(&pack);
+    nlohmann::json j;
+    EXPECT_FALSE(preloader.take("missing.json", j));
+    EXPECT_FALSE(preloader.take("scripts/init.lua", j));
+}
+
+TEST(PackPreloaderTest, SkipsOtherVariants) {
+    Pack pack("examples/rules_test");
+    ASSERT_TRUE(pack.isValid());
+    pack.setVariant("var_at");
+    PackPreloader preloader(&pack);
+    nlohmann::json j;
+    EXPECT_FALSE(preloader.take("var_visibility/locations/locations.jsonc", j));
+    EXPECT_TRUE(preloader.take("maps/maps.json", j));
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <vector>
+#include "../../src/core/pagedmemory.h"
+
+
+TEST(PagedMemoryTest, ReadUnknown) {
+    PagedMemory mem;
+    uint8_t buf[4] = {1, 2, 3, 4};
+    EXPECT_FALSE(mem.read(0x100, sizeof(buf), buf));
+    EXPECT_EQ(buf[0], 0);
+    EXPECT_EQ(buf[3], 0);
+    EXPECT_TRUE(mem.empty());
+}
+
+TEST(PagedMemoryTest, WriteRead) {
+    PagedMemory mem;
+    const uint8_t in[] = {0x11, 0x22, 0x33, 0x44};
+    EXPECT_TRUE(mem.write(0x7e0010, sizeof(in), in));
+    uint8_t out[4] = {};
+    EXPECT_TRUE(mem.read(0x7e0010, sizeof(out), out));
+    EXPECT_EQ(memcmp(in, out, sizeof(in)), 0);
+    uint32_t val = 0;
+    EXPECT_TRUE(mem.readInt(0x7e0010, val));
+    EXPECT_EQ(val, 0x44332211u);
+    uint16_t partial = 0;
+    EXPECT_FALSE(mem.readInt(0x7e0013, partial));
+    EXPECT_EQ(partial, 0x0044);
+}
+
+TEST(PagedMemoryTest, WriteReportsChanges) {
+    PagedMemory mem;
+    const uint8_t zero[2] = {};
+    const uint8_t one[2] = {0, 1};
+    EXPECT_TRUE(mem.write(10, sizeof(zero), zero)); // unknown before
+    EXPECT_FALSE(mem.write(10, sizeof(zero), zero));
+    EXPECT_TRUE(mem.write(10, sizeof(one), one));
+    EXPECT_TRUE(mem.write(11, sizeof(one), one)); // byte 12 unknown before
+    EXPECT_FALSE(mem.write(10, 1, zero));
+}
+
+TEST(PagedMemoryTest, CrossPage) {
+    PagedMemory mem;
+    std::vector<uint8_t> in(PagedMemory::PAGE_SIZE + 100);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = (uint8_t)i;
+    const uint32_t addr = 3 * PagedMemory::PAGE_SIZE - 50;
+    EXPECT_TRUE(mem.write(addr, in.size(), in.data()));
+    std::vector<uint8_t> out(in.size());
+    EXPECT_TRUE(mem.read(addr, out.size(), out.data()));
+    EXPECT_EQ(in, out);
+    EXPECT_FALSE(mem.read(addr - 1, 2, out.data()));
+    EXPECT_EQ(out[0], 0);
+    EXPECT_EQ(out[1], in[0]);
+    mem.clear();
+    EXPECT_FALSE(mem.read(addr, 1, out.data()));
+}
+
+TEST(PagedMemoryTest, ChangedRanges) {
+    using Range = RangeSet::Range;
+    PagedMemory mem;
+    std::vector<Range> changes;
+    std::vector<uint8_t> in(PagedMemory::PAGE_SIZE + 100);
+    const uint32_t addr = 2 * PagedMemory::PAGE_SIZE - 50;
+    EXPECT_TRUE(mem.write(addr, in.size(), in.data(), &changes));
+    EXPECT_EQ(changes, (std::vector<Range>{{addr, (uint32_t)in.size()}})); // unknown before, merged across pages
+    changes.clear();
+    EXPECT_FALSE(mem.write(addr, in.size(), in.data(), &changes));
+    EXPECT_TRUE(changes.empty());
+    in[10] = 1;
+    in[12] = 1;
+    in[60] = 1;
+    EXPECT_TRUE(mem.write(addr, in.size(), in.data(), &changes));
+    EXPECT_EQ(changes, (std::vector<Range>{{addr + 10, 3}, {addr + 60, 1}}));
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "../../src/core/rangeset.h"
+
+
+using Range = RangeSet::Range;
+
+
+TEST(RangeSetTest, AddRemove) {
+    RangeSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.add(0x10, 4));
+    EXPECT_FALSE(set.add(0x10, 4)); // only increments count
+    EXPECT_TRUE(set.add(0x12, 4));
+    EXPECT_EQ(set.ranges(), (std::vector<Range>{{0x10, 6}}));
+    EXPECT_TRUE(set.contains(0x10, 6));
+    EXPECT_FALSE(set.contains(0x10, 7));
+    EXPECT_FALSE(set.contains(0x0f, 1));
+
+    EXPECT_FALSE(set.remove(0x10, 4)); // 0x10..0x11 is still referenced once, 0x12..0x13 twice
+    EXPECT_EQ(set.ranges(), (std::vector<Range>{{0x10, 6}}));
+    EXPECT_TRUE(set.remove(0x10, 4));
+    EXPECT_EQ(set.ranges(), (std::vector<Range>{{0x12, 4}}));
+    EXPECT_TRUE(set.remove(0x12, 4));
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.remove(0x12, 4));
+    EXPECT_TRUE(set.empty());
+}
+
+TEST(RangeSetTest, RemoveMiddle) {
+    RangeSet set;
+    set.add(100, 10);
+    EXPECT_TRUE(set.remove(103, 2));
+    EXPECT_EQ(set.ranges(), (std::vector<Range>{{100, 3}, {105, 5}}));
+    set.add(103, 2);
+    EXPECT_EQ(set.ranges(), (std::vector<Range>{{100, 10}}));
+}
+
+TEST(RangeSetTest, Coalesce) {
+    RangeSet set;
+    set.add(0, 2);
+    set.add(4, 2);   // gap of 2
+    set.add(20, 1);  // gap of 14
+    set.add(40, 30); // gap of 19
+    EXPECT_EQ(set.coalesce(0, 100), (std::vector<Range>{{0, 2}, {4, 2}, {20, 1}, {40, 30}}));
+    EXPECT_EQ(set.coalesce(2, 100), (std::vector<Range>{{0, 6}, {20, 1}, {40, 30}}));
+    EXPECT_EQ(set.coalesce(16, 100), (std::vector<Range>{{0, 21}, {40, 30}}));
+    EXPECT_EQ(set.coalesce(16, 16), (std::vector<Range>{{0, 6}, {20, 1}, {40, 16}, {56, 14}}));
+}
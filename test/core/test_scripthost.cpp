@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <lauxlib.h>
+#include <lua.h>
+#include <gtest/gtest.h>
+#include "../../src/core/autotracker.h"
+#include "../../src/core/autotrackprovider.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/scripthost.h"
+#include "../../src/core/tracker.h"
+
+
+/// Memory provider that reports the dirty ranges it is given. Addresses from 0x100 are mapped to 0x1100, so watches
+/// across 0x100 are not contiguous in backend address space.
+class DirtyRangesProvider final : public IAutotrackProvider {
+public:
+    std::vector<uint8_t> memory = std::vector<uint8_t>(0x200);
+    std::vector<RangeSet::Range> dirty;
+    bool dirtyKnown = false; ///< false: report that anything may have changed
+    bool changed = true;
+    std::vector<uint32_t> reads; ///< addresses read from cache
+
+    /// Changes memory at addr and reports the change for the next update.
+    void write(uint32_t addr, uint8_t value)
+    {
+        memory[addr] = value;
+        dirty.push_back({mapAddress(addr), 1});
+        dirtyKnown = true;
+        changed = true;
+    }
+
+    bool wasRead(uint32_t addr) const
+    {
+        return std::find(reads.begin(), reads.end(), addr) != reads.end();
+    }
+
+    const std::string& getName() override
+    {
+        static const std::string name = "Stub";
+        return name;
+    }
+
+    bool start() override { return true; }
+    bool stop() override { return true; }
+
+    bool update() override
+    {
+        const bool res = changed;
+        changed = false;
+        return res;
+    }
+
+    bool isReady() override { return true; }
+    bool isConnected() override { return true; }
+    void clearCache() override {}
+
+    bool takeDirtyRanges(std::vector<RangeSet::Range>& out) override
+    {
+        out = std::move(dirty);
+        dirty.clear();
+        const bool res = dirtyKnown;
+        dirtyKnown = false;
+        return res;
+    }
+
+    void addWatch(uint32_t, unsigned int, unsigned) override {}
+    void removeWatch(uint32_t, unsigned int, unsigned) override {}
+    void setWatchUpdateInterval(size_t) override {}
+    void setMapping(const std::set<std::string>&) override {}
+
+    uint32_t mapAddress(uint32_t address) override
+    {
+        return address < 0x100 ? address : address + 0x1000;
+    }
+
+    bool readFromCache(void* out, uint32_t address, unsigned int length) override
+    {
+        reads.push_back(address);
+        if (address + length > memory.size())
+            return false;
+        memcpy(out, memory.data() + address, length);
+        return true;
+    }
+
+    bool readUInt8FromCache(uint8_t& out, uint32_t address, uint32_t offset) override
+    {
+        return readFromCache(&out, address + offset, 1);
+    }
+
+    bool readUInt16FromCache(uint16_t& out, uint32_t address, uint32_t offset) override
+    {
+        return readFromCache(&out, address + offset, 2);
+    }
+
+    bool readUInt32FromCache(uint32_t& out, uint32_t address, uint32_t offset) override
+    {
+        return readFromCache(&out, address + offset, 4);
+    }
+};
+
+/// Runs one frame of auto-tracking and returns the names of the watches whose callbacks ran.
+static std::string autoTrack(lua_State* L, ScriptHost& scriptHost, DirtyRangesProvider& provider)
+{
+    provider.reads.clear();
+    lua_pushstring(L, "");
+    lua_setglobal(L, "changed");
+    scriptHost.onFrame();
+    lua_getglobal(L, "changed");
+    std::string res = lua_tostring(L, -1);
+    lua_pop(L, 1);
+    return res;
+}
+
+TEST(ScriptHost, MemoryWatchesDirtyRanges)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    ScriptHost scriptHost(&pack, L, &tracker);
+    ScriptHost::Lua_Register(L);
+    scriptHost.Lua_Push(L);
+    lua_setglobal(L, "ScriptHost");
+
+    auto* provider = new DirtyRangesProvider();
+    AutoTracker* autoTracker = scriptHost.getAutoTracker();
+    autoTracker->setAutotrackProvider(provider);
+    ASSERT_TRUE(autoTracker->enable(autoTracker->getIndex(provider->getName())));
+
+    const char* script = R"(
+        changed = ""
+        function watch(name)
+            return function()
+                changed = changed .. name .. ","
+            end
+        end
+        ScriptHost:AddMemoryWatch("a", 0x10, 2, watch("a"))
+        ScriptHost:AddMemoryWatch("b", 0x20, 2, watch("b"))
+        ScriptHost:AddMemoryWatch("split", 0xfe, 4, watch("split")) -- not contiguous in backend address space
+    )";
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), "script", "t"), LUA_OK);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+
+    // first update has unknown changes, so all watches are compared
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "a,b,split,");
+    EXPECT_TRUE(provider->wasRead(0x10));
+    EXPECT_TRUE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0xfe));
+
+    // only the overlapping watch and the one that is not contiguous are compared
+    provider->write(0x11, 1);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "a,");
+    EXPECT_TRUE(provider->wasRead(0x10));
+    EXPECT_FALSE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0xfe));
+
+    // change outside of all watches
+    provider->write(0x30, 1);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "");
+    EXPECT_FALSE(provider->wasRead(0x10));
+    EXPECT_FALSE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0xfe));
+
+    // change in the mapped part of the watch that is not contiguous
+    provider->write(0x101, 1);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "split,");
+    EXPECT_FALSE(provider->wasRead(0x10));
+    EXPECT_FALSE(provider->wasRead(0x20));
+
+    // unknown ranges fall back to comparing all watches
+    provider->memory[0x20] = 1;
+    provider->changed = true;
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "b,");
+    EXPECT_TRUE(provider->wasRead(0x10));
+    EXPECT_TRUE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0xfe));
+
+    // adding a watch falls back to comparing all watches once
+    const char* addScript = R"(ScriptHost:AddMemoryWatch("c", 0x40, 1, watch("c")))";
+    ASSERT_EQ(luaL_loadbufferx(L, addScript, strlen(addScript), "add", "t"), LUA_OK);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+    provider->memory[0x20] = 2; // not reported as dirty
+    provider->write(0x11, 2);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "a,b,c,");
+    EXPECT_TRUE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0x40));
+    provider->write(0x11, 3);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "a,");
+    EXPECT_FALSE(provider->wasRead(0x20));
+    EXPECT_FALSE(provider->wasRead(0x40));
+
+    // removing a watch falls back to comparing all watches once
+    const char* removeScript = R"(ScriptHost:RemoveMemoryWatch("a"))";
+    ASSERT_EQ(luaL_loadbufferx(L, removeScript, strlen(removeScript), "remove", "t"), LUA_OK);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+    provider->memory[0x40] = 1; // not reported as dirty
+    provider->write(0x30, 2);
+    EXPECT_EQ(autoTrack(L, scriptHost, *provider), "c,");
+    EXPECT_FALSE(provider->wasRead(0x10));
+    EXPECT_TRUE(provider->wasRead(0x20));
+    EXPECT_TRUE(provider->wasRead(0x40));
+    EXPECT_TRUE(provider->wasRead(0xfe));
+
+    lua_close(L);
+}
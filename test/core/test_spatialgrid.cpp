@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "../../src/core/spatialgrid.h"
+
+
+static std::vector<int> queryAll(const SpatialGrid<int>& grid, int left, int top, int right, int bottom)
+{
+    std::vector<int> res;
+    grid.query(left, top, right, bottom, [&res](int, int, int value) {
+        res.push_back(value);
+    });
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+TEST(SpatialGridTest, Query) {
+    SpatialGrid<int> grid(16);
+    EXPECT_TRUE(grid.empty());
+    grid.insert(0, 0, 1);
+    grid.insert(15, 15, 2);
+    grid.insert(16, 16, 3);
+    grid.insert(100, 5, 4);
+    EXPECT_EQ(grid.size(), 4u);
+    EXPECT_EQ(queryAll(grid, 0, 0, 15, 15), (std::vector<int>{1, 2}));
+    EXPECT_EQ(queryAll(grid, 15, 15, 16, 16), (std::vector<int>{2, 3}));
+    EXPECT_EQ(queryAll(grid, 17, 0, 99, 100), (std::vector<int>{}));
+    EXPECT_EQ(queryAll(grid, -1000, -1000, 1000, 1000), (std::vector<int>{1, 2, 3, 4}));
+    grid.clear();
+    EXPECT_TRUE(grid.empty());
+    EXPECT_EQ(queryAll(grid, -1000, -1000, 1000, 1000), (std::vector<int>{}));
+}
+
+TEST(SpatialGridTest, Negative) {
+    SpatialGrid<int> grid(10);
+    grid.insert(-1, -1, 1);
+    grid.insert(-10, 0, 2);
+    grid.insert(-11, 5, 3);
+    EXPECT_EQ(queryAll(grid, -1, -1, -1, -1), (std::vector<int>{1}));
+    EXPECT_EQ(queryAll(grid, -10, -5, 0, 5), (std::vector<int>{1, 2}));
+    EXPECT_EQ(queryAll(grid, -11, 5, -11, 5), (std::vector<int>{3}));
+}
+
+TEST(SpatialGridTest, MatchesLinearSearch) {
+    SpatialGrid<int> grid(32);
+    std::vector<std::pair<int, int>> points;
+    unsigned seed = 1;
+    for (int i = 0; i < 500; i++) {
+        seed = seed * 1103515245 + 12345;
+        const int x = (int)(seed >> 16) % 1000 - 100;
+        seed = seed * 1103515245 + 12345;
+        const int y = (int)(seed >> 16) % 800 - 100;
+        points.emplace_back(x, y);
+        grid.insert(x, y, i);
+    }
+    for (int q = 0; q < 50; q++) {
+        const int left = q * 17 - 120;
+        const int top = q * 11 - 110;
+        const int right = left + 40 + q * 3;
+        const int bottom = top + 30 + q * 5;
+        std::vector<int> expected;
+        for (int i = 0; i < (int)points.size(); i++) {
+            const auto& p = points[i];
+            if (p.first >= left && p.first <= right && p.second >= top && p.second <= bottom)
+                expected.push_back(i);
+        }
+        EXPECT_EQ(queryAll(grid, left, top, right, bottom), expected);
+    }
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <lauxlib.h>
+#include <lua.h>
+#include <gtest/gtest.h>
+#include "../../src/core/fileutil.h"
+#include "../../src/core/pack.h"
+#include "../../src/core/statemanager.h"
+#include "../../src/core/tracker.h"
+#include "../util/tempdir.hpp"
+
+
+TEST(StateManager, EncodeDecode) {
+    const json state = {
+        {"tracker", {{"format_version", 1}, {"json_items", {{"1", {{"state", 2}}}}}}},
+        {"extra", {{"at_slot", "\xc3\xa4"}}},
+    };
+    for (const bool binary: {false, true}) {
+        std::string data = StateManager::encodeState(state, binary);
+        EXPECT_EQ(StateManager::decodeState(data), state);
+    }
+    std::string invalid = "\xa1\xff";
+    EXPECT_TRUE(StateManager::decodeState(invalid).is_null());
+}
+
+TEST(StateManager, SwitchFormat) {
+    TempDir temp;
+    StateManager::setDir(temp.tempPath());
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([{"name": "A", "type": "toggle", "codes": "a"}])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    const auto& a = tracker.getItemByCode("a");
+
+    StateManager::setBinary(false);
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    ASSERT_TRUE(StateManager::saveState(&tracker, nullptr, {}, nullptr, true));
+    StateManager::setBinary(true);
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    ASSERT_TRUE(StateManager::saveState(&tracker, nullptr, {}, nullptr, true));
+    const fs::path file = StateManager::getStateFile(&pack, "autosave");
+    EXPECT_EQ(file.extension(), ".cbor");
+    std::string s;
+    ASSERT_TRUE(readFile(file, s));
+    EXPECT_NE(s[0], '{');
+
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    EXPECT_EQ(tracker.ProviderCountForCode("a"), 1);
+    json extra;
+    EXPECT_TRUE(StateManager::loadState(&tracker, nullptr, extra, true));
+    EXPECT_EQ(tracker.ProviderCountForCode("a"), 0);
+    StateManager::setBinary(false);
+    lua_close(L);
+}
+
+TEST(StateManager, NewerFormatWins) {
+    TempDir temp;
+    StateManager::setDir(temp.tempPath());
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([{"name": "A", "type": "toggle", "codes": "a"}])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    const auto& a = tracker.getItemByCode("a");
+
+    StateManager::setBinary(true);
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    ASSERT_TRUE(StateManager::saveState(&tracker, nullptr, {}, nullptr, true));
+    const fs::path binaryFile = StateManager::getStateFile(&pack, "autosave");
+    StateManager::setBinary(false);
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    ASSERT_TRUE(StateManager::saveState(&tracker, nullptr, {}, nullptr, true));
+    const fs::path jsonFile = StateManager::getStateFile(&pack, "autosave");
+    ASSERT_NE(binaryFile, jsonFile);
+    // make the other format's file the newer one
+    fs::last_write_time(jsonFile, fs::last_write_time(binaryFile) - std::chrono::seconds(10));
+
+    EXPECT_EQ(tracker.ProviderCountForCode("a"), 0);
+    json extra;
+    EXPECT_TRUE(StateManager::loadState(&tracker, nullptr, extra, true));
+    EXPECT_EQ(tracker.ProviderCountForCode("a"), 1) << "expected newer .cbor to be loaded";
+    lua_close(L);
+}
+
+TEST(StateManager, CorruptBinary) {
+    TempDir temp;
+    StateManager::setDir(temp.tempPath());
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([{"name": "A", "type": "toggle", "codes": "a"}])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+
+    StateManager::setBinary(true);
+    ASSERT_TRUE(StateManager::saveState(&tracker, nullptr, {}, nullptr, true));
+    const fs::path file = StateManager::getStateFile(&pack, "autosave");
+    std::string s;
+    ASSERT_TRUE(readFile(file, s));
+    s.resize(s.size() / 2); // truncated CBOR
+    ASSERT_TRUE(writeFile(file, s));
+    json extra;
+    EXPECT_FALSE(StateManager::loadState(&tracker, nullptr, extra, true));
+    EXPECT_TRUE(StateManager::getStateExtra(&tracker, true).is_null());
+    StateManager::setBinary(false);
+    lua_close(L);
+}
@@ -17,9 +17,6 @@ TEST(TaskQueue, Cancel) {
         EXPECT_EQ(cvDone.wait_for(firstLock, std::chrono::seconds(1)), std::cv_status::no_timeout);
         return 1;
     });
-    EXPECT_FALSE(queue.cancel(first)); // about to start
-    // ^ This is an implementation detail, but covers an additional branch.
-    // Note: after the second enqueue, cancel(first) may succeed
     const size_t second = queue.enqueue([] {
         return 2;
     });
@@ -165,3 +162,27 @@ TEST(TaskQueue, AutoCancel) {
         });
     } // queue goes out of scope here and runs deconstructor
 }
+
+TEST(TaskQueue, Parallel) {
+    // all tasks have to run at the same time to finish
+    static constexpr size_t workers = 4;
+    pop::TaskQueue<int> queue(workers);
+    std::mutex mutex;
+    std::condition_variable cvStarted;
+    size_t started = 0;
+    std::vector<size_t> taskNumbers;
+    for (size_t i = 0; i < workers; i++) {
+        taskNumbers.push_back(queue.enqueue([&mutex, &cvStarted, &started, i] {
+            std::unique_lock lock(mutex);
+            started++;
+            cvStarted.notify_all();
+            EXPECT_TRUE(cvStarted.wait_for(lock, std::chrono::seconds(1), [&started] {
+                return started == workers;
+            }));
+            return (int)i;
+        }));
+    }
+    for (size_t i = 0; i < workers; i++) {
+        EXPECT_EQ(queue.get(taskNumbers[i]), (int)i);
+    }
+}
@@ -1,8 +1,13 @@
+#include <cstring>
 #include <lauxlib.h>
 #include <lua.h>
 #include <gtest/gtest.h>
 #include "../../src/core/fs.h"
+#include "../../src/core/jsonitem.h"
+#include "../../src/core/locationsection.h"
+#include "../../src/core/luaitem.h"
 #include "../../src/core/pack.h"
+#include "../../src/core/scripthost.h"
 #include "../../src/core/tracker.h"
 
 
@@ -43,3 +48,251 @@ TEST(OpenLink, InvalidLinks)
 
     lua_close(L);
 }
+
+TEST(Tracker, IncrementalAccessibility)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([
+        {"name": "A", "type": "toggle", "codes": "a"},
+        {"name": "B", "type": "toggle", "codes": "b"}
+    ])";
+    std::string locations = R"([
+        {"name": "Y", "access_rules": [["@Z", "a"]], "sections": [{"name": "s"}]},
+        {"name": "Z", "access_rules": ["b"], "sections": [{"name": "s"}]},
+        {"name": "Loop1", "access_rules": ["@Loop2", "a"], "sections": [{"name": "s"}]},
+        {"name": "Loop2", "access_rules": ["@Loop1"], "sections": [{"name": "s"}]}
+    ])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    ASSERT_TRUE(tracker.AddLocationsFromString(locations));
+    auto& a = *tracker.FindObjectForCode("a").jsonItem;
+    auto& b = *tracker.FindObjectForCode("b").jsonItem;
+    const auto& y = tracker.getLocation("Y");
+    const auto& z = tracker.getLocation("Z");
+    const auto& loop2 = tracker.getLocation("Loop2");
+
+    EXPECT_EQ(tracker.isReachable(y), AccessibilityLevel::NONE);
+    EXPECT_EQ(tracker.isReachable(z), AccessibilityLevel::NONE);
+    EXPECT_EQ(tracker.isReachable(loop2), AccessibilityLevel::NONE);
+    b.setState(1);
+    EXPECT_EQ(tracker.isReachable(z), AccessibilityLevel::NORMAL);
+    EXPECT_EQ(tracker.isReachable(y), AccessibilityLevel::NONE);
+    a.setState(1);
+    EXPECT_EQ(tracker.isReachable(y), AccessibilityLevel::NORMAL);
+    EXPECT_EQ(tracker.isReachable(loop2), AccessibilityLevel::NORMAL);
+    b.setState(0);
+    EXPECT_EQ(tracker.isReachable(y), AccessibilityLevel::NONE);
+    EXPECT_EQ(tracker.isReachable(z), AccessibilityLevel::NONE);
+    a.setState(0);
+    // cyclic references must not keep each other reachable
+    EXPECT_EQ(tracker.isReachable(loop2), AccessibilityLevel::NONE);
+    EXPECT_EQ(tracker.isReachable(tracker.getLocationSection("Loop1/s")), AccessibilityLevel::NONE);
+
+    lua_close(L);
+}
+
+TEST(Tracker, IndexedLookups)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([
+        {"name": "A", "type": "toggle", "codes": "a,shared"},
+        {"name": "B", "type": "progressive", "stages": [{"codes": "b1"}, {"codes": "b2"}]},
+        {"name": "C", "type": "toggle", "codes": "shared"}
+    ])";
+    std::string locations = R"([
+        {"name": "Area", "children": [
+            {"name": "Sub", "children": [{"name": "Deep", "sections": [{"name": "s"}]}]}
+        ]},
+        {"name": "Deep", "sections": [{"name": "t"}]}
+    ])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    ASSERT_TRUE(tracker.AddLocationsFromString(locations));
+
+    const auto& a = tracker.getItemByCode("a");
+    const auto& b = tracker.getItemByCode("b2");
+    EXPECT_EQ(a.getName(), "A");
+    EXPECT_EQ(b.getName(), "B");
+    EXPECT_EQ(&tracker.getItemByCode("shared"), &a); // first item wins
+    EXPECT_EQ(&tracker.getItemById(b.getID()), &b);
+    EXPECT_TRUE(tracker.getItemById("nope").getID().empty());
+#ifdef JSONITEM_CI_QUIRK
+    EXPECT_EQ(&tracker.getItemByCode("B1"), &b);
+#endif
+    EXPECT_EQ(tracker.ProviderCountForCode("shared"), 0);
+    tracker.changeItemState(a.getID(), BaseItem::Action::Primary);
+    EXPECT_EQ(tracker.ProviderCountForCode("shared"), 1);
+    EXPECT_EQ(tracker.ProviderCountForCode("b1"), 0);
+
+    const auto& deep = tracker.getLocation("Area/Sub/Deep");
+    EXPECT_EQ(deep.getID(), "Area/Sub/Deep");
+    EXPECT_EQ(&tracker.getLocation("Sub/Deep", true), &deep);
+    EXPECT_TRUE(tracker.getLocation("Sub/Deep").getID().empty()); // no partial match requested
+    EXPECT_EQ(&tracker.getLocation("Deep", true), &tracker.getLocation("Deep")); // ID before name
+    EXPECT_EQ(&tracker.getLocation("Sub", true), &tracker.getLocation("Area/Sub"));
+    EXPECT_EQ(&tracker.getLocationSection("Area/Sub/Deep/s"), &deep.getSections().front());
+    EXPECT_EQ(&tracker.getLocationSection("Sub/Deep/s"), &deep.getSections().front());
+    EXPECT_TRUE(tracker.getLocationSection("Area/Sub/Deep/t").getName().empty());
+
+    lua_close(L);
+}
+
+TEST(Tracker, IncrementalAccessibilityLuaReads)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    Tracker::Lua_Register(L);
+    tracker.Lua_Push(L);
+    lua_setglobal(L, "Tracker");
+    ScriptHost scriptHost(&pack, L, &tracker);
+    ScriptHost::Lua_Register(L);
+    scriptHost.Lua_Push(L);
+    lua_setglobal(L, "ScriptHost");
+    LuaItem::Lua_Register(L);
+    JsonItem::Lua_Register(L);
+    LocationSection::Lua_Register(L);
+
+    std::string items = R"([{"name": "A", "type": "toggle", "codes": "a"}])";
+    std::string locations = R"([
+        {"name": "Chest", "sections": [{"name": "s", "item_count": 1}]},
+        {"name": "AfterChest", "access_rules": ["chest_cleared"], "sections": [{"name": "s"}]},
+        {"name": "AfterA", "access_rules": ["a_active"], "sections": [{"name": "s"}]}
+    ])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    ASSERT_TRUE(tracker.AddLocationsFromString(locations));
+    // a Lua item whose codes read a section and another item through FindObjectForCode
+    const char* script = R"(
+        local item = ScriptHost:CreateLuaItem()
+        item.Name = "reader"
+        function item:CanProvideCodeFunc(code)
+            return code == "chest_cleared" or code == "a_active"
+        end
+        function item:ProvidesCodeFunc(code)
+            if code == "chest_cleared" then
+                return Tracker:FindObjectForCode("@Chest/s").AvailableChestCount == 0 and 1 or 0
+            elseif code == "a_active" then
+                return Tracker:FindObjectForCode("a").Active and 1 or 0
+            end
+            return 0
+        end
+    )";
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), "script", "t"), LUA_OK);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+
+    const auto& afterChest = tracker.getLocation("AfterChest");
+    const auto& afterA = tracker.getLocation("AfterA");
+    EXPECT_EQ(tracker.isReachable(afterChest), AccessibilityLevel::NONE);
+    EXPECT_EQ(tracker.isReachable(afterA), AccessibilityLevel::NONE);
+    auto& chest = tracker.getLocationSection("Chest/s");
+    ASSERT_TRUE(chest.clearItem());
+    EXPECT_EQ(tracker.isReachable(afterChest), AccessibilityLevel::NORMAL);
+    ASSERT_TRUE(chest.unclearItem());
+    EXPECT_EQ(tracker.isReachable(afterChest), AccessibilityLevel::NONE);
+    tracker.changeItemState(tracker.getItemByCode("a").getID(), BaseItem::Action::Primary);
+    EXPECT_EQ(tracker.isReachable(afterA), AccessibilityLevel::NORMAL);
+    tracker.changeItemState(tracker.getItemByCode("a").getID(), BaseItem::Action::Primary);
+    EXPECT_EQ(tracker.isReachable(afterA), AccessibilityLevel::NONE);
+
+    lua_close(L);
+}
+
+TEST(Tracker, LuaProvidersChangedWhileCounting)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    Tracker::Lua_Register(L);
+    tracker.Lua_Push(L);
+    lua_setglobal(L, "Tracker");
+    ScriptHost scriptHost(&pack, L, &tracker);
+    ScriptHost::Lua_Register(L);
+    scriptHost.Lua_Push(L);
+    lua_setglobal(L, "ScriptHost");
+    LuaItem::Lua_Register(L);
+
+    // the first provider creates a second one while it is being counted, which rebuilds the provider lists
+    const char* script = R"(
+        local function createProvider(onCount)
+            local item = ScriptHost:CreateLuaItem()
+            function item:CanProvideCodeFunc(code)
+                return code == "x"
+            end
+            function item:ProvidesCodeFunc(code)
+                if onCount then
+                    onCount()
+                    onCount = nil
+                end
+                return 1
+            end
+        end
+        createProvider(function() createProvider() end)
+    )";
+    ASSERT_EQ(luaL_loadbufferx(L, script, strlen(script), "script", "t"), LUA_OK);
+    ASSERT_EQ(lua_pcall(L, 0, 0, 0), LUA_OK) << lua_tostring(L, -1);
+
+    EXPECT_EQ(tracker.ProviderCountForCode("x"), 2);
+    EXPECT_EQ(tracker.ProviderCountForCode("x"), 2); // cached
+
+    lua_close(L);
+}
+
+TEST(Tracker, EmptyCodeRules)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string locations = R"([
+        {"name": "Optional", "access_rules": ["[]"], "sections": [{"name": "s"}]},
+        {"name": "Inspect", "access_rules": ["{}"], "sections": [{"name": "s"}]},
+        {"name": "Count", "access_rules": [":2"], "sections": [{"name": "s"}]}
+    ])";
+    ASSERT_TRUE(tracker.AddLocationsFromString(locations));
+    // same results as before rules got compiled
+    EXPECT_EQ(tracker.isReachable(tracker.getLocation("Optional")), AccessibilityLevel::SEQUENCE_BREAK);
+    EXPECT_EQ(tracker.isReachable(tracker.getLocation("Inspect")), AccessibilityLevel::INSPECT);
+    EXPECT_EQ(tracker.isReachable(tracker.getLocation("Count")), AccessibilityLevel::NONE);
+
+    lua_close(L);
+}
+
+TEST(Tracker, LocationsChanged)
+{
+    lua_State* L = luaL_newstate();
+    Pack pack("examples/rules_test");
+    Tracker tracker(&pack, L);
+    std::string items = R"([
+        {"name": "A", "type": "toggle", "codes": "a"},
+        {"name": "B", "type": "toggle", "codes": "b"}
+    ])";
+    std::string locations = R"([
+        {"name": "X", "access_rules": ["a"], "sections": [{"name": "s"}]},
+        {"name": "Y", "sections": [{"name": "s", "access_rules": ["b"]}]},
+        {"name": "Z", "sections": [{"name": "s", "access_rules": ["@Y/s"]}]}
+    ])";
+    ASSERT_TRUE(tracker.AddItemsFromString(items));
+    ASSERT_TRUE(tracker.AddLocationsFromString(locations));
+    bool all = false;
+    std::set<std::string> changed;
+    tracker.onLocationsChanged += {&changed, [&](void*, const std::unordered_set<std::string>* locations) {
+        if (!locations)
+            all = true;
+        else
+            changed.insert(locations->begin(), locations->end());
+    }};
+    tracker.updateLogic();
+    EXPECT_TRUE(all) << "expected first update to report all locations";
+    all = false;
+    tracker.changeItemState(tracker.getItemByCode("b").getID(), BaseItem::Action::Primary);
+    tracker.updateLogic();
+    EXPECT_FALSE(all);
+    EXPECT_EQ(changed, (std::set<std::string>{"Y", "Z"}));
+    changed.clear();
+    tracker.updateLogic();
+    EXPECT_TRUE(changed.empty());
+    tracker.onLocationsChanged -= &changed;
+
+    lua_close(L);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "../../src/core/watchscheduler.h"
+
+
+using Range = RangeSet::Range;
+using namespace std::chrono_literals;
+
+
+TEST(WatchSchedulerTest, PerIntervalDeadlines) {
+    WatchScheduler watches;
+    const auto t0 = WatchScheduler::clock::now();
+    EXPECT_EQ(watches.nextDue(), WatchScheduler::clock::time_point::max());
+    EXPECT_TRUE(watches.add(0x100, 2, 100));
+    EXPECT_TRUE(watches.add(0x200, 0x40, 1000));
+    EXPECT_EQ(watches.nextDue(), WatchScheduler::clock::time_point::min());
+
+    EXPECT_EQ(watches.due(t0, 0, 512), (std::vector<Range>{{0x100, 2}, {0x200, 0x40}}));
+    EXPECT_EQ(watches.nextDue(), t0 + 100ms);
+    EXPECT_TRUE(watches.due(t0 + 50ms, 0, 512).empty());
+    // only the fast watch is due until the slow one's deadline
+    for (int i = 1; i < 10; i++)
+        EXPECT_EQ(watches.due(t0 + i * 100ms, 0, 512), (std::vector<Range>{{0x100, 2}}));
+    EXPECT_EQ(watches.due(t0 + 1000ms, 0, 512), (std::vector<Range>{{0x100, 2}, {0x200, 0x40}}));
+    EXPECT_EQ(watches.nextDue(), t0 + 1100ms);
+}
+
+TEST(WatchSchedulerTest, NewRangesAreDue) {
+    WatchScheduler watches;
+    const auto t0 = WatchScheduler::clock::now();
+    watches.add(0x100, 4, 1000);
+    watches.due(t0, 0, 512);
+    EXPECT_FALSE(watches.add(0x100, 4, 1000)); // only increments count
+    EXPECT_TRUE(watches.add(0x300, 4, 1000));
+    // only the new range is read, the group keeps its deadline
+    EXPECT_EQ(watches.due(t0 + 10ms, 0, 512), (std::vector<Range>{{0x300, 4}}));
+    EXPECT_EQ(watches.nextDue(), t0 + 1000ms);
+
+    EXPECT_FALSE(watches.remove(0x300, 4, 100)); // wrong interval
+    EXPECT_TRUE(watches.remove(0x300, 4, 1000));
+    EXPECT_FALSE(watches.remove(0x100, 4, 1000));
+    EXPECT_TRUE(watches.remove(0x100, 4, 1000));
+    EXPECT_TRUE(watches.empty());
+}
+
+TEST(WatchSchedulerTest, DefaultInterval) {
+    WatchScheduler watches;
+    const auto t0 = WatchScheduler::clock::now();
+    watches.setDefaultInterval(500);
+    watches.add(0x10, 1);
+    watches.due(t0, 0, 512);
+    EXPECT_EQ(watches.nextDue(), t0 + 500ms);
+    watches.setDefaultInterval(200);
+    watches.due(t0 + 500ms, 0, 512);
+    EXPECT_EQ(watches.nextDue(), t0 + 700ms);
+    // falling behind does not cause a burst of reads
+    EXPECT_FALSE(watches.due(t0 + 2000ms, 0, 512).empty());
+    EXPECT_EQ(watches.nextDue(), t0 + 2200ms);
+}
+
+TEST(WatchSchedulerTest, CoalesceDueOnly) {
+    WatchScheduler watches;
+    const auto t0 = WatchScheduler::clock::now();
+    watches.add(0x00, 2, 100);
+    watches.add(0x08, 2, 100);
+    watches.add(0x04, 2, 1000);
+    watches.add(0x40, 2, 1000);
+    EXPECT_EQ(watches.due(t0, 4, 512), (std::vector<Range>{{0x00, 10}, {0x40, 2}}));
+    // the slow range in between is not due, so it is not read
+    EXPECT_EQ(watches.due(t0 + 100ms, 0, 512), (std::vector<Range>{{0x00, 2}, {0x08, 2}}));
+    EXPECT_EQ(watches.ranges(), (std::vector<Range>{{0x00, 2}, {0x04, 2}, {0x08, 2}, {0x40, 2}}));
+    EXPECT_TRUE(watches.contains(0x04, 2));
+    EXPECT_FALSE(watches.contains(0x06, 2));
+}
+
+TEST(WatchSchedulerTest, CoveredGroupsAreRescheduled) {
+    WatchScheduler watches;
+    const auto t0 = WatchScheduler::clock::now();
+    watches.add(0x00, 2, 100);
+    watches.add(0x08, 2, 100);
+    watches.add(0x04, 2, 1000);
+    watches.due(t0, 0, 512);
+    // a range that is read as part of a due range gets a new deadline
+    EXPECT_EQ(watches.due(t0 + 100ms, 8, 512), (std::vector<Range>{{0x00, 10}}));
+    EXPECT_EQ(watches.due(t0 + 1000ms, 0, 512), (std::vector<Range>{{0x00, 2}, {0x08, 2}}));
+    EXPECT_EQ(watches.due(t0 + 1100ms, 0, 512), (std::vector<Range>{{0x00, 2}, {0x04, 2}, {0x08, 2}}));
+}
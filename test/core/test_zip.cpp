@@ -6,6 +6,7 @@
 #include "../../src/core/fileutil.h"
 #include "../../src/core/zip.h"
 #include "../util/fmemopen.hpp"
+#include "../util/tempdir.hpp"
 
 // sample data:
 // see ./tools/make_zip.py
@@ -212,6 +213,66 @@ TEST(Zip, StoredLimit)
     EXPECT_EQ(full, alsoFull);
 }
 
+TEST(Zip, StoredView)
+{
+    Zip zip(SAMPLE_ZIP_PATH);
+    ASSERT_TRUE(zip.isValid());
+    std::string data;
+    std::string_view view;
+    ASSERT_TRUE(zip.readFile("0/very_short.txt", data));
+    ASSERT_TRUE(zip.readStoredFile("0/very_short.txt", view));
+    EXPECT_EQ(view, data);
+    EXPECT_FALSE(zip.readStoredFile("1/very_short.txt", view)) << "expected deflated file to not be viewable";
+    EXPECT_FALSE(zip.readStoredFile("0/missing.txt", view));
+}
+
+TEST(Zip, StoredViewBadCrc)
+{
+    std::string zipData;
+    ASSERT_TRUE(readFile(SAMPLE_ZIP_PATH, zipData));
+    // flip a byte in the data that follows the local header of 0/very_short.txt
+    const std::string name = "0/very_short.txt";
+    const size_t header = zipData.find(name);
+    ASSERT_NE(header, std::string::npos);
+    const size_t extraLen = static_cast<uint8_t>(zipData[header - 2]) | (static_cast<uint8_t>(zipData[header - 1]) << 8);
+    zipData[header + name.length() + extraLen] ^= 0x01;
+    TempDir temp;
+    const fs::path path = temp.tempPath();
+    ASSERT_TRUE(writeFile(path, zipData));
+    Zip zip(path);
+    ASSERT_TRUE(zip.isValid());
+    std::string_view view;
+    EXPECT_FALSE(zip.readStoredFile(name, view));
+    EXPECT_FALSE(zip.readStoredFile(name, view)) << "expected cached CRC result to be used";
+    EXPECT_TRUE(zip.readStoredFile("0/empty.txt", view));
+}
+
+TEST(Zip, Cached)
+{
+    Zip zip(SAMPLE_ZIP_PATH);
+    ASSERT_TRUE(zip.isValid());
+    zip.setCacheLimit(1024 * 1024);
+    std::string uncached, cached, part;
+    EXPECT_TRUE(zip.readFile("9/short.txt", uncached));
+    EXPECT_TRUE(zip.readFile("9/short.txt", cached));
+    EXPECT_TRUE(zip.readFile("9/short.txt", part, 5));
+    EXPECT_EQ(uncached, cached);
+    EXPECT_EQ(part, uncached.substr(0, 5));
+    zip.setCacheLimit(0);
+    EXPECT_TRUE(zip.readFile("9/short.txt", cached));
+    EXPECT_EQ(uncached, cached);
+}
+
+TEST(Zip, CaseInsensitive)
+{
+    Zip zip(SAMPLE_ZIP_PATH);
+    ASSERT_TRUE(zip.isValid());
+    std::string lower, upper;
+    EXPECT_TRUE(zip.readFile("1/very_short.txt", lower));
+    EXPECT_TRUE(zip.readFile("1/VERY_SHORT.TXT", upper));
+    EXPECT_EQ(lower, upper);
+}
+
 TEST(Zip, Deflate64)
 {
     Zip zip(DEFLATE64_ZIP_PATH);
@@ -0,0 +1,88 @@
+#include <asio.hpp>
+#include <gtest/gtest.h>
+#include "../../src/luaconnector/message.h"
+#include "../../src/luaconnector/server.h"
+
+
+using LuaConnector::Net::BinaryHeader;
+using LuaConnector::Net::Message;
+
+
+/// Server with its reply handling exposed
+class ReplyServer final : public LuaConnector::Net::Server {
+public:
+    using Server::Server;
+    using Server::updateBuffer;
+};
+
+
+static Message makeBinary(uint8_t type, uint32_t address, const std::vector<uint8_t>& data, uint32_t length)
+{
+    Message msg;
+    msg.body = {0, type, 0, 0};
+    for (uint32_t v: {address, length}) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            msg.body.push_back((uint8_t)(v >> shift));
+    }
+    msg.body.insert(msg.body.end(), data.begin(), data.end());
+    msg.header.size = htonl((uint32_t)msg.body.size());
+    return msg;
+}
+
+TEST(LuaConnectorMessageTest, Binary) {
+    const std::vector<uint8_t> data = {1, 2, 3, 4};
+    Message msg = makeBinary(LuaConnector::Net::READ_BLOCK, 0x80001234, data, (uint32_t)data.size());
+    BinaryHeader header;
+    ASSERT_TRUE(msg.IsBinary());
+    ASSERT_TRUE(msg.GetBinaryHeader(header));
+    EXPECT_EQ(header.type, LuaConnector::Net::READ_BLOCK);
+    EXPECT_EQ(header.address, 0x80001234u);
+    EXPECT_EQ(header.length, 4u);
+    EXPECT_EQ(std::vector<uint8_t>(msg.GetBinaryData(), msg.GetBinaryData() + header.length), data);
+
+    Message truncated = makeBinary(LuaConnector::Net::READ_BLOCK, 0, data, 5);
+    EXPECT_FALSE(truncated.GetBinaryHeader(header));
+    truncated.body.resize(BinaryHeader::SIZE - 1);
+    EXPECT_FALSE(truncated.GetBinaryHeader(header));
+
+    Message json(nlohmann::json{{"type", LuaConnector::Net::READ_BLOCK}});
+    EXPECT_FALSE(json.IsBinary());
+    EXPECT_FALSE(json.GetBinaryHeader(header));
+}
+
+TEST(LuaConnectorServerTest, UpdateBufferBinary) {
+    tsbuffer<uint8_t> data;
+    ReplyServer server(data);
+    std::vector<RangeSet::Range> dirty;
+
+    const std::vector<uint8_t> block = {1, 2, 3, 4};
+    EXPECT_TRUE(server.updateBuffer(makeBinary(LuaConnector::Net::READ_BLOCK, 0x100, block, 4)));
+    uint8_t out[4];
+    ASSERT_TRUE(data.read(0x100, 4, out));
+    EXPECT_EQ(std::vector<uint8_t>(out, out + 4), block);
+    server.TakeDirtyRanges(dirty);
+    ASSERT_EQ(dirty.size(), 1u);
+    EXPECT_EQ(dirty[0].start, 0x100u);
+    EXPECT_EQ(dirty[0].length, 4u);
+
+    // same data again is not a change
+    EXPECT_FALSE(server.updateBuffer(makeBinary(LuaConnector::Net::READ_BLOCK, 0x100, block, 4)));
+    server.TakeDirtyRanges(dirty);
+    EXPECT_TRUE(dirty.empty());
+
+    // only the changed byte is dirty
+    EXPECT_TRUE(server.updateBuffer(makeBinary(LuaConnector::Net::READ_BLOCK, 0x100, {1, 9, 3, 4}, 4)));
+    ASSERT_TRUE(data.read(0x101, 1, out));
+    EXPECT_EQ(out[0], 9);
+    server.TakeDirtyRanges(dirty);
+    ASSERT_EQ(dirty.size(), 1u);
+    EXPECT_EQ(dirty[0].start, 0x101u);
+    EXPECT_EQ(dirty[0].length, 1u);
+
+    // other types and truncated messages are ignored
+    EXPECT_FALSE(server.updateBuffer(makeBinary(LuaConnector::Net::READ_BYTE, 0x200, {1}, 1)));
+    EXPECT_FALSE(server.updateBuffer(makeBinary(LuaConnector::Net::READ_BLOCK, 0x200, {1}, 2)));
+    EXPECT_FALSE(data.read(0x200, 1, out));
+    server.TakeDirtyRanges(dirty);
+    EXPECT_TRUE(dirty.empty());
+}
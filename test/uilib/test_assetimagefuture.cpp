@@ -1,5 +1,8 @@
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include "../../src/uilib/assetimagefuture.hpp"
 
@@ -108,3 +111,48 @@ TEST(AssetImageFuture, Missing) {
     EXPECT_FALSE(surf);
     SDL_FreeSurface(surf);
 }
+
+TEST(AssetImageFuture, Processor) {
+    // occupy all workers, so the future is still queued when the processor is set
+    auto& queue = pop::Singleton<Ui::ImageTaskQueue>::get();
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool release = false;
+    std::vector<size_t> blockers;
+    for (size_t i = 0; i < Ui::ImageTaskQueue::getHardwareConcurrency(); i++) {
+        blockers.push_back(queue.enqueue([&mutex, &cv, &release]() -> SDL_Surface* {
+            std::unique_lock lock(mutex);
+            cv.wait_for(lock, std::chrono::seconds(1), [&release] { return release; });
+            return nullptr;
+        }));
+    }
+
+    Ui::AssetImageFuture future{MAP_NAME};
+    const auto mainThread = std::this_thread::get_id();
+    std::thread::id processorThread;
+    SDL_Surface* processed = nullptr;
+    ASSERT_TRUE(future.setProcessor([&processorThread, &processed](SDL_Surface* surf) {
+        processorThread = std::this_thread::get_id();
+        SDL_FreeSurface(surf);
+        processed = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+        return processed;
+    }));
+    {
+        std::lock_guard lock(mutex);
+        release = true;
+    }
+    cv.notify_all();
+    for (const size_t blocker: blockers)
+        queue.get(blocker);
+
+    for (int i = 0; i < 1000 && !future.isSurfaceDone(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_TRUE(future.isSurfaceDone()) << "Did not finish loading in 1s";
+    EXPECT_FALSE(future.setProcessor(nullptr)); // already processed
+    SDL_Surface* surf = future.getSurface();
+    ASSERT_TRUE(surf);
+    EXPECT_EQ(surf, processed);
+    EXPECT_EQ(surf->w, 1);
+    EXPECT_NE(processorThread, mainThread);
+    SDL_FreeSurface(surf);
+}
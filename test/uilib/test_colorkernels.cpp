@@ -0,0 +1,139 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+#include <SDL2/SDL.h>
+#include "../../src/uilib/colorhelper.h"
+#include "../../src/uilib/colorkernels.h"
+
+
+using namespace Ui;
+using Level = ColorKernels::Level;
+
+class ColorKernelsSuite : public testing::TestWithParam<std::tuple<Level, Uint32>> {
+protected:
+    void SetUp() override
+    {
+        ColorKernels::setLevel(std::get<0>(GetParam()));
+    }
+
+    void TearDown() override
+    {
+        ColorKernels::setLevel(ColorKernels::getSupportedLevel());
+    }
+
+    /// Creates a surface with random pixels. Odd width to also hit the scalar tail of every row.
+    static SDL_Surface* makeSurface(Uint32 format, unsigned seed, int w = 259, int h = 67)
+    {
+        SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, format);
+        if (!surf)
+            return nullptr;
+        std::mt19937 rng(seed);
+        for (int y = 0; y < surf->h; y++) {
+            auto* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(surf->pixels) + y * surf->pitch);
+            for (int x = 0; x < surf->w; x++)
+                row[x] = rng();
+        }
+        return surf;
+    }
+
+    static std::vector<uint32_t> getPixels(const SDL_Surface* surf)
+    {
+        std::vector<uint32_t> res;
+        for (int y = 0; y < surf->h; y++) {
+            auto* row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surf->pixels) + y * surf->pitch);
+            res.insert(res.end(), row, row + surf->w);
+        }
+        return res;
+    }
+
+    template<BWMode mode, bool darken>
+    static void compareSaturation(Uint32 format, float saturation)
+    {
+        SDL_Surface* expected = makeSurface(format, 1);
+        SDL_Surface* actual = makeSurface(format, 1);
+        ASSERT_TRUE(expected && actual);
+        _setSaturationRGB<mode, darken>(expected, saturation);
+        EXPECT_TRUE(ColorKernels::setSaturation(actual, mode, darken, saturation));
+        EXPECT_EQ(getPixels(expected), getPixels(actual))
+                << "mode " << static_cast<int>(mode) << ", darken " << darken << ", saturation " << saturation;
+        SDL_FreeSurface(expected);
+        SDL_FreeSurface(actual);
+    }
+};
+
+TEST_P(ColorKernelsSuite, SaturationMatchesGeneric) {
+    const Uint32 format = std::get<1>(GetParam());
+    for (const float saturation: {0.f, 0.3f, 0.5f, 1.f, 1.7f}) {
+        compareSaturation<BWMode::Luminosity, false>(format, saturation);
+        compareSaturation<BWMode::Luminosity, true>(format, saturation);
+        compareSaturation<BWMode::Average, false>(format, saturation);
+        compareSaturation<BWMode::Average, true>(format, saturation);
+    }
+}
+
+TEST_P(ColorKernelsSuite, BrightnessMatchesGeneric) {
+    const Uint32 format = std::get<1>(GetParam());
+    for (const float brightness: {0.f, 0.5f, 0.75f, 1.f, 1.5f, 255.f}) {
+        SDL_Surface* expected = makeSurface(format, 2);
+        SDL_Surface* actual = makeSurface(format, 2);
+        ASSERT_TRUE(expected && actual);
+        _setBrightnessRGB(expected, brightness);
+        EXPECT_TRUE(ColorKernels::setBrightness(actual, brightness));
+        EXPECT_EQ(getPixels(expected), getPixels(actual)) << "brightness " << brightness;
+        SDL_FreeSurface(expected);
+        SDL_FreeSurface(actual);
+    }
+}
+
+TEST_P(ColorKernelsSuite, BlendMatchesScalar) {
+    const Uint32 format = std::get<1>(GetParam());
+    SDL_Surface* src = makeSurface(format, 3);
+    SDL_Surface* expected = makeSurface(format, 4, 300, 40); // different size to test clipping
+    SDL_Surface* actual = makeSurface(format, 4, 300, 40);
+    ASSERT_TRUE(src && expected && actual);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+    ColorKernels::setLevel(Level::Scalar);
+    EXPECT_TRUE(ColorKernels::blend(src, expected));
+    ColorKernels::setLevel(std::get<0>(GetParam()));
+    EXPECT_TRUE(ColorKernels::blend(src, actual));
+    EXPECT_EQ(getPixels(expected), getPixels(actual));
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(expected);
+    SDL_FreeSurface(actual);
+}
+
+TEST_P(ColorKernelsSuite, BlendOpaqueAndTransparent) {
+    const Uint32 format = std::get<1>(GetParam());
+    SDL_Surface* src = makeSurface(format, 5);
+    SDL_Surface* dst = makeSurface(format, 6);
+    ASSERT_TRUE(src && dst);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+    auto* pixels = static_cast<uint32_t*>(src->pixels);
+    pixels[0] |= 0xff000000u; // opaque
+    pixels[1] &= 0x00ffffffu; // transparent
+    const uint32_t dst1 = static_cast<uint32_t*>(dst->pixels)[1];
+    EXPECT_TRUE(ColorKernels::blend(src, dst));
+    EXPECT_EQ(static_cast<uint32_t*>(dst->pixels)[0], pixels[0]);
+    EXPECT_EQ(static_cast<uint32_t*>(dst->pixels)[1], dst1);
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+}
+
+TEST(ColorKernelsTest, UnsupportedFormats) {
+    const Uint32 formats[] = {SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_RGBA8888};
+    for (const Uint32 format: formats) {
+        SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormat(0, 4, 4, 32, format);
+        ASSERT_TRUE(surf);
+        EXPECT_FALSE(ColorKernels::isSupported(surf->format));
+        EXPECT_FALSE(ColorKernels::setBrightness(surf, 0.5f));
+        SDL_FreeSurface(surf);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        ColorKernels,
+        ColorKernelsSuite,
+        testing::Combine(
+                testing::Values(Level::Scalar, Level::Vector128, Level::AVX2),
+                testing::Values(SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888)));
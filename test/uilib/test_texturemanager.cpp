@@ -0,0 +1,119 @@
+#include <stdexcept>
+#include <gtest/gtest.h>
+#include <SDL2/SDL.h>
+#include "../../src/uilib/texturemanager.h"
+
+
+using namespace Ui;
+
+
+class TextureManagerTest : public testing::Test {
+protected:
+    SDL_Surface* _surface = nullptr;
+    SDL_Renderer* _renderer = nullptr;
+
+    TextureManagerTest()
+    {
+        _surface = SDL_CreateRGBSurface(0, 16, 16, 32, 0, 0, 0, 0);
+        if (!_surface)
+            throw std::runtime_error("failed to create surface");
+        _renderer = SDL_CreateSoftwareRenderer(_surface);
+        if (!_renderer) {
+            SDL_FreeSurface(_surface);
+            throw std::runtime_error("failed to create renderer");
+        }
+    }
+
+    ~TextureManagerTest() override
+    {
+        TextureManager::remove(_renderer);
+        SDL_DestroyRenderer(_renderer);
+        SDL_FreeSurface(_surface);
+    }
+
+    SDL_Texture* makeTexture(int size) const
+    {
+        return SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    }
+};
+
+TEST_F(TextureManagerTest, Key) {
+    const std::list<ImageFilter> none;
+    const std::list<ImageFilter> grey = {ImageFilter("grey")};
+    const std::list<ImageFilter> overlay = {ImageFilter("overlay", "a.png")};
+    EXPECT_EQ(TextureManager::makeKey("a.png", none, 0), TextureManager::makeKey("a.png", none, 0));
+    EXPECT_NE(TextureManager::makeKey("a.png", none, 0), TextureManager::makeKey("a.png", none, 2));
+    EXPECT_NE(TextureManager::makeKey("a.png", none, 0), TextureManager::makeKey("b.png", none, 0));
+    EXPECT_NE(TextureManager::makeKey("a.png", none, 0), TextureManager::makeKey("a.png", grey, 0));
+    EXPECT_NE(TextureManager::makeKey("a.png", grey, 0), TextureManager::makeKey("a.png", overlay, 0));
+}
+
+TEST_F(TextureManagerTest, Refcount) {
+    auto& manager = TextureManager::get(_renderer);
+    EXPECT_EQ(manager.acquire("a"), nullptr);
+    SDL_Texture* tex = manager.insert("a", makeTexture(4));
+    ASSERT_NE(tex, nullptr);
+    EXPECT_EQ(manager.acquire("a"), tex);
+    EXPECT_EQ(manager.getUnusedBytes(), 0u);
+
+    // inserting the same key again keeps the first texture
+    EXPECT_EQ(manager.insert("a", makeTexture(4)), tex);
+
+    EXPECT_TRUE(TextureManager::release(_renderer, tex));
+    EXPECT_TRUE(manager.release(tex));
+    EXPECT_EQ(manager.getUnusedBytes(), 0u);
+    EXPECT_TRUE(manager.release(tex));
+    EXPECT_EQ(manager.getUnusedBytes(), 4u * 4u * 4u);
+    EXPECT_EQ(manager.getSharedCount(), 1u);
+
+    // unused textures can be acquired again
+    EXPECT_EQ(manager.acquire("a"), tex);
+    EXPECT_EQ(manager.getUnusedBytes(), 0u);
+    EXPECT_TRUE(manager.release(tex));
+
+    // unknown textures are not released
+    SDL_Texture* other = makeTexture(4);
+    EXPECT_FALSE(manager.release(other));
+    SDL_DestroyTexture(other);
+}
+
+TEST_F(TextureManagerTest, Budget) {
+    auto& manager = TextureManager::get(_renderer);
+    manager.setBudget(2 * 8 * 8 * 4);
+    SDL_Texture* a = manager.insert("a", makeTexture(8));
+    SDL_Texture* b = manager.insert("b", makeTexture(8));
+    SDL_Texture* c = manager.insert("c", makeTexture(8));
+    manager.release(a);
+    manager.release(b);
+    EXPECT_EQ(manager.getSharedCount(), 3u);
+    manager.acquire("a"); // a is now more recently used than b
+    manager.release(a);
+    manager.release(c); // exceeds budget, evicts b
+    EXPECT_EQ(manager.getSharedCount(), 2u);
+    EXPECT_EQ(manager.acquire("b"), nullptr);
+    EXPECT_EQ(manager.acquire("a"), a);
+    manager.setBudget(0); // evicts c, a is still referenced
+    EXPECT_EQ(manager.getSharedCount(), 1u);
+    manager.release(a);
+    EXPECT_EQ(manager.getSharedCount(), 0u);
+    EXPECT_EQ(manager.getUnusedBytes(), 0u);
+}
+
+TEST_F(TextureManagerTest, Purge) {
+    auto& manager = TextureManager::get(_renderer);
+    SDL_Texture* a = manager.insert("view1\x1f" "a", makeTexture(4));
+    SDL_Texture* b = manager.insert("view1\x1f" "b", makeTexture(4));
+    SDL_Texture* c = manager.insert("view10\x1f" "a", makeTexture(4));
+    manager.release(a);
+    manager.release(c);
+    TextureManager::purgeAll("view1\x1f");
+    // b is still referenced and the other scope is untouched
+    EXPECT_EQ(manager.getSharedCount(), 2u);
+    EXPECT_EQ(manager.getUnusedBytes(), 4u * 4u * 4u);
+    EXPECT_EQ(manager.acquire("view1\x1f" "a"), nullptr);
+    EXPECT_EQ(manager.acquire("view10\x1f" "a"), c);
+    manager.release(b);
+    manager.release(c);
+    manager.purge("view1\x1f");
+    EXPECT_EQ(manager.getSharedCount(), 1u);
+}